@@ -0,0 +1,209 @@
+
+// clang-format off
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// clang-format on
+#include <algorithm>
+#include <fstream>
+
+#include <vsg/io/read.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/utils/CommandLine.h>
+
+#include "SiegePipeline.hpp"
+#include "StartupProfiler.hpp"
+#include "cfg/WritableConfig.hpp"
+#include "vsg/Aspect.hpp"
+#include "world/SiegeNode.hpp"
+
+/*
+ * siege-load-bench: headless region loader
+ *
+ * siege-load-bench --bits <path> --region /world/maps/<map>/regions/<region> [--region ...] [--repeat n] [--json report.json]
+ *
+ * every region is read through the same ReaderWriters the editor registers, but nothing is compiled so no window,
+ * Qt or vulkan device is required. the usual config arguments (--bits, --res_paths, ...) are honored
+ */
+
+namespace ehb
+{
+    struct SceneCounts
+    {
+        uint64_t nodes = 0;
+        uint64_t siegeNodes = 0;
+        uint64_t aspects = 0;
+        uint64_t meshes = 0;
+        uint64_t triangles = 0;
+    };
+
+    struct CountScene : public vsg::Visitor, public SceneCounts
+    {
+        using vsg::Visitor::apply;
+
+        void apply(vsg::Node& node) override
+        {
+            ++nodes;
+
+            if (node.is_compatible(typeid(SiegeNodeMesh)))
+            {
+                ++siegeNodes;
+            }
+            else if (node.is_compatible(typeid(Aspect)))
+            {
+                ++aspects;
+            }
+
+            node.traverse(*this);
+        }
+
+        void apply(vsg::VertexIndexDraw& draw) override
+        {
+            ++nodes;
+            ++meshes;
+            triangles += draw.indexCount / 3;
+
+            draw.traverse(*this);
+        }
+    };
+
+    struct RegionResult
+    {
+        std::string region;
+        bool loaded = false;
+        StartupProfiler::Phase cost;
+        SceneCounts stats;
+    };
+
+    static void writeJson(std::ostream& stream, const StartupProfiler& startup, const std::vector<RegionResult>& results)
+    {
+        const auto startupTotal = startup.total();
+
+        stream << "{\n    \"startup\": {\"ms\": " << startupTotal.milliseconds << ", \"files\": " << startupTotal.filesOpened << ", \"bytes\": " << startupTotal.bytesRead << ", \"allocations\": " << startupTotal.allocations << "},\n";
+        stream << "    \"regions\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            stream << (i == 0 ? "\n        " : ",\n        ");
+            stream << "{\"region\": ";
+            writeJsonString(stream, result.region);
+            stream << ", \"loaded\": " << (result.loaded ? "true" : "false")
+                   << ", \"ms\": " << result.cost.milliseconds
+                   << ", \"files\": " << result.cost.filesOpened
+                   << ", \"bytes\": " << result.cost.bytesRead
+                   << ", \"allocations\": " << result.cost.allocations
+                   << ", \"allocated_bytes\": " << result.cost.allocatedBytes
+                   << ", \"peak_rss\": " << result.cost.peakResidentBytes
+                   << ", \"nodes\": " << result.stats.nodes
+                   << ", \"siege_nodes\": " << result.stats.siegeNodes
+                   << ", \"aspects\": " << result.stats.aspects
+                   << ", \"meshes\": " << result.stats.meshes
+                   << ", \"triangles\": " << result.stats.triangles << "}";
+        }
+
+        stream << "\n    ]\n}\n";
+    }
+} // namespace ehb
+
+int main(int argc, char* argv[])
+{
+    using namespace ehb;
+
+    auto log = spdlog::stdout_color_mt("log");
+
+    std::vector<std::string> regions;
+    std::string jsonReport;
+    int repeat = 1;
+
+    {
+        vsg::CommandLine args(&argc, argv);
+
+        std::string value;
+        while (args.read("--region", value))
+        {
+            regions.emplace_back(value);
+        }
+
+        args.read("--repeat", repeat);
+        args.read("--json", jsonReport);
+    }
+
+    if (regions.empty())
+    {
+        log->error("usage: siege-load-bench [config options] --region /world/maps/<map>/regions/<region> [--region ...] [--repeat n] [--json report.json]");
+
+        return 1;
+    }
+
+    WritableConfig config(argc, argv);
+
+    // always report startup, the bench is a profiling tool
+    config.setBool("profile-startup", true);
+
+    Systems systems(config);
+    systems.init();
+
+    std::vector<RegionResult> results;
+
+    for (int pass = 0; pass < std::max(1, repeat); ++pass)
+    {
+        for (const auto& region : regions)
+        {
+            RegionResult result;
+            result.region = region;
+
+            const std::string filename = getLowerCaseFileExtension(region) == ".region" ? region : region + ".region";
+
+            StartupProfiler profiler;
+            vsg::ref_ptr<vsg::Node> node;
+
+            {
+                auto phase = profiler.phase(region);
+
+                node = vsg::read_cast<vsg::Node>(filename, systems.options);
+            }
+
+            result.cost = profiler.phases().front();
+
+            if (node)
+            {
+                CountScene countScene;
+                node->accept(countScene);
+
+                result.loaded = true;
+                result.stats = countScene;
+            }
+
+            log->info("{}: {} in {:.2f} ms, {} nodes ({} siege nodes, {} aspects), {} meshes, {} triangles, {} files, {} bytes read, {} allocs, {} MiB peak rss",
+                      region, result.loaded ? "loaded" : "FAILED", result.cost.milliseconds, result.stats.nodes, result.stats.siegeNodes, result.stats.aspects,
+                      result.stats.meshes, result.stats.triangles, result.cost.filesOpened, result.cost.bytesRead, result.cost.allocations,
+                      result.cost.peakResidentBytes / (1024 * 1024));
+
+            results.emplace_back(std::move(result));
+
+            // drop anything the readers cached so repeated passes measure the same work
+            if (systems.options->objectCache)
+            {
+                systems.options->objectCache->clear();
+            }
+        }
+    }
+
+    if (!jsonReport.empty())
+    {
+        if (std::ofstream stream(jsonReport); stream.is_open())
+        {
+            writeJson(stream, systems.profiler, results);
+        }
+        else
+        {
+            log->error("could not write {}", jsonReport);
+        }
+    }
+
+    const bool failed = std::any_of(results.begin(), results.end(), [](const auto& result) { return !result.loaded; });
+
+    return failed ? 1 : 0;
+}
@@ -28,9 +28,12 @@ namespace ehb
 
         auto maps = fileSys.getDirectoryContents("/world/maps");
 
+        static constexpr FuelPath regionDescription("region:description");
+
+        // only one value per region is needed so nothing here builds a document, readGasFile logs whatever it can't read
         for (const auto& map : maps)
         {
-            if (auto mapdotgas = fileSys.loadGasFile(map + "/main.gas"))
+            if (FuelHandler mapdotgas; fileSys.readGasFile(map + "/main.gas", mapdotgas))
             {
                 QTreeWidgetItem* item = new QTreeWidgetItem;
                 item->setText(0, stem(map).c_str());
@@ -40,11 +43,23 @@ namespace ehb
                 auto regions = fileSys.getDirectoryContents(map + "/regions");
                 for (const auto& region : regions)
                 {
-                    if (auto regionmaindotgas = fileSys.loadGasFile(region + "/main.gas"))
+                    if (FuelPathReader regionmaindotgas(regionDescription); fileSys.readGasFile(region + "/main.gas", regionmaindotgas))
                     {
+                        // same unquoting valueAsString does
+                        std::string_view description = regionmaindotgas.value();
+
+                        if (description.size() >= 2 && description.front() == '"' && description.back() == '"')
+                        {
+                            description = description.substr(1, description.size() - 2);
+                        }
+                        else
+                        {
+                            description = {};
+                        }
+
                         QTreeWidgetItem* item2 = new QTreeWidgetItem;
                         item2->setText(0, stem(region).c_str());
-                        item2->setText(1, regionmaindotgas->valueAsString("region:description").c_str());
+                        item2->setText(1, QString::fromUtf8(description.data(), static_cast<int>(description.size())));
                         item->addChild(item2);
                     }
                 }
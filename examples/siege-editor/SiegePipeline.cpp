@@ -5,7 +5,9 @@
 
 #include "cfg/WritableConfig.hpp"
 #include "io/FileNameMap.hpp"
+#include "io/GasCache.hpp"
 #include "io/IFileSys.hpp"
+#include "io/ParallelFor.hpp"
 
 #include "vsg/ReaderWriterASP.hpp"
 #include "vsg/ReaderWriterRAW.hpp"
@@ -57,6 +59,64 @@ void main() {
     outColor = texture(texSampler, fragTexCoord);
 })";
 
+    namespace
+    {
+        // collects the guid and filename of every second level block of a mesh list, anything deeper is skipped
+        class MeshListReader : public FuelHandler
+        {
+        public:
+            FuelVisit enterBlock(std::string_view /*name*/, std::string_view /*type*/) override
+            {
+                if (depth == 2)
+                {
+                    return FuelVisit::Skip;
+                }
+
+                if (++depth == 2)
+                {
+                    entries.emplace_back();
+                    hasGuid = hasFilename = false;
+                }
+
+                return FuelVisit::Continue;
+            }
+
+            FuelVisit attribute(std::string_view name, std::string_view /*type*/, std::string_view value) override
+            {
+                // the first of each wins, same as valueOf
+                if (depth == 2)
+                {
+                    if (!hasGuid && name == "guid")
+                    {
+                        entries.back().first = value;
+                        hasGuid = true;
+                    }
+                    else if (!hasFilename && name == "filename")
+                    {
+                        entries.back().second = value;
+                        hasFilename = true;
+                    }
+                }
+
+                return FuelVisit::Continue;
+            }
+
+            FuelVisit leaveBlock() override
+            {
+                --depth;
+                return FuelVisit::Continue;
+            }
+
+            std::vector<std::pair<std::string, std::string>> entries;
+            bool loaded = false;
+
+        private:
+            unsigned int depth = 0;
+            bool hasGuid = false;
+            bool hasFilename = false;
+        };
+    } // namespace
+
     SiegeNodeMeshGUIDDatabase::SiegeNodeMeshGUIDDatabase(IFileSys& fileSys) :
         fileSys(fileSys)
     {
@@ -64,20 +124,35 @@ void main() {
 
         static const std::string directory = "/world/global/siege_nodes";
 
-        fileSys.eachGasFile(directory, [&](const std::string& filename, auto doc) {
-            for (auto root : doc->eachChild())
+        const std::vector<std::string> meshListFiles = fileSys.gasFilesUnder(directory);
+
+        // only two values per node are needed so the files are streamed rather than loaded as documents
+        std::vector<MeshListReader> readers(meshListFiles.size());
+
+        parallelFor(meshListFiles.size(), [&](size_t i) {
+            readers[i].loaded = fileSys.readGasFile(meshListFiles[i], readers[i]);
+        });
+
+        // merged in file order so the same duplicates get reported on every run
+        for (const auto& reader : readers)
+        {
+            if (!reader.loaded)
             {
-                for (auto node : root->eachChild())
-                {
-                    const auto itr = keyMap.emplace(node->valueOf("guid"), convertToLowerCase(node->valueOf("filename")));
+                continue;
+            }
 
-                    if (itr.second != true)
-                    {
-                        log->error("duplicate mesh mapping found: tried to insert {} for guid {}, but found filename {} there already", node->valueOf("filename"), node->valueOf("guid"), itr.first->second);
-                    }
+            for (const auto& [guid, filename] : reader.entries)
+            {
+                const auto itr = keyMap.emplace(guid, convertToLowerCase(filename));
+
+                if (itr.second != true)
+                {
+                    log->error("duplicate mesh mapping found: tried to insert {} for guid {}, but found filename {} there already", filename, guid, itr.first->second);
                 }
             }
-        });
+        }
+
+        std::vector<std::string> nodeMeshIndexFiles;
 
         const std::string mapsFolder = "/world/maps/";
         for (const auto& mapPath : fileSys.getDirectoryContents(mapsFolder)) // each map folder
@@ -86,24 +161,30 @@ void main() {
 
             for (const auto& regionPath : fileSys.getDirectoryContents(regionsPath))
             {
-                const std::string node_mesh_index_dot_gas = regionPath + "/index/node_mesh_index.gas";
+                nodeMeshIndexFiles.emplace_back(regionPath + "/index/node_mesh_index.gas");
+            }
+        }
 
-                if (auto stream = fileSys.createInputStream(node_mesh_index_dot_gas))
-                {
-                    if (Fuel doc; doc.load(*stream))
-                    {
-                        // log->info("handling non-global mesh guids @ {}", node_mesh_index_dot_gas);
+        const FuelBatch nodeMeshIndices = fileSys.loadGasBatch(nodeMeshIndexFiles);
 
-                        for (const auto& entry : doc.child("node_mesh_index")->eachAttribute())
-                        {
-                            const auto itr = keyMap.emplace(entry.name, convertToLowerCase(entry.value));
+        for (size_t i = 0; i < nodeMeshIndices.size(); ++i)
+        {
+            FuelBlock* doc = nodeMeshIndices[i];
 
-                            if (itr.second != true)
-                            {
-                                log->error("duplicate mesh mapping found: tried to insert {} for guid {}, but found filename {} there already", entry.value, entry.name, itr.first->second);
-                            }
-                        }
-                    }
+            if (doc == nullptr)
+            {
+                continue;
+            }
+
+            // log->info("handling non-global mesh guids @ {}", nodeMeshIndexFiles[i]);
+
+            for (const auto& entry : doc->child("node_mesh_index")->eachAttribute())
+            {
+                const auto itr = keyMap.emplace(entry.name, convertToLowerCase(entry.value));
+
+                if (itr.second != true)
+                {
+                    log->error("duplicate mesh mapping found: tried to insert {} for guid {}, but found filename {} there already", entry.value, entry.name, itr.first->second);
                 }
             }
         }
@@ -120,13 +201,38 @@ void main() {
 
     void Systems::init()
     {
-        fileSys.init(config);
-        fileNameMap.init(fileSys);
-        contentDb.init(fileSys);
-        objectDb.reset(new ObjectDb(contentDb));
+        {
+            auto phase = profiler.phase("fileSys.init");
+            fileSys.init(config);
 
-        nodeMeshGuidDb = SiegeNodeMeshGUIDDatabase::create(fileSys);
-        options->setObject("SiegeNodeMeshGuidDatabase", nodeMeshGuidDb);
+            // compiled gas files live next to the file index, on by default whenever there is a cache directory
+            if (const std::string cacheDir = config.getString("cache-dir"); !cacheDir.empty() && config.getBool("gas-cache", true))
+            {
+                fileSys.setGasCache(std::make_shared<GasCache>(cacheDir));
+            }
+        }
+        {
+            auto phase = profiler.phase("fileNameMap.init");
+            fileNameMap.init(fileSys);
+        }
+        {
+            auto phase = profiler.phase("contentDb.init");
+            // templates are resolved as regions ask for them unless lazy-contentdb is switched off, or all come out of the snapshot when it is up to date
+            std::string snapshot;
+
+            if (const std::string cacheDir = config.getString("cache-dir"); !cacheDir.empty() && config.getBool("contentdb-snapshot", true))
+            {
+                snapshot = (fs::path(cacheDir) / "contentdb.gass").string();
+            }
+
+            contentDb.init(fileSys, "/world/contentdb/templates/", config.getBool("lazy-contentdb", true) ? ContentDb::Mode::Lazy : ContentDb::Mode::Eager, snapshot);
+            objectDb.reset(new ObjectDb(contentDb));
+        }
+        {
+            auto phase = profiler.phase("nodeMeshGuidDb");
+            nodeMeshGuidDb = SiegeNodeMeshGUIDDatabase::create(fileSys);
+            options->setObject("SiegeNodeMeshGuidDatabase", nodeMeshGuidDb);
+        }
 
         options->readerWriters = {
 
@@ -140,12 +246,36 @@ void main() {
 
         options->objectCache = vsg::ObjectCache::create();
 
-        SiegeNodePipeline::SetupPipeline();
+        {
+            auto phase = profiler.phase("SetupPipeline");
+            SiegeNodePipeline::SetupPipeline();
+        }
 
         // we currently have two ways to access this variable
         // the first is via options that get passed around
         // the second is via the static variable - which should only be accessed and not written to so should be thread safe?
         options->setObject("PipelineLayout", SiegeNodePipeline::PipelineLayout);
+
+        if (config.getBool("profile-startup"))
+        {
+            auto log = spdlog::get("log");
+
+            profiler.report(*log);
+
+            if (const std::string logs = config.getString("logs_path"); !logs.empty())
+            {
+                const std::string report = logs + "/startup-profile.json";
+
+                if (profiler.writeJson(report))
+                {
+                    log->info("startup profile written to {}", report);
+                }
+                else
+                {
+                    log->warn("could not write startup profile to {}", report);
+                }
+            }
+        }
     }
 
     void SiegeNodePipeline::SetupPipeline()
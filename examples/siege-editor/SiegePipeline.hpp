@@ -12,7 +12,9 @@
 #include <vsg/all.h>
 
 #include "io/FileNameMap.hpp"
-#include "io/LocalFileSys.hpp"
+#include "io/LayeredFileSys.hpp"
+
+#include "StartupProfiler.hpp"
 
 #include "game/ContentDb.hpp"
 #include "game/ObjectDb.hpp"
@@ -61,7 +63,7 @@ namespace ehb
         void init();
 
         WritableConfig& config;
-        LocalFileSys fileSys; // temp
+        LayeredFileSys fileSys;
         FileNameMap fileNameMap;
         ContentDb contentDb;
         std::unique_ptr<ObjectDb> objectDb;
@@ -69,6 +71,9 @@ namespace ehb
         vsg::ref_ptr<SiegeNodeMeshGUIDDatabase> nodeMeshGuidDb;
 
         vsg::ref_ptr<vsg::Options> options = vsg::Options::create();
+
+        //! per phase cost of init(), reported when profile-startup is set
+        StartupProfiler profiler;
     };
 
     class DynamicLoadAndCompile : public vsg::Inherit<vsg::Object, DynamicLoadAndCompile>
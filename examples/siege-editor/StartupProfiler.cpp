@@ -0,0 +1,257 @@
+
+#include "StartupProfiler.hpp"
+#include "io/IoStats.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#ifdef WIN32
+#    include <windows.h>
+#    include <psapi.h>
+#    pragma comment(lib, "psapi.lib")
+#else
+#    include <sys/resource.h>
+#endif
+
+namespace
+{
+    std::atomic<uint64_t> allocationCounter{0};
+    std::atomic<uint64_t> allocatedByteCounter{0};
+
+    void* countedAlloc(std::size_t size) noexcept
+    {
+        allocationCounter.fetch_add(1, std::memory_order_relaxed);
+        allocatedByteCounter.fetch_add(size, std::memory_order_relaxed);
+
+        return std::malloc(size != 0 ? size : 1);
+    }
+} // namespace
+
+// replace the global allocation functions so the profiler can count allocations, the counters are relaxed atomics
+// so the overhead when nobody is looking is a couple of uncontended increments per allocation
+void* operator new(std::size_t size)
+{
+    if (void* ptr = countedAlloc(size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+namespace ehb
+{
+    StartupProfiler::Scope::Scope(StartupProfiler& profiler, std::string name) :
+        profiler(profiler), name(std::move(name)), start(take())
+    {
+    }
+
+    StartupProfiler::Scope::~Scope()
+    {
+        const Snapshot end = take();
+
+        Phase phase;
+        phase.name = std::move(name);
+        phase.milliseconds = std::chrono::duration<double, std::milli>(end.time - start.time).count();
+        phase.filesOpened = end.filesOpened - start.filesOpened;
+        phase.bytesRead = end.bytesRead - start.bytesRead;
+        phase.allocations = end.allocations - start.allocations;
+        phase.allocatedBytes = end.allocatedBytes - start.allocatedBytes;
+        phase.peakResidentBytes = peakResidentBytes();
+
+        profiler.mPhases.emplace_back(std::move(phase));
+    }
+
+    StartupProfiler::Scope::Snapshot StartupProfiler::Scope::take()
+    {
+        const IoStats& io = IoStats::global();
+
+        return {std::chrono::steady_clock::now(), io.filesOpened.load(), io.bytesRead.load(), allocationCount(), allocatedBytes()};
+    }
+
+    StartupProfiler::Phase StartupProfiler::total() const
+    {
+        Phase result;
+        result.name = "total";
+
+        for (const auto& phase : mPhases)
+        {
+            result.milliseconds += phase.milliseconds;
+            result.filesOpened += phase.filesOpened;
+            result.bytesRead += phase.bytesRead;
+            result.allocations += phase.allocations;
+            result.allocatedBytes += phase.allocatedBytes;
+            result.peakResidentBytes = std::max(result.peakResidentBytes, phase.peakResidentBytes);
+        }
+
+        return result;
+    }
+
+    void writeJsonString(std::ostream& stream, std::string_view text)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        stream << '"';
+
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                stream << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+
+        stream << '"';
+    }
+
+    static void writeJsonPhase(std::ostream& stream, const StartupProfiler::Phase& phase)
+    {
+        stream << "{\"name\": ";
+        writeJsonString(stream, phase.name);
+        stream << ", \"ms\": " << phase.milliseconds
+               << ", \"files\": " << phase.filesOpened
+               << ", \"bytes\": " << phase.bytesRead
+               << ", \"allocations\": " << phase.allocations
+               << ", \"allocated_bytes\": " << phase.allocatedBytes
+               << ", \"peak_rss\": " << phase.peakResidentBytes << "}";
+    }
+
+    std::string StartupProfiler::toJson() const
+    {
+        std::ostringstream stream;
+
+        stream << "{\n    \"phases\": [";
+
+        for (size_t i = 0; i < mPhases.size(); ++i)
+        {
+            stream << (i == 0 ? "\n        " : ",\n        ");
+            writeJsonPhase(stream, mPhases[i]);
+        }
+
+        stream << "\n    ],\n    \"total\": ";
+        writeJsonPhase(stream, total());
+        stream << "\n}\n";
+
+        return stream.str();
+    }
+
+    bool StartupProfiler::writeJson(const std::string& filename) const
+    {
+        if (std::ofstream stream(filename); stream.is_open())
+        {
+            stream << toJson();
+
+            return stream.good();
+        }
+
+        return false;
+    }
+
+    void StartupProfiler::report(spdlog::logger& log) const
+    {
+        auto line = [&log](const Phase& phase) {
+            log.info("startup: {:<24} {:>10.2f} ms {:>7} files {:>12} bytes {:>10} allocs {:>8} MiB peak rss", phase.name, phase.milliseconds, phase.filesOpened, phase.bytesRead, phase.allocations, phase.peakResidentBytes / (1024 * 1024));
+        };
+
+        for (const auto& phase : mPhases)
+        {
+            line(phase);
+        }
+
+        line(total());
+    }
+
+    uint64_t StartupProfiler::allocationCount()
+    {
+        return allocationCounter.load(std::memory_order_relaxed);
+    }
+
+    uint64_t StartupProfiler::allocatedBytes()
+    {
+        return allocatedByteCounter.load(std::memory_order_relaxed);
+    }
+
+    uint64_t StartupProfiler::peakResidentBytes()
+    {
+#ifdef WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+        }
+
+        return 0;
+#else
+        struct rusage usage;
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+
+#    ifdef __APPLE__
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#    else
+        // linux reports kilobytes
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#    endif
+#endif
+    }
+} // namespace ehb
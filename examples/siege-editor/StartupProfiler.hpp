@@ -0,0 +1,102 @@
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace ehb
+{
+    /**
+     * records what each phase of startup costs: wall time, files opened and bytes handed out by the file systems,
+     * heap allocations and the peak resident set size of the process when the phase finished
+     *
+     * usage:
+     *     {
+     *         auto phase = profiler.phase("contentDb.init");
+     *         contentDb.init(fileSys);
+     *     }
+     *
+     * nothing here needs a window or a device so the same report can be produced by headless tools
+     */
+    class StartupProfiler
+    {
+    public:
+        struct Phase
+        {
+            std::string name;
+
+            double milliseconds = 0;
+            uint64_t filesOpened = 0;
+            uint64_t bytesRead = 0;
+            uint64_t allocations = 0;
+            uint64_t allocatedBytes = 0;
+            uint64_t peakResidentBytes = 0;
+        };
+
+        class Scope
+        {
+        public:
+            Scope(StartupProfiler& profiler, std::string name);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            struct Snapshot
+            {
+                std::chrono::steady_clock::time_point time;
+                uint64_t filesOpened;
+                uint64_t bytesRead;
+                uint64_t allocations;
+                uint64_t allocatedBytes;
+            };
+
+            static Snapshot take();
+
+            StartupProfiler& profiler;
+            std::string name;
+            Snapshot start;
+        };
+
+        //! time everything until the returned scope is destroyed
+        Scope phase(std::string name);
+
+        const std::vector<Phase>& phases() const;
+
+        //! sum of all phases, peak resident size is the largest seen
+        Phase total() const;
+
+        std::string toJson() const;
+        bool writeJson(const std::string& filename) const;
+
+        //! one line per phase plus a total
+        void report(spdlog::logger& log) const;
+
+        static uint64_t allocationCount();
+        static uint64_t allocatedBytes();
+        static uint64_t peakResidentBytes();
+
+    private:
+        std::vector<Phase> mPhases;
+    };
+
+    //! write text as a quoted JSON string, shared by every report that puts names and paths into JSON
+    void writeJsonString(std::ostream& stream, std::string_view text);
+
+    inline StartupProfiler::Scope StartupProfiler::phase(std::string name)
+    {
+        return Scope(*this, std::move(name));
+    }
+
+    inline const std::vector<StartupProfiler::Phase>& StartupProfiler::phases() const
+    {
+        return mPhases;
+    }
+} // namespace ehb
@@ -0,0 +1,149 @@
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ehb
+{
+    //! keep the optimizer from throwing away work whose result is otherwise unused
+    inline void doNotOptimize(const void* value)
+    {
+        static const void* volatile sink;
+        sink = value;
+    }
+
+    /**
+     * minimal benchmark runner, no external dependencies
+     *
+     * each benchmark is calibrated so a sample runs for roughly minTime / samples, then the samples are timed and
+     * the median and fastest time per iteration are reported along with throughput when bytes or items are given
+     */
+    class BenchmarkSuite
+    {
+    public:
+        struct Result
+        {
+            std::string name;
+            uint64_t iterations = 0;
+            double medianNs = 0;
+            double minNs = 0;
+            uint64_t bytesPerIteration = 0;
+            uint64_t itemsPerIteration = 0;
+        };
+
+        void add(std::string name, std::function<void()> body, uint64_t bytesPerIteration = 0, uint64_t itemsPerIteration = 0);
+
+        //! run every benchmark whose name contains filter
+        std::vector<Result> run(const std::string& filter, double minTime, uint32_t samples = 10) const;
+
+        static void writeJson(std::ostream& stream, const std::vector<Result>& results);
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            std::function<void()> body;
+            uint64_t bytes;
+            uint64_t items;
+        };
+
+        std::vector<Entry> entries;
+    };
+
+    inline void BenchmarkSuite::add(std::string name, std::function<void()> body, uint64_t bytesPerIteration, uint64_t itemsPerIteration)
+    {
+        entries.push_back({std::move(name), std::move(body), bytesPerIteration, itemsPerIteration});
+    }
+
+    inline std::vector<BenchmarkSuite::Result> BenchmarkSuite::run(const std::string& filter, double minTime, uint32_t samples) const
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::vector<Result> results;
+        samples = std::max(1u, samples);
+
+        for (const auto& entry : entries)
+        {
+            if (entry.name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            auto time = [&entry](uint64_t iterations) {
+                const auto start = clock::now();
+
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    entry.body();
+                }
+
+                return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            };
+
+            // warm up caches and any lazy state, then grow the batch until a sample is long enough to time reliably
+            const double target = minTime * 1e9 / samples;
+            uint64_t iterations = 1;
+
+            for (double elapsed = time(1); elapsed < target && iterations < (1ull << 30);)
+            {
+                const double scale = elapsed > 0 ? std::min(10.0, std::max(1.5, target / elapsed)) : 10.0;
+                iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * scale));
+                elapsed = time(iterations);
+            }
+
+            std::vector<double> perIteration;
+
+            for (uint32_t s = 0; s < samples; ++s)
+            {
+                perIteration.push_back(time(iterations) / iterations);
+            }
+
+            std::sort(perIteration.begin(), perIteration.end());
+
+            Result result;
+            result.name = entry.name;
+            result.iterations = iterations * samples;
+            result.medianNs = perIteration[perIteration.size() / 2];
+            result.minNs = perIteration.front();
+            result.bytesPerIteration = entry.bytes;
+            result.itemsPerIteration = entry.items;
+
+            results.emplace_back(std::move(result));
+        }
+
+        return results;
+    }
+
+    inline void BenchmarkSuite::writeJson(std::ostream& stream, const std::vector<Result>& results)
+    {
+        stream << "{\n    \"benchmarks\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            stream << (i == 0 ? "\n        " : ",\n        ");
+            stream << "{\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                   << ", \"median_ns\": " << result.medianNs << ", \"min_ns\": " << result.minNs;
+
+            if (result.bytesPerIteration != 0)
+            {
+                stream << ", \"bytes_per_second\": " << result.bytesPerIteration * 1e9 / result.medianNs;
+            }
+
+            if (result.itemsPerIteration != 0)
+            {
+                stream << ", \"items_per_second\": " << result.itemsPerIteration * 1e9 / result.medianNs;
+            }
+
+            stream << "}";
+        }
+
+        stream << "\n    ]\n}\n";
+    }
+} // namespace ehb
@@ -0,0 +1,458 @@
+
+// clang-format off
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// clang-format on
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <vsg/io/Options.h>
+#include <vsg/nodes/MatrixTransform.h>
+#include <vsg/utils/CommandLine.h>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+#include "MemoryFileSys.hpp"
+
+#include "SiegePipeline.hpp"
+#include "game/ContentDb.hpp"
+#include "io/FileNameMap.hpp"
+#include "io/GasCache.hpp"
+#include "io/Fuel.hpp"
+#include "io/FuelBatch.hpp"
+#include "io/FuelReader.hpp"
+#include "io/FuelScanner.hpp"
+#include "vsg/ReaderWriterASP.hpp"
+#include "vsg/ReaderWriterRAW.hpp"
+#include "vsg/ReaderWriterSNO.hpp"
+#include "vsg/ReaderWriterSiegeNodeList.hpp"
+#include "world/SiegeNode.hpp"
+
+/*
+ * siege-benchmarks: micro and macro benchmarks over generated fixtures
+ *
+ * siege-benchmarks [--filter <substring>] [--min-time <seconds>] [--scale <n>] [--json <report.json>]
+ *
+ * every input is produced by Fixtures.cpp so no retail data is needed, --scale multiplies the fixture sizes
+ */
+
+namespace ehb
+{
+    static constexpr uint32_t MESH_GUID = 0x0badf00d;
+    static constexpr uint32_t FIRST_NODE_GUID = 0x00100000;
+
+    static std::string hexGuid(uint32_t guid)
+    {
+        std::ostringstream stream;
+        stream << "0x" << std::hex << std::setw(8) << std::setfill('0') << guid;
+        return stream.str();
+    }
+
+    static InputView viewOf(const std::string& text)
+    {
+        return MappedFile::fromBuffer(std::vector<uint8_t>(text.begin(), text.end()));
+    }
+
+    static void addFuelBenchmarks(BenchmarkSuite& suite, uint32_t scale)
+    {
+        InputView templates = viewOf(generateTemplateGas(0, 500 * scale, 8));
+        InputView nodes = viewOf(generateNodesGas(32 * scale, 32, FIRST_NODE_GUID, MESH_GUID));
+
+        suite.add("fuel/load/templates", [templates]() {
+            Fuel doc;
+            doc.load(*templates);
+            doNotOptimize(&doc);
+        }, templates->size());
+
+        suite.add("fuel/load/nodes", [nodes]() {
+            Fuel doc;
+            doc.load(*nodes);
+            doNotOptimize(&doc);
+        }, nodes->size());
+
+        // tokenizing on its own, to tell scanner and parser costs apart
+        suite.add("fuel/scan/templates", [templates]() {
+            FuelScanner scanner(reinterpret_cast<const char*>(templates->data()), templates->size());
+
+            std::string_view token;
+            size_t count = 0;
+
+            while (scanner.scan(&token) != 0)
+            {
+                ++count;
+            }
+
+            doNotOptimize(&count);
+        }, templates->size());
+
+        // fuel/load/nodes without the tree, the floor for any FuelHandler
+        suite.add("fuel/read/nodes", [nodes]() {
+            FuelHandler handler;
+            const bool result = readFuel(*nodes, handler);
+            doNotOptimize(&result);
+        }, nodes->size());
+
+        // many small documents at once, the shape of the contentdb load at startup
+        std::vector<InputView> templateFiles;
+        size_t templateBytes = 0;
+
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            templateFiles.push_back(viewOf(generateTemplateGas(i * 50 * scale, 50 * scale, 8)));
+            templateBytes += templateFiles.back()->size();
+        }
+
+        suite.add("fuel/batch/templates", [templateFiles]() {
+            FuelBatch batch = FuelBatch::parse(templateFiles);
+            doNotOptimize(&batch);
+        }, templateBytes);
+
+        // accessors run against one parsed document that outlives the benchmarks
+        auto doc = std::make_shared<Fuel>();
+        doc->load(*templates);
+
+        std::vector<FuelBlock*> blocks;
+
+        for (auto block : doc->eachChild())
+        {
+            blocks.push_back(block);
+        }
+
+        const uint64_t count = blocks.size();
+
+        suite.add("fuel/valueAsInt", [doc, blocks]() {
+            int sum = 0;
+            for (auto block : blocks) sum += block->child("aspect")->valueAsInt("life");
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        suite.add("fuel/valueAsUInt/hex", [doc, blocks]() {
+            unsigned int sum = 0;
+            for (auto block : blocks) sum += block->child("common")->valueAsUInt("guid");
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        suite.add("fuel/valueAsFloat", [doc, blocks]() {
+            float sum = 0;
+            for (auto block : blocks) sum += block->child("aspect")->valueAsFloat("scale_base");
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        suite.add("fuel/valueAsBool", [doc, blocks]() {
+            int sum = 0;
+            for (auto block : blocks) sum += block->child("aspect")->valueAsBool("draw_shadow");
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        suite.add("fuel/valueOf/path", [doc, blocks]() {
+            size_t sum = 0;
+            for (auto block : blocks) sum += block->valueOf("inventory:pcontent:all*:il_main").size();
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        suite.add("fuel/valueOf/missing", [doc, blocks]() {
+            size_t sum = 0;
+            for (auto block : blocks) sum += block->valueOf("aspect:no_such_key").size();
+            doNotOptimize(&sum);
+        }, 0, count);
+
+        // the vector accessors, as called once per object when a region is placed
+        auto objects = std::make_shared<Fuel>();
+        objects->load(*viewOf(generateObjectGas(2000 * scale, 500, FIRST_NODE_GUID, 1024, 0x40000000)));
+
+        std::vector<FuelBlock*> placements;
+
+        for (auto object : objects->eachChild())
+        {
+            placements.push_back(object->child("placement"));
+        }
+
+        const uint64_t placementCount = placements.size();
+
+        suite.add("fuel/valueAsSiegePos", [objects, placements]() {
+            uint32_t sum = 0;
+            for (auto placement : placements) sum += placement->valueAsSiegePos("position").guid;
+            doNotOptimize(&sum);
+        }, 0, placementCount);
+
+        suite.add("fuel/valueAsSiegeRot", [objects, placements]() {
+            float sum = 0;
+            for (auto placement : placements) sum += placement->valueAsSiegeRot("orientation").rot[3];
+            doNotOptimize(&sum);
+        }, 0, placementCount);
+
+        suite.add("fuel/valueAsFloat4", [objects, placements]() {
+            float sum = 0;
+            for (auto placement : placements) sum += placement->valueAsFloat4("orientation")[3];
+            doNotOptimize(&sum);
+        }, 0, placementCount);
+
+        suite.add("fuel/valueAsSiegePos/path", [objects]() {
+            static constexpr FuelPath position("placement:position");
+
+            uint32_t sum = 0;
+            for (auto object : objects->eachChild()) sum += object->valueAsSiegePos(position).guid;
+            doNotOptimize(&sum);
+        }, 0, placementCount);
+
+        // the wide blocks an inventory or a body can have, where matching overrides one by one went quadratic
+        std::mt19937 rng(7);
+        std::vector<std::shared_ptr<Fuel>> wide;
+
+        for (const uint32_t count : {1000u * scale, 1500u * scale})
+        {
+            std::stringstream stream;
+            stream << "[t:template,n:tmpl]\n{\n";
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                stream << "v" << rng() % 2000 << " = " << i << ";\n[b" << rng() % 2000 << "]\n{\n\tx = " << i << ";\n}\n";
+            }
+
+            stream << "}\n";
+
+            wide.emplace_back(std::make_shared<Fuel>())->load(stream);
+        }
+
+        suite.add("fuel/merge/wide", [wide]() {
+            FuelArena arena;
+            FuelBlock* result = wide[0]->child("tmpl")->clone(arena);
+            wide[1]->child("tmpl")->merge(result);
+            doNotOptimize(result);
+        });
+
+        suite.add("fuel/overlay/wide", [wide]() {
+            FuelArena arena;
+            const FuelBlock* result = wide[1]->child("tmpl")->overlay(wide[0]->child("tmpl"), arena);
+            doNotOptimize(result);
+        });
+    }
+
+    static void addContentDbBenchmarks(BenchmarkSuite& suite, uint32_t scale)
+    {
+        auto fileSys = std::make_shared<MemoryFileSys>();
+
+        const uint32_t files = 20 * scale, perFile = 100;
+        uint64_t bytes = 0;
+
+        for (uint32_t i = 0; i < files; ++i)
+        {
+            const std::string gas = generateTemplateGas(i * perFile, perFile, 8);
+            bytes += gas.size();
+
+            fileSys->add("/world/contentdb/templates/synthetic_" + std::to_string(i) + ".gas", gas);
+        }
+
+        suite.add("contentdb/init", [fileSys]() {
+            ContentDb contentDb;
+            contentDb.init(*fileSys);
+            doNotOptimize(&contentDb);
+        }, bytes, files * perFile);
+
+        suite.add("contentdb/init/lazy", [fileSys]() {
+            ContentDb contentDb;
+            contentDb.init(*fileSys, "/world/contentdb/templates/", ContentDb::Mode::Lazy);
+            doNotOptimize(&contentDb);
+        }, bytes, files * perFile);
+
+        // a warm start, the first init writes the snapshot every timed one reloads
+        const std::string snapshot = (fs::temp_directory_path() / "siege-benchmarks-contentdb.gass").string();
+
+        {
+            ContentDb contentDb;
+            contentDb.init(*fileSys, "/world/contentdb/templates/", ContentDb::Mode::Eager, snapshot);
+        }
+
+        suite.add("contentdb/init/snapshot", [fileSys, snapshot]() {
+            ContentDb contentDb;
+            contentDb.init(*fileSys, "/world/contentdb/templates/", ContentDb::Mode::Eager, snapshot);
+            doNotOptimize(&contentDb);
+        }, bytes, files * perFile);
+
+        // what a region referencing a few hundred templates costs on top of the lazy init
+        const uint32_t used = std::min(300u, files * perFile);
+
+        suite.add("contentdb/init/lazy+lookup", [fileSys, files, used]() {
+            ContentDb contentDb;
+            contentDb.init(*fileSys, "/world/contentdb/templates/", ContentDb::Mode::Lazy);
+
+            for (uint32_t i = 0; i < used; ++i)
+            {
+                const FuelBlock* tmpl = contentDb.getGameObjectTmpl("tmpl_" + std::to_string(i * files * perFile / used));
+                doNotOptimize(&tmpl);
+            }
+        }, bytes, used);
+    }
+
+    struct ReaderFixture
+    {
+        MemoryFileSys fileSys;
+        FileNameMap fileNameMap;
+        vsg::ref_ptr<vsg::Options> options = vsg::Options::create();
+    };
+
+    static void addReaderBenchmarks(BenchmarkSuite& suite, const std::shared_ptr<ReaderFixture>& fixture, uint32_t scale)
+    {
+        const auto sno = generateSno(16 * scale, 4, 4);
+        const auto asp = generateAsp(2000 * scale, 3000 * scale, "b_synthetic");
+        const auto raw = generateRaw(256, 256 * static_cast<uint16_t>(std::min(scale, 255u)));
+
+        fixture->fileSys.add("/bench/mesh.sno", sno);
+        fixture->fileSys.add("/bench/model.asp", asp);
+        fixture->fileSys.add("/bench/texture.raw", raw);
+
+        auto snoReader = ReaderWriterSNO::create(fixture->fileSys, fixture->fileNameMap);
+        auto aspReader = ReaderWriterASP::create(fixture->fileSys, fixture->fileNameMap);
+        auto rawReader = ReaderWriterRAW::create(fixture->fileSys, fixture->fileNameMap);
+
+        suite.add("reader/sno", [fixture, snoReader]() {
+            auto object = snoReader->read("/bench/mesh", fixture->options);
+            doNotOptimize(object.get());
+        }, sno.size());
+
+        suite.add("reader/asp", [fixture, aspReader]() {
+            auto object = aspReader->read("/bench/model", fixture->options);
+            doNotOptimize(object.get());
+        }, asp.size());
+
+        suite.add("reader/raw", [fixture, rawReader]() {
+            auto object = rawReader->read("/bench/texture", fixture->options);
+            doNotOptimize(object.get());
+        }, raw.size());
+    }
+
+    static void addSiegeNodeListBenchmarks(BenchmarkSuite& suite, const std::shared_ptr<ReaderFixture>& fixture, uint32_t scale)
+    {
+        const uint32_t width = 32 * scale, height = 32;
+
+        // the door pass on its own against a prebuilt grid of nodes that all share one mesh
+        auto mesh = ReaderWriterSNO::create(fixture->fileSys, fixture->fileNameMap)->read("/bench/mesh", fixture->options).cast<SiegeNodeMesh>();
+
+        if (!mesh)
+        {
+            spdlog::get("log")->error("could not build the synthetic siege node mesh, skipping siege node list benchmarks");
+            return;
+        }
+
+        auto transforms = std::make_shared<std::vector<vsg::ref_ptr<vsg::MatrixTransform>>>();
+        auto nodeMap = std::make_shared<ReaderWriterSiegeNodeList::NodeMap>();
+        auto doorMap = std::make_shared<ReaderWriterSiegeNodeList::DoorMap>();
+
+        for (uint32_t z = 0; z < height; ++z)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t guid = FIRST_NODE_GUID + z * width + x;
+
+                auto xform = vsg::MatrixTransform::create();
+                xform->addChild(mesh);
+
+                transforms->push_back(xform);
+                nodeMap->emplace(guid, xform.get());
+
+                if (x + 1 < width) doorMap->emplace(guid, ReaderWriterSiegeNodeList::DoorEntry{1, 2, guid + 1});
+                if (x > 0) doorMap->emplace(guid, ReaderWriterSiegeNodeList::DoorEntry{2, 1, guid - 1});
+                if (z + 1 < height) doorMap->emplace(guid, ReaderWriterSiegeNodeList::DoorEntry{3, 4, guid + width});
+                if (z > 0) doorMap->emplace(guid, ReaderWriterSiegeNodeList::DoorEntry{4, 3, guid - width});
+            }
+        }
+
+        suite.add("siegenodelist/connectDoors", [transforms, nodeMap, doorMap]() {
+            ReaderWriterSiegeNodeList::connectDoors(FIRST_NODE_GUID, *doorMap, *nodeMap);
+            doNotOptimize(transforms.get());
+        }, 0, nodeMap->size());
+
+        // the whole nodes.gas read: parse, mesh lookups through vsg::read and the door pass
+        fixture->fileSys.add("/world/global/siege_nodes/synthetic.gas", "[mesh_list]\n{\n\t[*]\n\t{\n\t\tguid = " + hexGuid(MESH_GUID) + ";\n\t\tfilename = /bench/mesh;\n\t}\n}\n");
+        fixture->fileSys.add("/bench/nodes.gas", generateNodesGas(width, height, FIRST_NODE_GUID, MESH_GUID));
+
+        auto options = vsg::Options::create(*fixture->options);
+        options->setObject("SiegeNodeMeshGuidDatabase", SiegeNodeMeshGUIDDatabase::create(fixture->fileSys));
+        options->readerWriters = {ReaderWriterSNO::create(fixture->fileSys, fixture->fileNameMap)};
+
+        auto nodeListReader = ReaderWriterSiegeNodeList::create(fixture->fileSys, fixture->fileNameMap);
+
+        suite.add("siegenodelist/read", [fixture, options, nodeListReader]() {
+            auto object = nodeListReader->read("/bench/nodes.gas", options);
+            doNotOptimize(object.get());
+        }, 0, width * height);
+    }
+} // namespace ehb
+
+int main(int argc, char* argv[])
+{
+    using namespace ehb;
+
+    auto log = spdlog::stdout_color_mt("log");
+
+    std::string filter, jsonReport;
+    double minTime = 0.5;
+    uint32_t scale = 1;
+
+    vsg::CommandLine args(&argc, argv);
+    args.read("--filter", filter);
+    args.read("--min-time", minTime);
+    args.read("--scale", scale);
+    args.read("--json", jsonReport);
+
+    scale = std::max(1u, scale);
+
+    // the readers log every node they place, keep the output to the results
+    log->set_level(spdlog::level::warn);
+
+    SiegeNodePipeline::SetupPipeline();
+
+    auto fixture = std::make_shared<ReaderFixture>();
+    fixture->options->setObject("PipelineLayout", SiegeNodePipeline::PipelineLayout);
+
+    BenchmarkSuite suite;
+
+    addFuelBenchmarks(suite, scale);
+    addContentDbBenchmarks(suite, scale);
+    addReaderBenchmarks(suite, fixture, scale);
+    addSiegeNodeListBenchmarks(suite, fixture, scale);
+
+    const auto results = suite.run(filter, minTime);
+
+    log->set_level(spdlog::level::info);
+
+    for (const auto& result : results)
+    {
+        if (result.bytesPerIteration != 0)
+        {
+            log->info("{:<32} {:>14.0f} ns  {:>10.2f} MiB/s", result.name, result.medianNs, result.bytesPerIteration * 1e9 / result.medianNs / (1024 * 1024));
+        }
+        else if (result.itemsPerIteration != 0)
+        {
+            log->info("{:<32} {:>14.0f} ns  {:>10.0f} items/s", result.name, result.medianNs, result.itemsPerIteration * 1e9 / result.medianNs);
+        }
+        else
+        {
+            log->info("{:<32} {:>14.0f} ns", result.name, result.medianNs);
+        }
+    }
+
+    if (!jsonReport.empty())
+    {
+        if (std::ofstream stream(jsonReport); stream.is_open())
+        {
+            BenchmarkSuite::writeJson(stream, results);
+        }
+        else
+        {
+            log->error("could not write {}", jsonReport);
+            return 1;
+        }
+    }
+    else
+    {
+        BenchmarkSuite::writeJson(std::cout, results);
+    }
+
+    return 0;
+}
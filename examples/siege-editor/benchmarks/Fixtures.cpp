@@ -0,0 +1,471 @@
+
+#include "Fixtures.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace ehb
+{
+    namespace
+    {
+        class ByteWriter
+        {
+        public:
+            template <typename T>
+            void write(const T& value)
+            {
+                const size_t offset = bytes.size();
+                bytes.resize(offset + sizeof(T));
+                std::memcpy(bytes.data() + offset, &value, sizeof(T));
+            }
+
+            void writeFloats(std::initializer_list<float> values)
+            {
+                for (float value : values)
+                {
+                    write(value);
+                }
+            }
+
+            void writeFourCC(const char fourCC[5])
+            {
+                bytes.insert(bytes.end(), fourCC, fourCC + 4);
+            }
+
+            void writeString(const std::string& value)
+            {
+                bytes.insert(bytes.end(), value.begin(), value.end());
+                bytes.push_back(0);
+            }
+
+            std::vector<uint8_t> bytes;
+        };
+
+        struct Door
+        {
+            uint32_t id;
+            float x, z;
+            float rotation[9];
+        };
+
+        // door transforms sit on the middle of each edge, the rotation turns the door to face outwards
+        const Door doors[4] = {
+            {1, 1.f, 0.f, {0, 0, -1, 0, 1, 0, 1, 0, 0}},
+            {2, -1.f, 0.f, {0, 0, 1, 0, 1, 0, -1, 0, 0}},
+            {3, 0.f, 1.f, {1, 0, 0, 0, 1, 0, 0, 0, 1}},
+            {4, 0.f, -1.f, {-1, 0, 0, 0, 1, 0, 0, 0, -1}}};
+
+        constexpr uint32_t SNO_MAGIC = 0x444F4E53;
+        constexpr uint32_t RAW_MAGIC = 0x52617069;
+        constexpr uint32_t RAW_FORMAT_8888 = 0x38383838;
+
+        // Aspect::Impl::Version::v4_1
+        constexpr uint32_t ASP_VERSION = 260;
+
+        constexpr float NODE_SIZE = 4.f;
+
+        // guids are written the way the editor writes them, 0x followed by eight hex digits
+        std::string guidOf(uint32_t guid)
+        {
+            std::ostringstream stream;
+            stream << "0x" << std::hex << std::setw(8) << std::setfill('0') << guid;
+            return stream.str();
+        }
+    } // namespace
+
+    std::string generateTemplateGas(uint32_t first, uint32_t count, uint32_t chainDepth)
+    {
+        std::ostringstream gas;
+
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            gas << "[t:template,n:tmpl_" << i << "]\n{\n";
+            gas << "\tcategory_name = \"synthetic\";\n";
+            gas << "\tdoc = \"synthetic template " << i << "\";\n";
+
+            if (chainDepth > 1 && (i % chainDepth) != 0)
+            {
+                gas << "\tspecializes = tmpl_" << (i - 1) << ";\n";
+            }
+
+            gas << "\t[aspect]\n\t{\n";
+            gas << "\t\tmodel = m_synthetic_" << (i % SYNTHETIC_MODEL_COUNT) << ";\n";
+            gas << "\t\tscale_base = " << (1.0f + (i % 10) * 0.05f) << ";\n";
+            gas << "\t\tdraw_shadow = " << ((i & 1) ? "true" : "false") << ";\n";
+            gas << "\t\tlife = " << (10 + i % 500) << ";\n";
+            gas << "\t\tmax_life = " << (10 + i % 500) << ";\n";
+            gas << "\t}\n";
+
+            gas << "\t[common]\n\t{\n";
+            gas << "\t\tscreen_name = \"Synthetic Thing " << i << "\";\n";
+            gas << "\t\tmembership = monster,synthetic;\n";
+            gas << "\t\tx guid = 0x" << std::hex << (0x10000000u + i) << std::dec << ";\n";
+            gas << "\t}\n";
+
+            gas << "\t[physics]\n\t{\n";
+            gas << "\t\texplosion_magnitude = " << (i % 7) * 0.25f << ";\n";
+            gas << "\t\tgib_min = " << (i % 3) << ";\n";
+            gas << "\t\tgib_max = " << (3 + i % 5) << ";\n";
+            gas << "\t}\n";
+
+            gas << "\t[inventory]\n\t{\n\t\t[pcontent]\n\t\t{\n\t\t\t[all*]\n\t\t\t{\n";
+            gas << "\t\t\t\til_main = #weapon/-rare(1)/" << (1 + i % 20) << "," << (10 + i % 40) << ";\n";
+            gas << "\t\t\t}\n\t\t}\n\t}\n";
+
+            gas << "}\n";
+        }
+
+        return gas.str();
+    }
+
+    std::vector<uint8_t> generateSno(uint32_t gridSize, uint32_t doorCount, uint32_t textureCount)
+    {
+        gridSize = std::max(1u, gridSize);
+        doorCount = std::min(4u, doorCount);
+        textureCount = std::max(1u, textureCount);
+
+        const uint32_t cornerCount = (gridSize + 1) * (gridSize + 1);
+        const uint32_t faceCount = gridSize * gridSize * 2;
+
+        ByteWriter out;
+
+        out.write(SNO_MAGIC);
+        out.write<uint32_t>(7); // version
+        out.write<uint32_t>(0);
+
+        out.write(doorCount);
+        out.write<uint32_t>(0); // spots
+        out.write(cornerCount);
+        out.write(faceCount);
+        out.write(textureCount);
+
+        const float half = NODE_SIZE * 0.5f;
+        out.writeFloats({-half, 0.f, -half, half, 0.f, half});
+        out.writeFloats({0.f, 0.f, 0.f});
+        out.write<uint32_t>(0);
+        out.write<uint32_t>(0);
+        out.write<uint32_t>(0);
+        out.write<uint32_t>(0);
+        out.write(0.f); // checksum
+
+        for (uint32_t i = 0; i < doorCount; ++i)
+        {
+            const Door& door = doors[i];
+
+            out.write<int32_t>(door.id);
+            out.writeFloats({door.x * half, 0.f, door.z * half});
+
+            for (float value : door.rotation)
+            {
+                out.write(value);
+            }
+
+            // vertex indices along the door edge
+            out.write<int32_t>(2);
+            out.write<uint32_t>(0);
+            out.write<uint32_t>(1);
+        }
+
+        for (uint32_t z = 0; z <= gridSize; ++z)
+        {
+            for (uint32_t x = 0; x <= gridSize; ++x)
+            {
+                const float u = static_cast<float>(x) / gridSize;
+                const float v = static_cast<float>(z) / gridSize;
+
+                out.writeFloats({(u - 0.5f) * NODE_SIZE, 0.f, (v - 0.5f) * NODE_SIZE});
+                out.writeFloats({0.f, 1.f, 0.f});
+                out.write<uint32_t>(0xffffffff);
+                out.writeFloats({u, v});
+            }
+        }
+
+        // faces are split evenly between the textures, the last one takes the remainder
+        const uint32_t quadsPerTexture = (gridSize * gridSize) / textureCount;
+        uint32_t quad = 0;
+
+        for (uint32_t t = 0; t < textureCount; ++t)
+        {
+            const uint32_t quads = t + 1 == textureCount ? gridSize * gridSize - quad : quadsPerTexture;
+
+            out.writeString("t_synthetic_" + std::to_string(t));
+            out.write<uint32_t>(0); // start
+            out.write<uint32_t>(cornerCount);
+            out.write<uint32_t>(quads * 6);
+
+            for (uint32_t q = quad; q < quad + quads; ++q)
+            {
+                const uint32_t x = q % gridSize, z = q / gridSize;
+                const uint16_t a = static_cast<uint16_t>(z * (gridSize + 1) + x);
+                const uint16_t b = static_cast<uint16_t>(a + 1);
+                const uint16_t c = static_cast<uint16_t>(a + gridSize + 1);
+                const uint16_t d = static_cast<uint16_t>(c + 1);
+
+                for (uint16_t index : {a, c, b, b, c, d})
+                {
+                    out.write(index);
+                }
+            }
+
+            quad += quads;
+        }
+
+        return std::move(out.bytes);
+    }
+
+    std::vector<uint8_t> generateAsp(uint32_t vertexCount, uint32_t faceCount, const std::string& textureName)
+    {
+        vertexCount = std::max(3u, vertexCount);
+
+        // one corner per vertex keeps the mesh simple
+        const uint32_t cornerCount = vertexCount;
+
+        std::string text = textureName;
+        text.push_back(0);
+        text += "root";
+        text.push_back(0);
+
+        while (text.size() % 4 != 0)
+        {
+            text.push_back(0);
+        }
+
+        ByteWriter out;
+
+        out.writeFourCC("BMSH");
+        out.write(ASP_VERSION);
+        out.write<uint32_t>(static_cast<uint32_t>(text.size()));
+        out.write<uint32_t>(1); // bones
+        out.write<uint32_t>(1); // textures
+        out.write(vertexCount);
+        out.write<uint32_t>(1); // sub meshes
+        out.write<uint32_t>(0); // render flags
+        out.bytes.insert(out.bytes.end(), text.begin(), text.end());
+
+        out.writeFourCC("BONH");
+        out.write(ASP_VERSION);
+        out.write<uint32_t>(0); // bone index
+        out.write<uint32_t>(0); // parent
+        out.write<uint32_t>(0); // flags
+
+        out.writeFourCC("BSUB");
+        out.write(ASP_VERSION);
+        out.write<uint32_t>(0); // sub mesh index
+        out.write<uint32_t>(1);
+        out.write(vertexCount);
+        out.write(cornerCount);
+        out.write(faceCount);
+
+        out.writeFourCC("BSMM");
+        out.write(ASP_VERSION);
+        out.write<uint32_t>(1);
+        out.write<uint32_t>(0); // texture index
+        out.write(faceCount);
+
+        out.writeFourCC("BVTX");
+        out.write(ASP_VERSION);
+        out.write(vertexCount);
+
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            out.writeFloats({static_cast<float>(v % 17), static_cast<float>(v / 17), static_cast<float>(v % 5)});
+        }
+
+        out.writeFourCC("BCRN");
+        out.write(ASP_VERSION);
+        out.write(cornerCount);
+
+        for (uint32_t c = 0; c < cornerCount; ++c)
+        {
+            out.write(c);
+            out.writeFloats({0.f, 1.f, 0.f});
+            out.write<uint32_t>(0xffffffff);
+            out.write<uint32_t>(0);
+            out.writeFloats({static_cast<float>(c % 2), static_cast<float>((c / 2) % 2)});
+        }
+
+        out.writeFourCC("WCRN");
+        out.write(ASP_VERSION);
+        out.write(cornerCount);
+
+        for (uint32_t c = 0; c < cornerCount; ++c)
+        {
+            out.writeFloats({static_cast<float>(c % 17), static_cast<float>(c / 17), static_cast<float>(c % 5)});
+            out.writeFloats({1.f, 0.f, 0.f, 0.f});
+            out.write<uint32_t>(0);
+            out.writeFloats({0.f, 1.f, 0.f});
+            out.write<uint32_t>(0xffffffff);
+            out.writeFloats({static_cast<float>(c % 2), static_cast<float>((c / 2) % 2)});
+        }
+
+        out.writeFourCC("BTRI");
+        out.write(ASP_VERSION);
+        out.write(faceCount);
+        out.write<uint32_t>(0); // corner start
+        out.write(cornerCount); // corner span
+
+        for (uint32_t f = 0; f < faceCount; ++f)
+        {
+            out.write(f % cornerCount);
+            out.write((f + 1) % cornerCount);
+            out.write((f + 2) % cornerCount);
+        }
+
+        out.writeFourCC("RPOS");
+        out.write(ASP_VERSION);
+        out.write<uint32_t>(1);
+        out.writeFloats({0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f});
+        out.writeFloats({0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f});
+
+        return std::move(out.bytes);
+    }
+
+    std::vector<uint8_t> generateRaw(uint16_t width, uint16_t height)
+    {
+        ByteWriter out;
+
+        out.write(RAW_MAGIC);
+        out.write(RAW_FORMAT_8888);
+        out.write<uint16_t>(0); // flags
+        out.write<uint16_t>(1); // surfaces
+        out.write(width);
+        out.write(height);
+
+        out.bytes.reserve(out.bytes.size() + static_cast<size_t>(width) * height * 4);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                out.write<uint8_t>(static_cast<uint8_t>(x));
+                out.write<uint8_t>(static_cast<uint8_t>(y));
+                out.write<uint8_t>(static_cast<uint8_t>(x ^ y));
+                out.write<uint8_t>(255);
+            }
+        }
+
+        return std::move(out.bytes);
+    }
+
+    std::string generateNodesGas(uint32_t width, uint32_t height, uint32_t firstGuid, uint32_t firstMeshGuid, uint32_t meshCount)
+    {
+        std::ostringstream gas;
+
+        meshCount = std::max(1u, meshCount);
+
+        gas << "[siege_node_list]\n{\n";
+        gas << "\tx targetnode = " << guidOf(firstGuid) << ";\n";
+
+        for (uint32_t z = 0; z < height; ++z)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t guid = firstGuid + z * width + x;
+
+                gas << "\t[t:snode,n:" << guidOf(guid) << "]\n\t{\n";
+                gas << "\t\tx guid = " << guidOf(guid) << ";\n";
+                gas << "\t\tmesh_guid = " << guidOf(firstMeshGuid + (z * width + x) % meshCount) << ";\n";
+                gas << "\t\ttexsetabbr = grs01;\n";
+
+                auto door = [&gas](uint32_t id, uint32_t farGuid, uint32_t farDoor) {
+                    gas << "\t\t[door*]\n\t\t{\n";
+                    gas << "\t\t\tfardoor = " << farDoor << ";\n";
+                    gas << "\t\t\tfarguid = " << guidOf(farGuid) << ";\n";
+                    gas << "\t\t\tid = " << id << ";\n";
+                    gas << "\t\t}\n";
+                };
+
+                if (x + 1 < width) door(1, guid + 1, 2);
+                if (x > 0) door(2, guid - 1, 1);
+                if (z + 1 < height) door(3, guid + width, 4);
+                if (z > 0) door(4, guid - width, 3);
+
+                gas << "\t}\n";
+            }
+        }
+
+        gas << "}\n";
+
+        return gas.str();
+    }
+
+    std::string generateMeshListGas(uint32_t firstMeshGuid, uint32_t meshCount)
+    {
+        std::ostringstream gas;
+
+        gas << "[t:mesh_file_list,n:synthetic]\n{\n";
+
+        for (uint32_t i = 0; i < meshCount; ++i)
+        {
+            gas << "\t[t:mesh_file,n:" << i << "]\n\t{\n";
+            gas << "\t\tfilename = t_synthetic_node_" << i << ";\n";
+            gas << "\t\tguid = " << guidOf(firstMeshGuid + i) << ";\n";
+            gas << "\t}\n";
+        }
+
+        gas << "}\n";
+
+        return gas.str();
+    }
+
+    std::string generateObjectGas(uint32_t count, uint32_t templateCount, uint32_t firstNodeGuid, uint32_t nodeCount, uint32_t firstObjectGuid)
+    {
+        std::ostringstream gas;
+
+        templateCount = std::max(1u, templateCount);
+        nodeCount = std::max(1u, nodeCount);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // spread objects over the nodes with a stride so neighbours don't all land on the same node
+            const uint32_t node = (i * 7919u) % nodeCount;
+
+            gas << "[t:tmpl_" << (i % templateCount) << ",n:" << guidOf(firstObjectGuid + i) << "]\n{\n";
+            gas << "\t[placement]\n\t{\n";
+            gas << "\t\tp position = " << (i % 4) * 0.5f << ",0," << ((i / 4) % 4) * 0.5f << "," << guidOf(firstNodeGuid + node) << ";\n";
+            gas << "\t\tq orientation = 0,0,0,1;\n";
+            gas << "\t}\n";
+            gas << "}\n";
+        }
+
+        return gas.str();
+    }
+
+    std::string generateMapGas(const std::string& name)
+    {
+        std::ostringstream gas;
+
+        gas << "[t:map,n:map]\n{\n";
+        gas << "\tdescription = \"synthetic map\";\n";
+        gas << "\tname = " << name << ";\n";
+        gas << "\tscreen_name = \"" << name << "\";\n";
+        gas << "}\n";
+
+        return gas.str();
+    }
+
+    std::string generateRegionGas(uint32_t guid, const std::string& description)
+    {
+        std::ostringstream gas;
+
+        gas << "[t:region,n:region]\n{\n";
+        gas << "\tdescription = \"" << description << "\";\n";
+        gas << "\tx guid = " << guidOf(guid) << ";\n";
+        gas << "}\n";
+
+        return gas.str();
+    }
+
+    std::string generateNamingKey()
+    {
+        return "# synthetic naming key\n"
+               "TREE = B, b, \"bitmaps\"\n"
+               "TREE = B_SYNTHETIC, synthetic, \"synthetic bitmaps\"\n"
+               "TREE = M, m, \"meshes\"\n"
+               "TREE = M_SYNTHETIC, synthetic, \"synthetic meshes\"\n"
+               "TREE = T, t, \"terrain\"\n"
+               "TREE = T_SYNTHETIC, synthetic, \"synthetic terrain\"\n";
+    }
+} // namespace ehb
@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ehb
+{
+    //! templates reference models m_synthetic_0 .. m_synthetic_<SYNTHETIC_MODEL_COUNT - 1>
+    constexpr uint32_t SYNTHETIC_MODEL_COUNT = 97;
+
+    /**
+     * generators for synthetic content in the formats our loaders read
+     *
+     * nothing here is copied from retail data, the output is only meant to be structurally valid so the loaders
+     * take their normal code paths, every generator is deterministic for the same arguments
+     */
+
+    //! templates named tmpl_<first> .. tmpl_<first + count - 1>, every template specializes the one before it
+    //! until chainDepth templates have been chained after which a new chain starts
+    std::string generateTemplateGas(uint32_t first, uint32_t count, uint32_t chainDepth);
+
+    //! a siege node mesh that is a grid of quads with up to four doors, one centered on each edge
+    //! door 1 faces +x, door 2 faces -x, door 3 faces +z and door 4 faces -z
+    std::vector<uint8_t> generateSno(uint32_t gridSize, uint32_t doorCount, uint32_t textureCount);
+
+    //! a single bone, single sub mesh aspect with vertexCount vertices and faceCount faces
+    std::vector<uint8_t> generateAsp(uint32_t vertexCount, uint32_t faceCount, const std::string& textureName);
+
+    //! an 8888 raw image filled with a gradient
+    std::vector<uint8_t> generateRaw(uint16_t width, uint16_t height);
+
+    //! a nodes.gas laying width * height nodes out on a grid with every node linked to its neighbours through doors 1-4
+    //! node guids are firstGuid + index and node i uses mesh guid firstMeshGuid + i % meshCount
+    std::string generateNodesGas(uint32_t width, uint32_t height, uint32_t firstGuid, uint32_t firstMeshGuid, uint32_t meshCount = 1);
+
+    //! a /world/global/siege_nodes file mapping mesh guids firstMeshGuid + i to t_synthetic_node_<i>
+    std::string generateMeshListGas(uint32_t firstMeshGuid, uint32_t meshCount);
+
+    //! count objects instancing tmpl_0 .. tmpl_<templateCount - 1>, each placed on one of nodeCount nodes starting at firstNodeGuid
+    std::string generateObjectGas(uint32_t count, uint32_t templateCount, uint32_t firstNodeGuid, uint32_t nodeCount, uint32_t firstObjectGuid);
+
+    //! main.gas for a map and for a region
+    std::string generateMapGas(const std::string& name);
+    std::string generateRegionGas(uint32_t guid, const std::string& description);
+
+    //! a naming key resolving the m_synthetic_, t_synthetic_ and b_synthetic_ prefixes to /art/{m,t,b}/synthetic
+    std::string generateNamingKey();
+} // namespace ehb
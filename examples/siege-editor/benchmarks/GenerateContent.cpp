@@ -0,0 +1,233 @@
+
+// clang-format off
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// clang-format on
+#include <algorithm>
+#include <fstream>
+
+#include <vsg/utils/CommandLine.h>
+
+#include "Fixtures.hpp"
+#include "io/IFileSys.hpp"
+
+/*
+ * siege-content-gen: writes a synthetic bits tree for stress testing the loaders
+ *
+ * siege-content-gen --out <dir> [--scale n] [--templates n] [--templates-per-file n] [--chain-depth n]
+ *                   [--maps n] [--regions n] [--width n] [--height n] [--objects n] [--meshes n]
+ *                   [--mesh-grid n] [--model-vertices n] [--model-faces n] [--textures n] [--texture-size n]
+ *
+ * the output is a normal bits directory so it can be handed to the editor, siege-load-bench or siege-benchmarks
+ * with --bits <dir>. --scale multiplies the template, node and object counts, sizes default to roughly retail
+ */
+
+namespace ehb
+{
+    struct GeneratorSettings
+    {
+        uint32_t templates = 2000;
+        uint32_t templatesPerFile = 250;
+        uint32_t chainDepth = 8;
+        uint32_t maps = 1;
+        uint32_t regions = 1;
+        uint32_t width = 32;
+        uint32_t height = 32;
+        uint32_t objects = 500;
+        uint32_t meshes = 16;
+        uint32_t meshGrid = 4;
+        uint32_t modelVertices = 500;
+        uint32_t modelFaces = 800;
+        uint32_t textures = 8;
+        uint32_t textureSize = 64;
+    };
+
+    class ContentWriter
+    {
+    public:
+        explicit ContentWriter(const fs::path& root) :
+            root(root)
+        {
+        }
+
+        bool write(const std::string& filename, const std::string& text)
+        {
+            return write(filename, text.data(), text.size());
+        }
+
+        bool write(const std::string& filename, const std::vector<uint8_t>& data)
+        {
+            return write(filename, reinterpret_cast<const char*>(data.data()), data.size());
+        }
+
+        uint64_t filesWritten = 0;
+        uint64_t bytesWritten = 0;
+
+    private:
+        bool write(const std::string& filename, const char* data, size_t size)
+        {
+            const fs::path path = root / filename;
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+
+            if (std::ofstream stream(path, std::ios::binary); stream.is_open() && stream.write(data, size))
+            {
+                ++filesWritten;
+                bytesWritten += size;
+
+                return true;
+            }
+
+            spdlog::get("log")->error("could not write {}", path.string());
+
+            return false;
+        }
+
+        fs::path root;
+    };
+
+    static constexpr uint32_t FIRST_MESH_GUID = 0x0a000000;
+    static constexpr uint32_t FIRST_NODE_GUID = 0x01000000;
+    static constexpr uint32_t FIRST_OBJECT_GUID = 0x40000000;
+    static constexpr uint32_t FIRST_REGION_GUID = 0x00000100;
+
+    static bool generate(ContentWriter& out, const GeneratorSettings& settings)
+    {
+        auto log = spdlog::get("log");
+
+        bool ok = out.write("art/namingkey.nnk", generateNamingKey());
+
+        // textures shared by the terrain and the models
+        const auto raw = generateRaw(static_cast<uint16_t>(settings.textureSize), static_cast<uint16_t>(settings.textureSize));
+
+        for (uint32_t t = 0; t < settings.textures; ++t)
+        {
+            ok &= out.write("art/t/synthetic/t_synthetic_" + std::to_string(t) + ".raw", raw);
+            ok &= out.write("art/b/synthetic/b_synthetic_" + std::to_string(t) + ".raw", raw);
+        }
+
+        // every siege node mesh has the same footprint and door layout so any mesh can sit next to any other
+        const auto sno = generateSno(settings.meshGrid, 4, settings.textures);
+
+        for (uint32_t i = 0; i < settings.meshes; ++i)
+        {
+            ok &= out.write("art/t/synthetic/t_synthetic_node_" + std::to_string(i) + ".sno", sno);
+        }
+
+        ok &= out.write("world/global/siege_nodes/synthetic/synthetic.gas", generateMeshListGas(FIRST_MESH_GUID, settings.meshes));
+
+        for (uint32_t i = 0; i < SYNTHETIC_MODEL_COUNT; ++i)
+        {
+            const std::string texture = "b_synthetic_" + std::to_string(i % settings.textures);
+
+            ok &= out.write("art/m/synthetic/m_synthetic_" + std::to_string(i) + ".asp", generateAsp(settings.modelVertices, settings.modelFaces, texture));
+        }
+
+        log->info("wrote {} textures, {} siege node meshes and {} models", settings.textures * 2, settings.meshes, SYNTHETIC_MODEL_COUNT);
+
+        // templates are split over several files so ContentDb has something to load in parallel
+        const uint32_t perFile = std::max(1u, settings.templatesPerFile);
+
+        for (uint32_t first = 0, file = 0; first < settings.templates; first += perFile, ++file)
+        {
+            const uint32_t count = std::min(perFile, settings.templates - first);
+
+            ok &= out.write("world/contentdb/templates/synthetic/synthetic_" + std::to_string(file) + ".gas", generateTemplateGas(first, count, settings.chainDepth));
+        }
+
+        log->info("wrote {} templates in chains of {}", settings.templates, settings.chainDepth);
+
+        const uint32_t nodeCount = settings.width * settings.height;
+
+        for (uint32_t m = 0; m < settings.maps; ++m)
+        {
+            const std::string mapName = "synthetic_" + std::to_string(m);
+            const std::string mapPath = "world/maps/" + mapName;
+
+            ok &= out.write(mapPath + "/main.gas", generateMapGas(mapName));
+
+            for (uint32_t r = 0; r < settings.regions; ++r)
+            {
+                const uint32_t regionIndex = m * settings.regions + r;
+                const std::string regionPath = mapPath + "/regions/r" + std::to_string(r);
+
+                // keep guids unique across every region of every map
+                const uint32_t firstNode = FIRST_NODE_GUID + regionIndex * nodeCount;
+                const uint32_t firstObject = FIRST_OBJECT_GUID + regionIndex * settings.objects;
+
+                ok &= out.write(regionPath + "/main.gas", generateRegionGas(FIRST_REGION_GUID + regionIndex, mapName + " region " + std::to_string(r)));
+                ok &= out.write(regionPath + "/terrain_nodes/nodes.gas", generateNodesGas(settings.width, settings.height, firstNode, FIRST_MESH_GUID, settings.meshes));
+
+                // half the objects go to actor.gas and the rest to non_interactive.gas, the two files the region reader always tries
+                const uint32_t actors = settings.objects / 2;
+
+                ok &= out.write(regionPath + "/objects/actor.gas", generateObjectGas(actors, settings.templates, firstNode, nodeCount, firstObject));
+                ok &= out.write(regionPath + "/objects/non_interactive.gas", generateObjectGas(settings.objects - actors, settings.templates, firstNode, nodeCount, firstObject + actors));
+            }
+        }
+
+        log->info("wrote {} maps with {} regions each, {} nodes and {} objects per region", settings.maps, settings.regions, nodeCount, settings.objects);
+
+        return ok;
+    }
+} // namespace ehb
+
+int main(int argc, char* argv[])
+{
+    using namespace ehb;
+
+    auto log = spdlog::stdout_color_mt("log");
+
+    std::string outDir;
+    uint32_t scale = 1;
+
+    GeneratorSettings settings;
+
+    vsg::CommandLine args(&argc, argv);
+    args.read("--out", outDir);
+    args.read("--scale", scale);
+
+    scale = std::max(1u, scale);
+
+    settings.templates *= scale;
+    settings.width *= scale;
+    settings.objects *= scale;
+
+    args.read("--templates", settings.templates);
+    args.read("--templates-per-file", settings.templatesPerFile);
+    args.read("--chain-depth", settings.chainDepth);
+    args.read("--maps", settings.maps);
+    args.read("--regions", settings.regions);
+    args.read("--width", settings.width);
+    args.read("--height", settings.height);
+    args.read("--objects", settings.objects);
+    args.read("--meshes", settings.meshes);
+    args.read("--mesh-grid", settings.meshGrid);
+    args.read("--model-vertices", settings.modelVertices);
+    args.read("--model-faces", settings.modelFaces);
+    args.read("--textures", settings.textures);
+    args.read("--texture-size", settings.textureSize);
+
+    if (outDir.empty())
+    {
+        log->error("usage: siege-content-gen --out <dir> [--scale n] [--templates n] [--maps n] [--regions n] [--width n] [--height n] [--objects n] ...");
+
+        return 1;
+    }
+
+    settings.meshes = std::max(1u, settings.meshes);
+    settings.textures = std::max(1u, settings.textures);
+    settings.textureSize = std::clamp(settings.textureSize, 1u, 4096u);
+    settings.width = std::max(1u, settings.width);
+    settings.height = std::max(1u, settings.height);
+
+    ContentWriter out(outDir);
+
+    const bool ok = generate(out, settings);
+
+    log->info("{} files, {} MiB written to {}", out.filesWritten, out.bytesWritten / (1024 * 1024), outDir);
+
+    return ok ? 0 : 1;
+}
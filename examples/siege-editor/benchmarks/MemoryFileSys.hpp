@@ -0,0 +1,84 @@
+
+#pragma once
+
+#include "io/IFileSys.hpp"
+
+#include <map>
+#include <sstream>
+
+namespace ehb
+{
+    //! file system that serves files held in memory, lets benchmarks run the real loaders without touching the disk
+    class MemoryFileSys : public IFileSys
+    {
+    public:
+        virtual void init(IConfig&) override {}
+
+        void add(const std::string& filename, std::vector<uint8_t> bytes);
+        void add(const std::string& filename, const std::string& text);
+
+        virtual InputStream createInputStream(const std::string& filename) override;
+        virtual InputView createInputView(const std::string& filename) override;
+
+        virtual FileList getFiles() const override;
+        virtual FileList getDirectoryContents(const std::string& directory) const override;
+        virtual FileList getFilesUnder(const std::string& prefix) const override;
+
+    private:
+        std::map<std::string, InputView> files;
+        FileList entries;
+    };
+
+    inline void MemoryFileSys::add(const std::string& filename, std::vector<uint8_t> bytes)
+    {
+        files[filename] = MappedFile::fromBuffer(std::move(bytes));
+        entries.emplace(filename);
+    }
+
+    inline void MemoryFileSys::add(const std::string& filename, const std::string& text)
+    {
+        add(filename, std::vector<uint8_t>(text.begin(), text.end()));
+    }
+
+    inline InputStream MemoryFileSys::createInputStream(const std::string& filename)
+    {
+        if (auto view = createInputView(filename))
+        {
+            return std::make_unique<std::istringstream>(std::string(view->view()));
+        }
+
+        return {};
+    }
+
+    inline InputView MemoryFileSys::createInputView(const std::string& filename)
+    {
+        const auto itr = files.find(filename);
+
+        return itr != files.end() ? itr->second : InputView();
+    }
+
+    inline FileList MemoryFileSys::getFiles() const
+    {
+        return entries;
+    }
+
+    inline FileList MemoryFileSys::getDirectoryContents(const std::string& directory) const
+    {
+        FileList result;
+
+        const std::string prefix = directory.back() == '/' ? directory : directory + "/";
+
+        for (const auto& filename : filesWithPrefix(entries, prefix))
+        {
+            const auto slash = filename.find('/', prefix.size());
+            result.emplace(filename.substr(0, slash));
+        }
+
+        return result;
+    }
+
+    inline FileList MemoryFileSys::getFilesUnder(const std::string& prefix) const
+    {
+        return filesWithPrefix(entries, prefix);
+    }
+} // namespace ehb
@@ -10,11 +10,18 @@ namespace ehb
     {
         vsg::CommandLine args(&argc, argv);
 
+        { // parse all flags from the command line
+            if (args.read("--profile-startup")) config.setBool("profile-startup", true);
+        }
+
         { // parse all boolean values from the command line
             bool value;
 
+            if (args.read("--contentdb-snapshot", value)) config.setBool("contentdb-snapshot", value);
             if (args.read("--fullscreen", value)) config.setBool("fullscreen", value);
+            if (args.read("--gas-cache", value)) config.setBool("gas-cache", value);
             if (args.read("--intro", value)) config.setBool("intro", value);
+            if (args.read("--lazy-contentdb", value)) config.setBool("lazy-contentdb", value);
             if (args.read("--sound", value)) config.setBool("sound", value);
             if (args.read("--textures", value)) config.setBool("drawtextures", value);
         }
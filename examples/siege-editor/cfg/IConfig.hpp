@@ -15,6 +15,6 @@ namespace ehb
         virtual int getInt(const std::string& key, int defaultValue = 0) const = 0;
         virtual const std::string& getString(const std::string& key, const std::string& defaultValue = "") const = 0;
 
-        virtual void dump(const std::string& context){};
+        virtual void dump(const std::string& /*context*/) {}
     };
 } // namespace ehb
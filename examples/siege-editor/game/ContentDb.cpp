@@ -1,95 +1,410 @@
-
 #include "ContentDb.hpp"
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 #include <spdlog/spdlog.h>
 
+#include "io/GasCache.hpp"
 #include "io/IFileSys.hpp"
+#include "io/ParallelFor.hpp"
 
 namespace ehb
 {
-    void ContentDb::init(IFileSys& fileSys, const std::string& directory)
+    namespace
+    {
+        // notes the top level blocks of a template file without building any of them
+        class TemplateIndexer : public FuelHandler
+        {
+        public:
+            std::vector<std::string> names;
+
+            FuelVisit enterBlock(std::string_view name, std::string_view /*type*/) override
+            {
+                // a ':' would make FuelBlock nest the block, the template is known by its first segment then
+                names.emplace_back(name.substr(0, name.find(':')));
+
+                return FuelVisit::Skip;
+            }
+        };
+
+        // identifies the exact set of template files a snapshot was resolved from, as they were when it was made
+        uint64_t snapshotKey(IFileSys& fileSys, const std::vector<std::string>& files)
+        {
+            std::vector<uint8_t> stamps;
+
+            for (const auto& file : files)
+            {
+                int64_t stamp = fileSys.lastWriteTime(file);
+
+                // a file system that can't tell when a file changed leaves nothing but the contents to go by
+                if (stamp == 0)
+                {
+                    if (const auto view = fileSys.createInputView(file))
+                    {
+                        stamp = static_cast<int64_t>(GasCache::hash(view->data(), view->size()));
+                    }
+                }
+
+                stamps.insert(stamps.end(), file.begin(), file.end());
+                stamps.push_back(0);
+                stamps.insert(stamps.end(), reinterpret_cast<const uint8_t*>(&stamp), reinterpret_cast<const uint8_t*>(&stamp) + sizeof(stamp));
+            }
+
+            return GasCache::hash(stamps.data(), stamps.size());
+        }
+    }
+
+    void ContentDb::init(IFileSys& fileSys, const std::string& directory, Mode mode, const std::string& snapshot)
     {
         auto log = spdlog::get("log");
         log->debug("Starting init of ContentDb");
 
-        std::vector<std::unique_ptr<Fuel>> docs;
-        std::unordered_map<std::string, FuelBlock*> tmplMap;
+        this->fileSys = &fileSys;
+        this->snapshot = snapshot;
+        files = fileSys.gasFilesUnder(directory);
+
+        const uint64_t key = snapshot.empty() ? 0 : snapshotKey(fileSys, files);
 
-        fileSys.eachGasFile(directory, [&docs, &tmplMap](const std::string& filename, auto doc)
+        if (!snapshot.empty())
+        {
+            if (const auto data = MappedFile::map(snapshot))
             {
-                for (auto node : doc->eachChild())
+                std::vector<std::pair<std::string_view, FuelBlock*>> roots;
+
+                arenas.emplace_back(std::make_unique<FuelArena>());
+
+                if (GasCache::decompileSet(*data, key, *arenas.back(), roots, &diagnostics))
                 {
-                    const auto result = tmplMap.emplace(node->name(), node);
+                    for (const auto& root : roots)
+                    {
+                        if (Template* tmpl = addTemplate(std::string(root.first), 0))
+                        {
+                            tmpl->done = true;
+                            tmpl->resolved.store(root.second, std::memory_order_relaxed);
+                        }
+                    }
 
-                    if (result.second != true)
+                    // the templates are as broken as they were when the snapshot was made
+                    for (const auto& message : diagnostics)
                     {
-                        spdlog::get("log")->warn("{}: duplicate entry {} found", filename, node->name());
+                        log->error("{}", message);
                     }
-                }
 
-                docs.emplace_back(std::move(doc));
-            });
+                    log->info("ContentDB has reloaded {} resolved templates from {}", templates.size(), snapshot);
+
+                    return;
+                }
 
-        log->debug("ContentDb is resolving {} templates", tmplMap.size());
+                arenas.clear();
+                diagnostics.clear();
+            }
 
-        std::function<void(const std::string&)> resolve;
+            log->info("ContentDB snapshot {} is missing or out of date, it is written again once every template is resolved", snapshot);
+        }
 
-        resolve = [&resolve, &tmplMap, this](const std::string& name)
+        if (mode == Mode::Lazy)
         {
-            auto log = spdlog::get("log");
+            std::vector<std::vector<std::string>> names(files.size());
+
+            parallelFor(files.size(), [&](size_t i) {
+                TemplateIndexer indexer;
+                fileSys.readGasFile(files[i], indexer);
+                names[i] = std::move(indexer.names);
+            });
 
-            if (db.count(name) == 0)
+            documents.resize(files.size());
+            pending.resize(files.size());
+
+            for (size_t i = 0; i < files.size(); ++i)
             {
-                if (const auto itr = tmplMap.find(name); itr != tmplMap.end())
+                for (const auto& name : names[i])
                 {
-                    FuelBlock* node = itr->second;
+                    if (addTemplate(name, static_cast<uint32_t>(i)))
+                    {
+                        ++pending[i];
+                    }
+                }
+            }
 
-                    const std::string specializes = node->valueOf("specializes");
+            log->info("ContentDB has indexed {} templates, they are resolved as they are used", templates.size());
 
-                    FuelBlock* super = nullptr;
+            /*
+             * the snapshot is written on the side so getting started is no slower than without one. it resolves
+             * everything into a ContentDb of its own on a single thread, so lookups never wait on it and what it
+             * loaded and resolved is let go again once the snapshot is written
+             */
+            if (!snapshot.empty())
+            {
+                snapshotWriter = std::thread([this, key] {
+                    ContentDb full;
+                    full.fileSys = this->fileSys;
+                    full.files = files;
+                    full.snapshot = this->snapshot;
+                    full.quiet = true;
 
-                    if (!specializes.empty())
+                    if (full.resolveAll(1, &stopping))
                     {
-                        resolve(specializes);
+                        full.writeSnapshot(key);
+                    }
+                });
+            }
 
-                        if (const auto itr = db.find(specializes); itr != db.end())
-                        {
-                            super = itr->second.get();
-                        }
+            return;
+        }
+
+        resolveAll();
+
+        size_t bytes = 0;
+
+        for (const auto& arena : arenas)
+        {
+            bytes += arena->bytesReserved();
+        }
+
+        size_t unresolved = 0;
+
+        for (const auto& tmpl : templates)
+        {
+            unresolved += tmpl.resolved.load(std::memory_order_relaxed) ? 0 : 1;
+        }
+
+        log->info("ContentDB has finished loading and resolving {} templates into {} KiB", templates.size() - unresolved, bytes / 1024);
+
+        if (!snapshot.empty())
+        {
+            writeSnapshot(key);
+        }
+    }
+
+    ContentDb::Template* ContentDb::addTemplate(const std::string& name, uint32_t file)
+    {
+        const auto result = index.emplace(name, nullptr);
+
+        if (result.second != true)
+        {
+            if (!quiet)
+            {
+                spdlog::get("log")->warn("{}: duplicate entry {} found", files[file], name);
+            }
+
+            return nullptr;
+        }
+
+        return result.first->second = &templates.emplace_back(&result.first->first, file);
+    }
+
+    bool ContentDb::resolveAll(unsigned maxThreads, const std::atomic<bool>* stopping)
+    {
+        auto log = spdlog::get("log");
+
+        const auto stopped = [stopping]() { return stopping && stopping->load(std::memory_order_relaxed); };
+
+        // the documents only have to live until every template has been resolved into our own arena
+        const FuelBatch docs = fileSys->loadGasBatch(files, maxThreads);
+
+        if (stopped())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < docs.size(); ++i)
+        {
+            if (FuelBlock* doc = docs[i])
+            {
+                for (auto node : doc->eachChild())
+                {
+                    if (Template* tmpl = addTemplate(node->name(), static_cast<uint32_t>(i)))
+                    {
+                        tmpl->source = node;
                     }
+                }
+            }
+        }
+
+        log->debug("ContentDb is resolving {} templates", templates.size());
+
+        /*
+         * the specializes chains form a forest, every template is resolved once the one it specializes is so a level
+         * only depends on the level before it and a whole level can be resolved in parallel
+         */
+        std::unordered_map<const Template*, std::vector<Template*>> specializations;
+        std::vector<std::pair<Template*, const FuelBlock*>> level;
+        std::string missing;
+
+        for (auto& tmpl : templates)
+        {
+            const std::string_view specializes = tmpl.source->valueOf("specializes");
+
+            if (specializes.empty())
+            {
+                level.emplace_back(&tmpl, nullptr);
+            }
+            else if (Template* super = find(std::string(specializes)))
+            {
+                specializations[super].push_back(&tmpl);
+            }
+            else
+            {
+                // resolved as if it specialized nothing
+                missing.append(missing.empty() ? "" : ", ").append(*tmpl.name).append(" (").append(specializes).append(")");
+                level.emplace_back(&tmpl, nullptr);
+            }
+        }
+
+        if (!missing.empty())
+        {
+            report("could not find the templates these specialize: " + missing);
+        }
+
+        for (unsigned i = 0; i < workerCount(templates.size(), maxThreads); ++i)
+        {
+            arenas.emplace_back(std::make_unique<FuelArena>());
+        }
+
+        while (!level.empty())
+        {
+            if (stopped())
+            {
+                return false;
+            }
 
-                    FuelBlock* newNode = super ? super->clone() : node->clone();
+            // a specialization only copies what it overrides, everything else is shared with the resolved super
+            parallelForWorkers(level.size(), [&](unsigned worker, size_t i) {
+                auto [tmpl, super] = level[i];
 
-                    if (super)
+                FuelArena& arena = *arenas[worker];
+
+                tmpl->resolved.store(super ? tmpl->source->overlay(super, arena) : tmpl->source->clone(arena), std::memory_order_relaxed);
+                tmpl->done = true;
+            }, maxThreads);
+
+            std::vector<std::pair<Template*, const FuelBlock*>> next;
+
+            for (auto [tmpl, super] : level)
+            {
+                if (const auto itr = specializations.find(tmpl); itr != specializations.end())
+                {
+                    for (Template* specialization : itr->second)
                     {
-                        node->merge(newNode);
+                        next.emplace_back(specialization, tmpl->resolved.load(std::memory_order_relaxed));
                     }
+                }
+            }
 
-                    db.emplace(name, newNode);
+            level = std::move(next);
+        }
+
+        // whatever no level reached is part of a loop or specializes something that is
+        std::unordered_set<const Template*> seen;
+        std::string loops;
+        size_t unresolved = 0;
+
+        for (auto& tmpl : templates)
+        {
+            if (!tmpl.done)
+            {
+                ++unresolved;
+
+                // walk up the chain until it runs into itself or into a walk that came before
+                std::vector<Template*> chain;
+
+                for (Template* itr = &tmpl; itr && seen.insert(itr).second; itr = find(std::string(itr->source->valueOf("specializes"))))
+                {
+                    chain.push_back(itr);
                 }
-                else
+
+                if (Template* end = chain.empty() ? nullptr : find(std::string(chain.back()->source->valueOf("specializes"))))
                 {
-                    log->error("could not find {}", name);
+                    if (auto start = std::find(chain.begin(), chain.end(), end); start != chain.end())
+                    {
+                        loops.append(loops.empty() ? "" : ", ");
+
+                        for (auto itr = start; itr != chain.end(); ++itr)
+                        {
+                            loops.append(*(*itr)->name).append(" -> ");
+                        }
+
+                        loops.append(*end->name);
+                    }
                 }
             }
-        };
+        }
 
-        for (const auto& entry : tmplMap)
+        if (unresolved != 0)
         {
-            resolve(entry.first);
+            report(std::to_string(unresolved) + " templates could not be resolved as their specializes chain loops back on itself: " + loops);
         }
 
-        log->info("ContentDB has finished loading and resolving {} templates", db.size());
+        for (auto& tmpl : templates)
+        {
+            // the batch is about to go, and a template left unresolved now stays unresolved
+            tmpl.source = nullptr;
+            tmpl.done = true;
+        }
+
+        return true;
     }
 
-    const std::string& ContentDb::queryString(const std::string& query, const std::string& defaultValue) const
+    ContentDb::~ContentDb()
     {
-        if (const auto colon = query.find(':'); colon != std::string::npos)
+        if (snapshotWriter.joinable())
         {
-            if (const auto itr = db.find(query.substr(0, colon)); itr != db.end())
+            stopping.store(true, std::memory_order_relaxed);
+            snapshotWriter.join();
+        }
+    }
+
+    void ContentDb::writeSnapshot(uint64_t key) const
+    {
+        std::vector<std::pair<std::string_view, const FuelBlock*>> roots;
+
+        for (const auto& tmpl : templates)
+        {
+            if (const FuelBlock* resolved = tmpl.resolved.load(std::memory_order_relaxed))
+            {
+                roots.emplace_back(*tmpl.name, resolved);
+            }
+        }
+
+        // like the gas cache this is only an optimization, the next start just resolves everything again
+        if (!GasCache::write(snapshot, GasCache::compileSet(roots, key, diagnostics)))
+        {
+            spdlog::get("log")->warn("could not write ContentDB snapshot {}", snapshot);
+        }
+    }
+
+    void ContentDb::report(std::string message) const
+    {
+        if (!quiet)
+        {
+            spdlog::get("log")->error("{}", message);
+        }
+
+        diagnostics.emplace_back(std::move(message));
+    }
+
+    std::string_view ContentDb::queryString(const std::string& query, std::string_view defaultValue) const
+    {
+        // a query from a file or the console can be any length, it goes through the string lookups that have no segment limit
+        if (const auto split = query.find(':'); split != std::string::npos)
+        {
+            if (const FuelBlock* tmpl = lookup(query.substr(0, split)))
             {
-                return itr->second->valueOf(query.substr(colon + 1));
+                return tmpl->valueOf(std::string_view(query).substr(split + 1), defaultValue);
+            }
+        }
+
+        return defaultValue;
+    }
+
+    std::string_view ContentDb::queryString(const FuelPath& query, std::string_view defaultValue) const
+    {
+        if (query.size() >= 2)
+        {
+            if (const FuelBlock* tmpl = lookup(std::string(query[0].name)))
+            {
+                return tmpl->valueOf(query.subpath(1), defaultValue);
             }
         }
 
@@ -98,8 +413,110 @@ namespace ehb
 
     const FuelBlock* ContentDb::getGameObjectTmpl(const std::string& tmpl) const
     {
-        const auto itr = db.find(tmpl);
+        return lookup(tmpl);
+    }
+
+    ContentDb::Template* ContentDb::find(const std::string& name) const
+    {
+        const auto itr = index.find(name);
+
+        return itr != index.end() ? itr->second : nullptr;
+    }
+
+    const FuelBlock* ContentDb::lookup(const std::string& name) const
+    {
+        Template* tmpl = find(name);
+
+        if (tmpl == nullptr)
+        {
+            return nullptr;
+        }
+
+        if (const FuelBlock* result = tmpl->resolved.load(std::memory_order_acquire))
+        {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return resolve(*tmpl);
+    }
+
+    const FuelBlock* ContentDb::resolve(Template& tmpl) const
+    {
+        if (tmpl.done)
+        {
+            return tmpl.resolved.load(std::memory_order_relaxed);
+        }
+
+        if (tmpl.resolving)
+        {
+            report("the specializes chain of " + *tmpl.name + " loops back on itself");
+            return nullptr;
+        }
+
+        if (tmpl.source == nullptr)
+        {
+            auto& doc = documents[tmpl.file];
+
+            if (!doc)
+            {
+                doc = fileSys->loadGasFile(files[tmpl.file]);
+            }
+
+            tmpl.source = doc ? doc->findChild(*tmpl.name, fuelHash(*tmpl.name)) : nullptr;
+        }
+
+        tmpl.resolving = true;
+
+        const FuelBlock* node = tmpl.source;
+        const FuelBlock* super = nullptr;
+        bool broken = false;
+
+        if (node != nullptr)
+        {
+            if (const std::string specializes(node->valueOf("specializes")); !specializes.empty())
+            {
+                if (Template* parent = find(specializes))
+                {
+                    // same as eager mode, a chain that loops stays unresolved along with everything specializing it
+                    super = resolve(*parent);
+                    broken = super == nullptr;
+                }
+                else
+                {
+                    report("could not find " + specializes);
+                }
+            }
+        }
+
+        FuelBlock* result = nullptr;
+
+        if (node != nullptr && !broken)
+        {
+            // lookups on other threads may be building indices in the arena of templates resolved earlier
+            auto lock = arena.lockShared();
+
+            // a specialization only copies what it overrides, everything else is shared with the resolved super
+            result = super ? node->overlay(super, arena) : node->clone(arena);
+        }
+        else if (node == nullptr)
+        {
+            report("could not find " + *tmpl.name);
+        }
+
+        tmpl.resolving = false;
+        tmpl.done = true;
+        tmpl.resolved.store(result, std::memory_order_release);
+
+        // nothing resolved points into the document so it only has to stay until the last of its templates is done
+        tmpl.source = nullptr;
+
+        if (!pending.empty() && --pending[tmpl.file] == 0)
+        {
+            documents[tmpl.file].reset();
+        }
 
-        return itr != db.end() ? itr->second.get() : nullptr;
+        return result;
     }
-}
\ No newline at end of file
+}
@@ -1,9 +1,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
-#include <memory>
+#include <vector>
 
 #include "io/Fuel.hpp"
 
@@ -14,15 +19,111 @@ namespace ehb
     {
     public:
 
-        void init(IFileSys& fileSys, const std::string& directory = "/world/contentdb/templates/");
+        //! how much of the work init does before it returns
+        enum class Mode
+        {
+            Eager, // every template is parsed and resolved up front
+            Lazy   // only which file each template is in is noted, a template and its specializes chain are resolved on first use
+        };
+
+        /**
+         * in lazy mode fileSys has to outlive the ContentDb, the first lookup of a template reads its file and
+         * those of the templates it specializes
+         *
+         * with a snapshot file every resolved template is reloaded from it as long as no template file was
+         * added, removed or written to since it was made, along with the errors resolving them gave. when one was
+         * eager mode writes the snapshot again once it is done, lazy mode returns as it would without one and
+         * resolves every template a second time on a thread of its own to write it from there
+         *
+         * lookups are safe to make from any number of threads in either mode
+         */
+        void init(IFileSys& fileSys, const std::string& directory = "/world/contentdb/templates/", Mode mode = Mode::Eager, const std::string& snapshot = {});
+
+        //! a snapshot still being written in the background is given up on
+        ~ContentDb();
 
         //! query a string from a given template, for example: "2w_gargoyle:aspect:experience_value"
-        const std::string& queryString(const std::string& query, const std::string& defaultValue = "") const;
+        std::string_view queryString(const std::string& query, std::string_view defaultValue = {}) const;
+
+        //! same as above with a pre-split query, the first segment names the template. meant for queries known at compile time, FuelPath has a fixed segment limit
+        std::string_view queryString(const FuelPath& query, std::string_view defaultValue = {}) const;
 
         const FuelBlock* getGameObjectTmpl(const std::string& tmpl) const;
 
     private:
 
-        std::unordered_map<std::string, std::unique_ptr<FuelBlock>> db;
+        struct Template
+        {
+            const std::string* name;
+            uint32_t file;
+
+            // the unresolved block in its document, only looked at while resolving
+            const FuelBlock* source = nullptr;
+
+            bool resolving = false;
+            bool done = false;
+
+            // published once done so lookups of a resolved template never take the lock
+            std::atomic<const FuelBlock*> resolved{nullptr};
+
+            Template(const std::string* name, uint32_t file) : name(name), file(file) {}
+        };
+
+        //! @return nullptr if a template of the same name was added before
+        Template* addTemplate(const std::string& name, uint32_t file);
+
+        /**
+         * load every file and resolve every template in it level by level on up to maxThreads threads, what eager
+         * mode does
+         *
+         * @return false if stopping was set before it was done, what was resolved so far is left as it is
+         */
+        bool resolveAll(unsigned maxThreads = 0, const std::atomic<bool>* stopping = nullptr);
+
+        Template* find(const std::string& name) const;
+
+        const FuelBlock* lookup(const std::string& name) const;
+
+        //! the caller holds mutex
+        const FuelBlock* resolve(Template& tmpl) const;
+
+        //! log an error found while resolving and keep it for the snapshot, the caller holds mutex in lazy mode
+        void report(std::string message) const;
+
+        //! write every resolved template out to the snapshot file
+        void writeSnapshot(uint64_t key) const;
+
+        // everything below is filled in by init, the mutable parts are what lazy lookups fill in afterwards
+        IFileSys* fileSys = nullptr;
+        std::vector<std::string> files;
+
+        std::unordered_map<std::string, Template*> index;
+        mutable std::deque<Template> templates;
+
+        // lazy mode keeps a document around from when one of its templates is asked for until all of them are resolved
+        mutable std::vector<std::unique_ptr<Fuel>> documents;
+        mutable std::vector<uint32_t> pending;
+
+        mutable std::mutex mutex;
+
+        /*
+         * lazy mode copies resolved templates out of their documents into here so the documents can go once pending
+         * drops to 0, a template that specializes another shares every block it doesn't override with it
+         */
+        mutable FuelArena arena;
+
+        // errors resolving gave, they go into the snapshot so a warm start still reports them
+        mutable std::vector<std::string> diagnostics;
+
+        // keeps errors and duplicates out of the log, they are only collected
+        bool quiet = false;
+
+        // lazy mode writes an out of date snapshot in the background
+        std::string snapshot;
+        std::thread snapshotWriter;
+        std::atomic<bool> stopping{false};
+
+        // eager mode resolves on a pool of threads, each into an arena of its own, a snapshot is reloaded into one
+        std::vector<std::unique_ptr<FuelArena>> arenas;
     };
-}
\ No newline at end of file
+}
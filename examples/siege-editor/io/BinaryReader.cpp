@@ -40,20 +40,30 @@ namespace ehb
 namespace ehb
 {
     BinaryReader::BinaryReader(ByteArray fileData) :
-        fileContents(fileData), readPosition(0)
+        readPosition(0), fileData(std::move(fileData))
     {
         //swap = (osg::getCpuByteOrder() == osg::BigEndian);
+
+        contents = this->fileData.data();
+        contentsSize = this->fileData.size();
+    }
+
+    BinaryReader::BinaryReader(InputView fileView) :
+        readPosition(0), fileView(std::move(fileView))
+    {
+        contents = this->fileView ? this->fileView->data() : nullptr;
+        contentsSize = this->fileView ? this->fileView->size() : 0;
     }
 
     void BinaryReader::readBytes(void* buffer, size_t numBytes)
     {
-        if (readPosition == fileContents.size() || (readPosition + numBytes) > fileContents.size())
+        if (readPosition == contentsSize || (readPosition + numBytes) > contentsSize)
         {
             // out of bytes to read
             return;
         }
 
-        const uint8_t* dataPtr = fileContents.data() + readPosition;
+        const uint8_t* dataPtr = contents + readPosition;
         std::memcpy(buffer, dataPtr, numBytes);
         readPosition += numBytes;
     }
@@ -115,13 +125,13 @@ namespace ehb
 
     bool BinaryReader::readFourCC(FourCC& fcc)
     {
-        if (readPosition == fileContents.size() || (readPosition + sizeof(FourCC)) > fileContents.size())
+        if (readPosition == contentsSize || (readPosition + sizeof(FourCC)) > contentsSize)
         {
             // out of bytes to read
             return false;
         }
 
-        const unsigned char* dataPtr = fileContents.data() + readPosition;
+        const unsigned char* dataPtr = contents + readPosition;
         std::memcpy(&fcc, dataPtr, sizeof(FourCC));
         readPosition += sizeof(FourCC);
 
@@ -150,20 +160,20 @@ namespace ehb
 
     std::string BinaryReader::readString()
     {
-        // std::getline ???
-
-        std::string tmp;
-        for (;;)
+        if (readPosition >= contentsSize)
         {
-            char c = '\0';
-            readBytes(&c, 1);
-            if (c == '\0')
-            {
-                break;
-            }
-            tmp.push_back(c);
+            return {};
         }
 
-        return tmp;
+        const char* begin = reinterpret_cast<const char*>(contents + readPosition);
+        const size_t remaining = contentsSize - readPosition;
+
+        // a missing terminator consumes the rest of the data just like the old byte by byte loop did
+        const void* end = std::memchr(begin, '\0', remaining);
+        const size_t length = end ? static_cast<const char*>(end) - begin : remaining;
+
+        readPosition += end ? length + 1 : length;
+
+        return std::string(begin, length);
     }
 } // namespace ehb
@@ -1,10 +1,13 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstring>
 #include <string>
 #include <vector>
 
+#include "MappedFile.hpp"
+
 #include <vsg/maths/quat.h>
 #include <vsg/maths/vec2.h>
 #include <vsg/maths/vec3.h>
@@ -62,6 +65,10 @@ namespace ehb
     {
     public:
         BinaryReader(ByteArray fileData);
+
+        //! read straight out of the view, the view is kept alive for the lifetime of the reader
+        BinaryReader(InputView fileView);
+
         ~BinaryReader() = default;
 
         void readBytes(void* buffer, size_t numBytes);
@@ -81,10 +88,29 @@ namespace ehb
 
         std::string readString();
 
+        size_t size() const;
+        size_t position() const;
+
     private:
         bool swap;
 
         size_t readPosition;
-        const ByteArray fileContents;
+
+        // only one of these owns the bytes that contents points at
+        const ByteArray fileData;
+        const InputView fileView;
+
+        const uint8_t* contents;
+        size_t contentsSize;
     };
+
+    inline size_t BinaryReader::size() const
+    {
+        return contentsSize;
+    }
+
+    inline size_t BinaryReader::position() const
+    {
+        return readPosition;
+    }
 } // namespace ehb
\ No newline at end of file
@@ -22,31 +22,167 @@
 #include "Fuel.hpp"
 
 #include "FuelParser.hpp"
+#include "FuelReader.hpp"
 #include "FuelScanner.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 namespace ehb
 {
-    static std::vector<std::string> split(const std::string& value, char delim)
+    // strtol and strtof skip leading whitespace and accept a '+' sign, from_chars does neither. a '+' followed by
+    // another sign is left alone so "+-5" still fails to parse like it did with strtol
+    static std::string_view trimNumber(std::string_view value)
     {
-        std::vector<std::string> result;
+        while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front())))
+        {
+            value.remove_prefix(1);
+        }
+
+        if (value.size() > 1 && value[0] == '+' && value[1] != '-' && value[1] != '+')
+        {
+            value.remove_prefix(1);
+        }
+
+        return value;
+    }
+
+    // parses like std::stoi / std::stoul without allocating or throwing: trailing characters are ignored, a 0x
+    // prefix is skipped in base 16 and negative values wrap for unsigned types
+    template <typename T>
+    static bool parseInteger(std::string_view value, int base, T& result)
+    {
+        value = trimNumber(value);
+
+        const bool negative = !value.empty() && value.front() == '-';
+
+        if (negative)
+        {
+            value.remove_prefix(1);
+        }
+
+        if (base == 16 && value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X') && std::isxdigit(static_cast<unsigned char>(value[2])))
+        {
+            value.remove_prefix(2);
+        }
+
+        uint64_t magnitude;
+
+        if (const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), magnitude, base); ec != std::errc())
+        {
+            return false;
+        }
+
+        if constexpr (std::is_signed_v<T>)
+        {
+            const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+
+            if (magnitude > limit)
+            {
+                return false;
+            }
+
+            result = negative ? static_cast<T>(0 - static_cast<int64_t>(magnitude)) : static_cast<T>(magnitude);
+        }
+        else
+        {
+            if (magnitude > std::numeric_limits<T>::max())
+            {
+                return false;
+            }
+
+            result = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+        }
+
+        return true;
+    }
+
+    static bool parseFloat(std::string_view value, float& result)
+    {
+        value = trimNumber(value);
+
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
 
-        std::istringstream stream(value);
+        return ec == std::errc();
+    }
+
+    // split a ',' separated list into views of exactly N items, false if there are more or fewer
+    template <size_t N>
+    static bool splitList(std::string_view value, std::array<std::string_view, N>& result)
+    {
+        size_t count = 0;
 
-        while (!stream.eof())
+        for (size_t start = 0; start != std::string_view::npos;)
         {
-            std::string item;
-            std::getline(stream, item, delim);
+            if (count == N)
+            {
+                return false;
+            }
+
+            const size_t end = value.find(',', start);
+
+            result[count++] = value.substr(start, end - start);
+
+            start = end == std::string_view::npos ? end : end + 1;
+        }
+
+        return count == N;
+    }
+
+    template <size_t N>
+    static bool parseFloats(std::string_view value, float* result)
+    {
+        std::array<std::string_view, N> items;
 
-            result.push_back(item);
+        if (!splitList(value, items))
+        {
+            return false;
         }
 
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (!parseFloat(items[i], result[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // fetch the kind of value the attribute caches, parsing and caching it on the first read, false if it doesn't parse
+    template <typename Parse>
+    static bool cachedValue(const Attribute& attr, AttributeCache::Kind kind, AttributeCache::Payload& value, Parse&& parse)
+    {
+        if (const auto result = attr.cache.load(kind, value); result != AttributeCache::Miss)
+        {
+            return result == AttributeCache::Hit;
+        }
+
+        const bool valid = parse(value);
+
+        attr.cache.store(kind, valid, value);
+
+        return valid;
+    }
+
+    // returns the segment of a ':' separated path that begins at start and moves start past it, npos after the last one
+    static std::string_view nextSegment(std::string_view path, size_t& start)
+    {
+        const size_t end = path.find(':', start);
+        const std::string_view result = path.substr(start, end - start);
+
+        start = end == std::string_view::npos ? end : end + 1;
+
         return result;
     }
 
-    static bool stringEqual(const std::string& str1, const std::string& str2)
+    static bool stringEqual(std::string_view str1, std::string_view str2)
     {
         return ((str1.size() == str2.size()) &&
                 std::equal(str1.begin(), str1.end(), str2.begin(), [](const char& c1, const char& c2) {
@@ -56,27 +192,166 @@ namespace ehb
                 }));
     }
 
-    FuelBlock::~FuelBlock()
+    FuelBlock* FuelBlock::createChild(const std::string& name, const std::string& type)
+    {
+        FuelBlock* node = new (mArena->allocate(sizeof(FuelBlock), alignof(FuelBlock))) FuelBlock(mArena, this);
+
+        node->mName = &name;
+        node->mType = &type;
+
+        mChildren.push_back(*mArena, node);
+
+        invalidateIndex();
+
+        return node;
+    }
+
+    const FuelBlock::Index* FuelBlock::index() const
     {
+        if (const Index* result = mIndex.load(std::memory_order_acquire))
+        {
+            return result;
+        }
+
+        if (mChildren.size() < INDEX_THRESHOLD && mAttributes.size() < INDEX_THRESHOLD)
+        {
+            return nullptr;
+        }
+
+        // lookups are const and may run on several threads at once so the tables come from the locked path
+        auto build = [this](size_t count, uint32_t& mask, auto&& nameOf) -> const uint32_t* {
+            if (count < INDEX_THRESHOLD)
+            {
+                mask = 0;
+                return nullptr;
+            }
+
+            // at most half full so probe sequences stay short
+            uint32_t size = 16;
+
+            while (size < count * 2)
+            {
+                size <<= 1;
+            }
+
+            uint32_t* slots = static_cast<uint32_t*>(mArena->allocateShared(sizeof(uint32_t) * size, alignof(uint32_t)));
+            std::fill(slots, slots + size, 0u);
+
+            mask = size - 1;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const std::string_view name = nameOf(i);
+
+                uint32_t slot = fuelHash(name) & mask;
+
+                // later duplicates are left out so lookups keep returning the first match
+                while (slots[slot] != 0 && nameOf(slots[slot] - 1) != name)
+                {
+                    slot = (slot + 1) & mask;
+                }
+
+                if (slots[slot] == 0)
+                {
+                    slots[slot] = i + 1;
+                }
+            }
+
+            return slots;
+        };
+
+        Index* result = static_cast<Index*>(mArena->allocateShared(sizeof(Index), alignof(Index)));
+
+        result->childSlots = build(mChildren.size(), result->childMask, [this](uint32_t i) -> std::string_view { return mChildren[i]->name(); });
+        result->attributeSlots = build(mAttributes.size(), result->attributeMask, [this](uint32_t i) { return mAttributes[i].name; });
+
+        // if another thread got there first use its index, ours stays behind in the arena
+        const Index* expected = nullptr;
+
+        if (!mIndex.compare_exchange_strong(expected, result, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return expected;
+        }
+
+        return result;
+    }
+
+    void FuelBlock::invalidateIndex()
+    {
+        mIndex.store(nullptr, std::memory_order_release);
+    }
+
+    FuelBlock* FuelBlock::findChild(std::string_view name, uint32_t hash) const
+    {
+        if (const Index* table = index(); table && table->childSlots)
+        {
+            for (uint32_t slot = hash & table->childMask; table->childSlots[slot] != 0; slot = (slot + 1) & table->childMask)
+            {
+                FuelBlock* node = mChildren[table->childSlots[slot] - 1];
+
+                if (node->name() == name)
+                {
+                    return node;
+                }
+            }
+
+            return nullptr;
+        }
+
         for (FuelBlock* node : mChildren)
         {
-            delete node;
+            if (node->name() == name)
+            {
+                return node;
+            }
         }
+
+        return nullptr;
     }
 
-    FuelBlock* FuelBlock::appendChild(const std::string& name)
+    const Attribute* FuelBlock::findAttribute(std::string_view name, uint32_t hash) const
+    {
+        if (const Index* table = index(); table && table->attributeSlots)
+        {
+            for (uint32_t slot = hash & table->attributeMask; table->attributeSlots[slot] != 0; slot = (slot + 1) & table->attributeMask)
+            {
+                const Attribute& attr = mAttributes[table->attributeSlots[slot] - 1];
+
+                if (attr.name == name)
+                {
+                    return &attr;
+                }
+            }
+
+            return nullptr;
+        }
+
+        for (const Attribute& attr : mAttributes)
+        {
+            if (attr.name == name)
+            {
+                return &attr;
+            }
+        }
+
+        return nullptr;
+    }
+
+    FuelBlock* FuelBlock::appendChild(std::string_view name)
     {
         const auto index = name.find_last_of(':');
 
         if (index != std::string::npos)
         {
-            const std::vector<std::string> path = split(name.substr(0, index), ':');
+            const std::string_view path = name.substr(0, index);
 
             FuelBlock* parent = this;
 
-            for (const std::string& item : path)
+            for (size_t start = 0; start != std::string_view::npos;)
             {
-                FuelBlock* node = parent->child(item);
+                const std::string_view item = nextSegment(path, start);
+
+                FuelBlock* node = parent->findChild(item, fuelHash(item));
 
                 if (!node)
                 {
@@ -91,96 +366,71 @@ namespace ehb
         else
         {
             // simply add a new child to this node with the given name
-            FuelBlock* node = new FuelBlock(this);
-
-            node->mName = name;
-
-            mChildren.push_back(node);
-
-            return node;
+            return createChild(StringPool::global().intern(name), StringPool::empty());
         }
     }
 
-    FuelBlock* FuelBlock::appendChild(const std::string& name, const std::string& type)
+    FuelBlock* FuelBlock::appendChild(std::string_view name, std::string_view type)
     {
         FuelBlock* result = appendChild(name);
 
-        result->mType = type;
+        result->mType = &StringPool::global().intern(type);
 
         return result;
     }
 
-    FuelBlock* FuelBlock::child(const std::string& name) const
+    FuelBlock* FuelBlock::child(std::string_view name) const
     {
-        // TODO: cleanup the code here
+        const FuelBlock* node = this;
 
-        std::vector<std::string> path = split(name, ':');
-
-        switch (path.size())
+        for (size_t start = 0;;)
         {
-        case 1: {
-            for (FuelBlock* node : mChildren)
+            const std::string_view item = nextSegment(name, start);
+
+            FuelBlock* result = node->findChild(item, fuelHash(item));
+
+            if (!result || start == std::string_view::npos)
             {
-                if (node->name() == name)
-                {
-                    return node;
-                }
+                return result;
             }
+
+            node = result;
         }
-        break;
+    }
 
-        default: {
-            const FuelBlock* cItr = this;
-            FuelBlock* finalAnswer = nullptr;
+    FuelBlock* FuelBlock::child(const FuelPath& path) const
+    {
+        const FuelBlock* node = this;
+        FuelBlock* result = nullptr;
 
-            for (const std::string& item : path)
+        for (const FuelPath::Segment& item : path)
+        {
+            if (result = node->findChild(item.name, item.hash); !result)
             {
-                FuelBlock* result = nullptr;
-
-                for (FuelBlock* node : cItr->mChildren)
-                {
-                    if (node->name() == item)
-                    {
-                        result = node;
-                        break;
-                    }
-                }
-
-                // did we find the node we're looking for?
-                if (result)
-                {
-                    cItr = result;
-                    finalAnswer = result;
-                }
-                else
-                {
-                    return nullptr;
-                }
+                return nullptr;
             }
 
-            return finalAnswer;
-        }
-        break;
+            node = result;
         }
 
-        return nullptr;
+        return result;
     }
 
-    const std::vector<FuelBlock*>& FuelBlock::eachChildOf(const std::string& name) const
+    const FuelList<FuelBlock*>& FuelBlock::eachChildOf(std::string_view name) const
     {
-        static std::vector<FuelBlock*> emptyVector;
+        static const FuelList<FuelBlock*> emptyList;
 
         if (FuelBlock* node = this->child(name))
         {
             return node->mChildren;
         }
 
-        return emptyVector;
+        return emptyList;
     }
 
-    const std::vector<Attribute>& FuelBlock::eachAttrOf(const std::string& name) const
+    const FuelList<Attribute>& FuelBlock::eachAttrOf(std::string_view name) const
     {
-        static std::vector<Attribute> empty;
+        static const FuelList<Attribute> empty;
 
         if (FuelBlock* node = this->child(name))
         {
@@ -190,19 +440,21 @@ namespace ehb
         return empty;
     }
 
-    void FuelBlock::appendValue(const std::string& name, const std::string& type, const std::string& value)
+    void FuelBlock::appendValue(std::string_view name, std::string_view type, std::string_view value)
     {
         const auto index = name.find_last_of(':');
 
         if (index != std::string::npos)
         {
-            const std::vector<std::string> path = split(name.substr(0, index), ':');
+            const std::string_view path = name.substr(0, index);
 
             FuelBlock* parent = this;
 
-            for (const std::string& item : path)
+            for (size_t start = 0; start != std::string_view::npos;)
             {
-                FuelBlock* node = parent->child(item);
+                const std::string_view item = nextSegment(path, start);
+
+                FuelBlock* node = parent->findChild(item, fuelHash(item));
 
                 if (!node)
                 {
@@ -216,19 +468,17 @@ namespace ehb
         }
         else
         {
-            Attribute attr;
+            StringPool& pool = StringPool::global();
 
-            attr.name = name;
-            attr.type = type;
-            attr.value = value;
+            mAttributes.push_back(*mArena, Attribute{pool.intern(name), pool.intern(type), mArena->copy(value), {}});
 
-            mAttributes.push_back(attr);
+            invalidateIndex();
         }
     }
 
-    bool FuelBlock::valueAsBool(const std::string& name, bool defaultValue) const
+    bool FuelBlock::asBool(const Attribute* attr, bool defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        if (attr)
         {
             return stringEqual(attr->value, "true");
         }
@@ -236,326 +486,603 @@ namespace ehb
         return defaultValue;
     }
 
-    int FuelBlock::valueAsInt(const std::string& name, int defaultValue) const
+    int FuelBlock::asInt(const Attribute* attr, int defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
-        {
-            const int base = attr->type == "x" ? 16 : 10;
+        AttributeCache::Payload value;
 
-            try
-            {
-                return std::stoi(attr->value, nullptr, base);
-            }
-            catch (...)
-            {
-            }
+        if (attr && cachedValue(*attr, AttributeCache::Int, value, [attr](auto& v) { return parseInteger(attr->value, attr->type == "x" ? 16 : 10, v.i); }))
+        {
+            return value.i;
         }
 
         return defaultValue;
     }
 
-    unsigned int FuelBlock::valueAsUInt(const std::string& name, unsigned int defaultValue) const
+    unsigned int FuelBlock::asUInt(const Attribute* attr, unsigned int defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        AttributeCache::Payload value;
+
+        if (attr && cachedValue(*attr, AttributeCache::UInt, value, [attr](auto& v) { return parseInteger(attr->value, attr->type == "x" ? 16 : 10, v.u); }))
         {
-            const int base = attr->type == "x" ? 16 : 10;
+            return value.u;
+        }
 
-            try
-            {
-                return std::stoul(attr->value, nullptr, base);
-            }
-            catch (...)
-            {
-            }
+        return defaultValue;
+    }
+
+    float FuelBlock::asFloat(const Attribute* attr, float defaultValue)
+    {
+        AttributeCache::Payload value;
+
+        if (attr && cachedValue(*attr, AttributeCache::Float, value, [attr](auto& v) { return parseFloat(attr->value, v.f[0]); }))
+        {
+            return value.f[0];
         }
 
         return defaultValue;
     }
 
-    float FuelBlock::valueAsFloat(const std::string& name, float defaultValue) const
+    std::string FuelBlock::asString(const Attribute* attr, const std::string& defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        if (attr)
         {
-            try
-            {
-                return std::stof(attr->value, nullptr);
-            }
-            catch (...)
+            if (attr->value.size() >= 2 && attr->value.front() == '"' && attr->value.back() == '"')
             {
+                return std::string(attr->value.substr(1, attr->value.size() - 2));
             }
         }
 
         return defaultValue;
     }
 
-    std::string FuelBlock::valueAsString(const std::string& name, const std::string& defaultValue) const
+    std::array<float, 3> FuelBlock::asFloat3(const Attribute* attr, const std::array<float, 3>& defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        AttributeCache::Payload value;
+
+        if (attr && cachedValue(*attr, AttributeCache::Float3, value, [attr](auto& v) { return parseFloats<3>(attr->value, v.f); }))
         {
-            if (attr->value.front() == '"' && attr->value.back() == '"')
-            {
-                return attr->value.substr(1, attr->value.size() - 2);
-            }
+            return std::array<float, 3>{value.f[0], value.f[1], value.f[2]};
         }
 
         return defaultValue;
     }
 
-    std::array<float, 3> FuelBlock::valueAsFloat3(const std::string& name, std::array<float, 3> defaultValue) const
+    vsg::vec3 FuelBlock::asVec3(const Attribute* attr, const vsg::vec3& defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        if (attr)
         {
-            const std::string& value = valueOf(name);
+            auto value = asFloat3(attr, {1.0, 1.0, 1.0});
 
-            if (value.empty())
-            {
-                return defaultValue;
-            }
+            return vsg::vec3(value[0], value[1], value[2]);
+        }
 
-            const std::vector<std::string> values = split(value, ',');
+        return defaultValue;
+    }
 
-            if (values.size() != 3)
-            {
-                return defaultValue;
-            }
+    std::array<float, 4> FuelBlock::asFloat4(const Attribute* attr, const std::array<float, 4>& defaultValue)
+    {
+        AttributeCache::Payload value;
 
-            return std::array<float, 3>{std::stof(values[0]), std::stof(values[1]), std::stof(values[2])};
+        if (attr && cachedValue(*attr, AttributeCache::Float4, value, [attr](auto& v) { return parseFloats<4>(attr->value, v.f); }))
+        {
+            return std::array<float, 4>{value.f[0], value.f[1], value.f[2], value.f[3]};
         }
 
         return defaultValue;
     }
 
-    vsg::vec3 FuelBlock::valueAsVec3(const std::string& name, const vsg::vec3& defaultValue) const
+    vsg::vec4 FuelBlock::asColor(const Attribute* attr, const vsg::vec4& defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        AttributeCache::Payload value;
+
+        if (attr && attr->value != "-1" && cachedValue(*attr, AttributeCache::Color, value, [attr](auto& v) { return parseInteger(attr->value, 16, v.u); }))
         {
-            auto value = valueAsFloat3(name);
+            uint8_t r = static_cast<float>((value.u >> 16) & 255);
+            uint8_t g = static_cast<float>((value.u >> 8) & 255);
+            uint8_t b = static_cast<float>(value.u & 255);
 
-            return vsg::vec3(value[0], value[1], value[2]);
+            return vsg::vec4(r, g, b, 255.f) / 255.f;
         }
 
         return defaultValue;
     }
 
-    std::array<float, 4> FuelBlock::valueAsFloat4(const std::string& name, std::array<float, 4> defaultValue) const
+    SiegeRot FuelBlock::asSiegeRot(const Attribute* attr, const SiegeRot& defaultValue)
     {
-        if (const Attribute* attr = attribute(name))
+        // same text as a float4 so the two share a slot
+        AttributeCache::Payload value;
+
+        if (attr && cachedValue(*attr, AttributeCache::Float4, value, [attr](auto& v) { return parseFloats<4>(attr->value, v.f); }))
         {
-            const std::string& value = valueOf(name);
+            return SiegeRot{{value.f[0], value.f[1], value.f[2], value.f[3]}};
+        }
 
-            if (value.empty())
-            {
-                return defaultValue;
-            }
+        return defaultValue;
+    }
 
-            const std::vector<std::string> values = split(value, ',');
+    SiegePos FuelBlock::asSiegePos(const Attribute* attr, const SiegePos& defaultValue)
+    {
+        AttributeCache::Payload value;
 
-            if (values.size() != 4)
-            {
-                return defaultValue;
-            }
+        auto parse = [attr](auto& v) {
+            std::array<std::string_view, 4> items;
+
+            return splitList(attr->value, items) && parseFloat(items[0], v.siegePos.pos[0]) && parseFloat(items[1], v.siegePos.pos[1]) &&
+                   parseFloat(items[2], v.siegePos.pos[2]) && parseInteger(items[3], 16, v.siegePos.guid);
+        };
 
-            return std::array<float, 4>{std::stof(values[0]), std::stof(values[1]), std::stof(values[2]), std::stof(values[3])};
+        if (attr && cachedValue(*attr, AttributeCache::SiegePos, value, parse))
+        {
+            return SiegePos{{value.siegePos.pos[0], value.siegePos.pos[1], value.siegePos.pos[2]}, value.siegePos.guid};
         }
 
         return defaultValue;
     }
 
-    vsg::vec4 FuelBlock::valueAsColor(const std::string& name, const vsg::vec4& defaultValue) const
+    bool FuelBlock::valueAsBool(std::string_view name, bool defaultValue) const
     {
-        if (const Attribute* attr = attribute(name))
-        {
-            if (attr->value != "-1")
-            {
-                const int base = attr->type == "i" ? 10 : 16;
+        return asBool(attribute(name), defaultValue);
+    }
 
-                try
-                {
-                    const unsigned int value = std::stoul(attr->value, nullptr, 16);
+    bool FuelBlock::valueAsBool(const FuelPath& path, bool defaultValue) const
+    {
+        return asBool(attribute(path), defaultValue);
+    }
 
-                    uint8_t r = static_cast<float>((value >> 16) & 255);
-                    uint8_t g = static_cast<float>((value >> 8) & 255);
-                    uint8_t b = static_cast<float>(value & 255);
+    int FuelBlock::valueAsInt(std::string_view name, int defaultValue) const
+    {
+        return asInt(attribute(name), defaultValue);
+    }
 
-                    return vsg::vec4(r, g, b, 255.f) / 255.f;
-                }
-                catch (...)
-                {
-                }
-            }
-        }
+    int FuelBlock::valueAsInt(const FuelPath& path, int defaultValue) const
+    {
+        return asInt(attribute(path), defaultValue);
+    }
 
-        return defaultValue;
+    unsigned int FuelBlock::valueAsUInt(std::string_view name, unsigned int defaultValue) const
+    {
+        return asUInt(attribute(name), defaultValue);
     }
 
-    SiegeRot FuelBlock::valueAsSiegeRot(const std::string& name, const SiegeRot& defaultValue) const
+    unsigned int FuelBlock::valueAsUInt(const FuelPath& path, unsigned int defaultValue) const
     {
-        if (const Attribute* attr = attribute(name))
-        {
-            const std::string& value = valueOf(name);
+        return asUInt(attribute(path), defaultValue);
+    }
 
-            if (value.empty())
-            {
-                return defaultValue;
-            }
+    float FuelBlock::valueAsFloat(std::string_view name, float defaultValue) const
+    {
+        return asFloat(attribute(name), defaultValue);
+    }
 
-            const std::vector<std::string> values = split(value, ',');
+    float FuelBlock::valueAsFloat(const FuelPath& path, float defaultValue) const
+    {
+        return asFloat(attribute(path), defaultValue);
+    }
 
-            if (values.size() != 4)
-            {
-                return defaultValue;
-            }
+    std::string FuelBlock::valueAsString(std::string_view name, const std::string& defaultValue) const
+    {
+        return asString(attribute(name), defaultValue);
+    }
 
-            return SiegeRot{{std::stof(values[0]), std::stof(values[1]), std::stof(values[2]), std::stof(values[3])}};
-        }
+    std::string FuelBlock::valueAsString(const FuelPath& path, const std::string& defaultValue) const
+    {
+        return asString(attribute(path), defaultValue);
+    }
 
-        return defaultValue;
+    std::array<float, 3> FuelBlock::valueAsFloat3(std::string_view name, std::array<float, 3> defaultValue) const
+    {
+        return asFloat3(attribute(name), defaultValue);
     }
 
-    SiegePos FuelBlock::valueAsSiegePos(const std::string& name, const SiegePos& defaultValue) const
+    std::array<float, 3> FuelBlock::valueAsFloat3(const FuelPath& path, std::array<float, 3> defaultValue) const
     {
-        if (const Attribute* attr = attribute(name))
-        {
-            const std::string& value = valueOf(name);
+        return asFloat3(attribute(path), defaultValue);
+    }
 
-            if (value.empty())
-            {
-                return defaultValue;
-            }
+    vsg::vec3 FuelBlock::valueAsVec3(std::string_view name, const vsg::vec3& defaultValue) const
+    {
+        return asVec3(attribute(name), defaultValue);
+    }
 
-            const std::vector<std::string> values = split(value, ',');
+    vsg::vec3 FuelBlock::valueAsVec3(const FuelPath& path, const vsg::vec3& defaultValue) const
+    {
+        return asVec3(attribute(path), defaultValue);
+    }
 
-            if (values.size() != 4)
-            {
-                return defaultValue;
-            }
+    std::array<float, 4> FuelBlock::valueAsFloat4(std::string_view name, std::array<float, 4> defaultValue) const
+    {
+        return asFloat4(attribute(name), defaultValue);
+    }
 
-            return SiegePos{{std::stof(values[0]), std::stof(values[1]), std::stof(values[2])}, std::stoul(values[3], nullptr, 16)};
-        }
+    std::array<float, 4> FuelBlock::valueAsFloat4(const FuelPath& path, std::array<float, 4> defaultValue) const
+    {
+        return asFloat4(attribute(path), defaultValue);
+    }
 
-        return defaultValue;
+    vsg::vec4 FuelBlock::valueAsColor(std::string_view name, const vsg::vec4& defaultValue) const
+    {
+        return asColor(attribute(name), defaultValue);
+    }
+
+    vsg::vec4 FuelBlock::valueAsColor(const FuelPath& path, const vsg::vec4& defaultValue) const
+    {
+        return asColor(attribute(path), defaultValue);
+    }
+
+    SiegeRot FuelBlock::valueAsSiegeRot(std::string_view name, const SiegeRot& defaultValue) const
+    {
+        return asSiegeRot(attribute(name), defaultValue);
+    }
+
+    SiegeRot FuelBlock::valueAsSiegeRot(const FuelPath& path, const SiegeRot& defaultValue) const
+    {
+        return asSiegeRot(attribute(path), defaultValue);
+    }
+
+    SiegePos FuelBlock::valueAsSiegePos(std::string_view name, const SiegePos& defaultValue) const
+    {
+        return asSiegePos(attribute(name), defaultValue);
     }
 
-    FuelBlock* FuelBlock::clone(FuelBlock* parent) const
+    SiegePos FuelBlock::valueAsSiegePos(const FuelPath& path, const SiegePos& defaultValue) const
     {
-        FuelBlock* result = new FuelBlock(parent);
+        return asSiegePos(attribute(path), defaultValue);
+    }
+
+    FuelBlock* FuelBlock::clone(FuelArena& arena, FuelBlock* parent) const
+    {
+        FuelBlock* result = new (arena.allocate(sizeof(FuelBlock), alignof(FuelBlock))) FuelBlock(&arena, parent);
 
         result->mName = mName;
         result->mType = mType;
 
+        result->mChildren.reserve(arena, mChildren.size());
+
         for (const FuelBlock* child : mChildren)
         {
-            result->mChildren.push_back(child->clone(result));
+            result->mChildren.push_back(arena, child->clone(arena, result));
         }
 
+        result->mAttributes.reserve(arena, mAttributes.size());
+
         for (const Attribute& attr : mAttributes)
         {
-            result->mAttributes.push_back(attr);
+            // names and types are interned, only the value belongs to the source document
+            result->mAttributes.push_back(arena, Attribute{attr.name, attr.type, arena.copy(attr.value), {}});
         }
 
         return result;
     }
 
+    /*
+     * finds the first element of a name in a list that is only ever appended to, which is what an override is
+     * matched against. most lists are short enough to search in place, a hash index is only built the first
+     * time a list long enough for merging into it to go quadratic is searched
+     */
+    template <typename T, typename NameOf>
+    class FirstOfName
+    {
+    public:
+        static constexpr uint32_t npos = ~uint32_t(0);
+
+        explicit FirstOfName(const FuelList<T>& list) :
+            list(list)
+        {
+        }
+
+        uint32_t find(std::string_view name)
+        {
+            if (index.empty() && list.size() >= indexFrom)
+            {
+                build();
+            }
+
+            if (index.empty())
+            {
+                for (uint32_t i = 0; i < list.size(); ++i)
+                {
+                    if (NameOf()(list[i]) == name)
+                    {
+                        return i;
+                    }
+                }
+
+                return npos;
+            }
+
+            const auto itr = index.find(name);
+
+            return itr != index.end() ? itr->second : npos;
+        }
+
+        //! call after every push_back onto the list
+        void appended()
+        {
+            // an earlier element of the same name stays the one that is found
+            if (!index.empty())
+            {
+                index.emplace(NameOf()(list.back()), static_cast<uint32_t>(list.size() - 1));
+            }
+        }
+
+    private:
+        static constexpr uint32_t indexFrom = 64;
+
+        void build()
+        {
+            index.reserve(list.size() * 2);
+
+            for (uint32_t i = 0; i < list.size(); ++i)
+            {
+                index.emplace(NameOf()(list[i]), i);
+            }
+        }
+
+        const FuelList<T>& list;
+        std::unordered_map<std::string_view, uint32_t> index;
+    };
+
+    struct ChildName
+    {
+        std::string_view operator()(const FuelBlock* block) const { return block->name(); }
+    };
+
+    struct AttributeName
+    {
+        std::string_view operator()(const Attribute& attr) const { return attr.name; }
+    };
+
+    using FirstChild = FirstOfName<FuelBlock*, ChildName>;
+    using FirstAttribute = FirstOfName<Attribute, AttributeName>;
+
     void FuelBlock::merge(FuelBlock* result) const
     {
         if (result)
         {
+            FuelArena& arena = *result->mArena;
+
             result->mName = mName;
             result->mType = mType;
 
             if (!isEmpty())
             {
+                // an override that was appended can be overridden in turn by one further down with the same name
+                FirstChild children(result->mChildren);
+
                 for (const FuelBlock* i : mChildren)
                 {
-                    bool found = false;
-
-                    for (FuelBlock* j : result->mChildren)
+                    if (const uint32_t index = children.find(i->name()); index != FirstChild::npos)
                     {
-                        if (i->name() == j->name())
-                        {
-                            found = true;
-                            i->merge(j);
-                            break;
-                        }
+                        i->merge(result->mChildren[index]);
                     }
-
-                    if (!found)
+                    else
                     {
-                        FuelBlock* copy = i->clone(result);
-                        result->mChildren.push_back(copy);
+                        result->mChildren.push_back(arena, i->clone(arena, result));
+                        children.appended();
                     }
                 }
 
+                FirstAttribute attributes(result->mAttributes);
+
                 for (const Attribute& i : mAttributes)
                 {
-                    bool found = false;
-
-                    for (Attribute& j : result->mAttributes)
+                    if (const uint32_t index = attributes.find(i.name); index != FirstAttribute::npos)
                     {
-                        if (i.name == j.name)
-                        {
-                            found = true;
-                            j = i;
-                            break;
-                        }
+                        result->mAttributes[index] = Attribute{i.name, i.type, arena.copy(i.value), {}};
                     }
-
-                    if (!found)
+                    else
                     {
-                        result->mAttributes.push_back(i);
+                        result->mAttributes.push_back(arena, Attribute{i.name, i.type, arena.copy(i.value), {}});
+                        attributes.appended();
                     }
                 }
+
+                result->invalidateIndex();
             }
         }
     }
 
-    const Attribute* FuelBlock::attribute(const std::string& name) const
+    FuelBlock* FuelBlock::overlay(const FuelBlock* base, FuelArena& arena, FuelBlock* parent) const
     {
-        const auto index = name.find_last_of(':');
+        FuelBlock* result = new (arena.allocate(sizeof(FuelBlock), alignof(FuelBlock))) FuelBlock(&arena, parent);
 
-        const FuelBlock* parent;
-        std::string actualName;
+        result->mName = mName;
+        result->mType = mType;
+
+        result->mChildren.share(base->mChildren);
+        result->mAttributes.share(base->mAttributes);
+
+        // same matching as merge, an override replaces the first block or attribute of its name in the result so far
+        FirstChild children(result->mChildren);
+
+        for (const FuelBlock* i : mChildren)
+        {
+            if (const uint32_t index = children.find(i->name()); index != FirstChild::npos)
+            {
+                // a child that would come out of the merge unchanged doesn't even need a block of its own
+                if (i->isEmpty() && i->mType == result->mChildren[index]->mType)
+                {
+                    continue;
+                }
+
+                result->mChildren.detach(arena);
+                result->mChildren[index] = i->overlay(result->mChildren[index], arena, result);
+            }
+            else
+            {
+                result->mChildren.push_back(arena, i->clone(arena, result));
+                children.appended();
+            }
+        }
+
+        FirstAttribute attributes(result->mAttributes);
+
+        for (const Attribute& i : mAttributes)
+        {
+            const Attribute value{i.name, i.type, arena.copy(i.value), {}};
+
+            if (const uint32_t index = attributes.find(i.name); index != FirstAttribute::npos)
+            {
+                result->mAttributes.detach(arena);
+                result->mAttributes[index] = value;
+            }
+            else
+            {
+                result->mAttributes.push_back(arena, value);
+                attributes.appended();
+            }
+        }
+
+        return result;
+    }
+
+    const Attribute* FuelBlock::attribute(std::string_view name) const
+    {
+        const auto index = name.find_last_of(':');
 
         if (index != std::string::npos)
         {
-            parent = child(name.substr(0, index));
-            actualName = name.substr(index + 1);
+            const FuelBlock* parent = child(name.substr(0, index));
+            const std::string_view actualName = name.substr(index + 1);
+
+            return parent ? parent->findAttribute(actualName, fuelHash(actualName)) : nullptr;
         }
-        else
+
+        return findAttribute(name, fuelHash(name));
+    }
+
+    const Attribute* FuelBlock::attribute(const FuelPath& path) const
+    {
+        if (path.empty())
         {
-            parent = this;
-            actualName = name;
+            return nullptr;
         }
 
-        if (parent)
+        const FuelBlock* parent = this;
+
+        for (size_t i = 0; i + 1 < path.size(); ++i)
         {
-            for (const Attribute& attr : parent->mAttributes)
+            if (parent = parent->findChild(path[i].name, path[i].hash); !parent)
             {
-                if (attr.name == actualName)
-                {
-                    return &attr;
-                }
+                return nullptr;
             }
         }
 
-        return nullptr;
+        return parent->findAttribute(path.back().name, path.back().hash);
+    }
+
+    static bool parseFuel(FuelScanner& scanner, FuelHandler& handler, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        while (true)
+        {
+            FuelParser parser(scanner, handler, recovery);
+
+            const bool accepted = parser.parse() == 0;
+
+            if (diagnostics)
+            {
+                diagnostics->insert(diagnostics->end(), parser.diagnostics().begin(), parser.diagnostics().end());
+            }
+
+            if (accepted || recovery == FuelRecovery::FailFast)
+            {
+                return accepted;
+            }
+
+            // every fresh parser starts at the top level so the handler has to be brought back there first
+            if (!parser.closeOpenBlocks() || !scanner.resync())
+            {
+                return true;
+            }
+        }
     }
 
-    bool Fuel::load(std::istream& stream)
+    bool readFuel(const MappedFile& file, FuelHandler& handler, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        FuelScanner scanner(reinterpret_cast<const char*>(file.data()), file.size());
+
+        return parseFuel(scanner, handler, recovery, diagnostics);
+    }
+
+    bool readFuel(std::istream& stream, FuelHandler& handler, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
     {
         const std::string data(std::istreambuf_iterator<char>(stream), {});
 
-        FuelScanner scanner(data.c_str());
-        FuelParser parser(scanner, this);
+        FuelScanner scanner(data.data(), data.size());
+
+        return parseFuel(scanner, handler, recovery, diagnostics);
+    }
+
+    bool parseFuelValue(std::string_view type, std::string_view value, int& result)
+    {
+        return parseInteger(value, type == "x" ? 16 : 10, result);
+    }
+
+    bool parseFuelValue(std::string_view type, std::string_view value, unsigned int& result)
+    {
+        return parseInteger(value, type == "x" ? 16 : 10, result);
+    }
+
+    bool parseFuelValue(std::string_view /*type*/, std::string_view value, float& result)
+    {
+        return parseFloat(value, result);
+    }
+
+    // the handler Fuel::load parses into, it is the only one that keeps everything
+    class FuelBuilder : public FuelHandler
+    {
+    public:
+        explicit FuelBuilder(FuelBlock* root) :
+            node(root)
+        {
+        }
+
+        FuelVisit enterBlock(std::string_view name, std::string_view type) override
+        {
+            node = type.empty() ? node->appendChild(name) : node->appendChild(name, type);
+            return FuelVisit::Continue;
+        }
+
+        FuelVisit attribute(std::string_view name, std::string_view type, std::string_view value) override
+        {
+            node->appendValue(name, type, value);
+            return FuelVisit::Continue;
+        }
+
+        FuelVisit leaveBlock() override
+        {
+            node = node->parent();
+            return FuelVisit::Continue;
+        }
+
+    private:
+        FuelBlock* node;
+    };
+
+    bool readFuel(const MappedFile& file, FuelBlock& root, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        FuelBuilder builder(&root);
+
+        return readFuel(file, builder, recovery, diagnostics);
+    }
+
+    bool Fuel::load(const MappedFile& file, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        return readFuel(file, *this, recovery, diagnostics);
+    }
+
+    bool Fuel::load(std::istream& stream, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        FuelBuilder builder(this);
 
-        return parser.parse() == 0;
+        return readFuel(stream, builder, recovery, diagnostics);
     }
 
-    bool Fuel::load(const std::string& filename)
+    bool Fuel::load(const std::string& filename, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
     {
         std::ifstream stream(filename);
 
-        return load(stream);
+        return load(stream, recovery, diagnostics);
     }
 
     struct walkNode
@@ -22,7 +22,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <vsg/maths/quat.h>
 #include <vsg/maths/vec3.h>
@@ -30,6 +32,11 @@
 //#include "SiegeRot.hpp"
 //#include "SiegePos.hpp"
 
+#include "FuelArena.hpp"
+#include "FuelPath.hpp"
+#include "FuelReader.hpp"
+#include "StringPool.hpp"
+
 namespace ehb
 {
     struct SiegePos
@@ -43,20 +50,118 @@ namespace ehb
         vsg::quat rot;
     };
 
+    /**
+     * the value of an attribute parsed into a number or vector, filled in by the first typed read
+     *
+     * only one interpretation is kept per attribute, reading the same attribute as a different type parses the
+     * text as before. a value that failed to parse is remembered as well so the default comes back without
+     * another parse. the state byte is published last so readers on other threads either see a complete
+     * payload or fall back to parsing, and copying an attribute always starts the copy with an empty slot
+     */
+    class AttributeCache
+    {
+    public:
+        enum Kind : uint8_t
+        {
+            Empty,
+            Busy,
+            Int,
+            UInt,
+            Float,
+            Float3,
+            Float4,
+            SiegePos,
+            Color
+        };
+
+        enum Result
+        {
+            Miss,
+            Hit,
+            Invalid
+        };
+
+        union Payload
+        {
+            int i;
+            unsigned int u;
+            float f[4];
+            struct
+            {
+                float pos[3];
+                uint32_t guid;
+            } siegePos;
+        };
+
+        AttributeCache() = default;
+        AttributeCache(const AttributeCache&) {}
+
+        AttributeCache& operator=(const AttributeCache&)
+        {
+            mState.store(Empty, std::memory_order_relaxed);
+            return *this;
+        }
+
+        Result load(Kind kind, Payload& value) const;
+        void store(Kind kind, bool valid, const Payload& value) const;
+
+    private:
+        static constexpr uint8_t INVALID = 0x80;
+
+        mutable Payload mPayload;
+        mutable std::atomic<uint8_t> mState{Empty};
+    };
+
     // private
+    // name and type point into the StringPool, value points into the arena of the document that owns the attribute
     struct Attribute
     {
-        std::string name;
-        std::string type;
-        std::string value;
+        std::string_view name;
+        std::string_view type;
+        std::string_view value;
+
+        AttributeCache cache;
     };
 
-    // main element to make use of in this api
+    inline AttributeCache::Result AttributeCache::load(Kind kind, Payload& value) const
+    {
+        const uint8_t state = mState.load(std::memory_order_acquire);
+
+        if ((state & ~INVALID) != kind)
+        {
+            return Miss;
+        }
+
+        if (state & INVALID)
+        {
+            return Invalid;
+        }
+
+        value = mPayload;
+
+        return Hit;
+    }
+
+    inline void AttributeCache::store(Kind kind, bool valid, const Payload& value) const
+    {
+        // first writer wins, everyone else keeps parsing until the slot is published
+        if (uint8_t expected = Empty; mState.compare_exchange_strong(expected, Busy, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            mPayload = value;
+            mState.store(static_cast<uint8_t>(kind | (valid ? 0 : INVALID)), std::memory_order_release);
+        }
+    }
+
+    /*
+     * main element to make use of in this api
+     *
+     * blocks never own their memory, every block, attribute and value of a document is carved out of the FuelArena
+     * of the Fuel at its root and released in one go with it. block names, block types and attribute names are
+     * interned in the global StringPool
+     */
     class FuelBlock
     {
     public:
-        ~FuelBlock();
-
         FuelBlock* parent() const;
 
         const std::string& name() const;
@@ -70,22 +175,30 @@ namespace ehb
              * @param type the type of the new node to create
              * @return the newly created child node
              */
-        FuelBlock* appendChild(const std::string& name);
-        FuelBlock* appendChild(const std::string& name, const std::string& type);
+        FuelBlock* appendChild(std::string_view name);
+        FuelBlock* appendChild(std::string_view name, std::string_view type);
 
-        FuelBlock* child(const std::string& name) const;
+        FuelBlock* child(std::string_view name) const;
+        FuelBlock* child(const FuelPath& path) const;
 
-        const std::vector<FuelBlock*>& eachChild() const;
-        const std::vector<FuelBlock*>& eachChildOf(const std::string& name) const;
+        /**
+             * single segment lookups for callers that already hashed the name, hash must be fuelHash(name)
+             * @return the first direct child or attribute with the given name
+             */
+        FuelBlock* findChild(std::string_view name, uint32_t hash) const;
+        const Attribute* findAttribute(std::string_view name, uint32_t hash) const;
+
+        const FuelList<FuelBlock*>& eachChild() const;
+        const FuelList<FuelBlock*>& eachChildOf(std::string_view name) const;
 
-        bool hasAttr(const std::string& name) const;
+        bool hasAttr(std::string_view name) const;
 
         // TODO: rename eachAttribute to eachAttr
-        const std::vector<Attribute>& eachAttribute() const;
-        const std::vector<Attribute>& eachAttrOf(const std::string& name) const;
+        const FuelList<Attribute>& eachAttribute() const;
+        const FuelList<Attribute>& eachAttrOf(std::string_view name) const;
 
-        void appendValue(const std::string& name, const std::string& value);
-        void appendValue(const std::string& name, const std::string& type, const std::string& value);
+        void appendValue(std::string_view name, std::string_view value);
+        void appendValue(std::string_view name, std::string_view type, std::string_view value);
 
         //! @return the number of attributes in this node
         unsigned int valueCount() const;
@@ -93,41 +206,58 @@ namespace ehb
         /**
              * @param name which attribute type or value to return
              * @param defaultValue the value to return if the attribute does not exist
-             * @return the attribute type or value
+             * @return the attribute type or value, valid for as long as the document is
              */
-        const std::string& valueOf(const std::string& name, const std::string& defaultValue = "") const;
-        const std::string& typeOf(const std::string& name, const std::string& defaultValue = "") const;
+        std::string_view valueOf(std::string_view name, std::string_view defaultValue = {}) const;
+        std::string_view typeOf(std::string_view name, std::string_view defaultValue = {}) const;
+
+        //! as above with a pre-split path, the last segment names the attribute
+        std::string_view valueOf(const FuelPath& path, std::string_view defaultValue = {}) const;
+        std::string_view typeOf(const FuelPath& path, std::string_view defaultValue = {}) const;
 
         /**
              * @param index which attribute name, type, or value to return ranging from 0 to valueCount()
              * @param defaultValue the value to return if the attribute does not exist
              * @return the attribute name, type, or value
              */
-        const std::string& nameOf(unsigned int index, const std::string& defaultValue = "") const;
-        const std::string& typeOf(unsigned int index, const std::string& defaultValue = "") const;
-        const std::string& valueOf(unsigned int index, const std::string& defaultValue = "") const;
+        std::string_view nameOf(unsigned int index, std::string_view defaultValue = {}) const;
+        std::string_view typeOf(unsigned int index, std::string_view defaultValue = {}) const;
+        std::string_view valueOf(unsigned int index, std::string_view defaultValue = {}) const;
 
         /**
              * @param name which attribute value to return
              * @param defaultValue the value to return if the attribute does not exist or cannot be coerced to the desired type
              * @return the attribute value interpreted as the desired type
              */
-        bool valueAsBool(const std::string& name, bool defaultValue = false) const;
-        int valueAsInt(const std::string& name, int defaultValue = 0) const;
-        unsigned int valueAsUInt(const std::string& name, unsigned int defaultValue = 0) const;
-        float valueAsFloat(const std::string& name, float defaultValue = 0.f) const;
-        std::string valueAsString(const std::string& name, const std::string& defaultValue = "") const;
+        bool valueAsBool(std::string_view name, bool defaultValue = false) const;
+        int valueAsInt(std::string_view name, int defaultValue = 0) const;
+        unsigned int valueAsUInt(std::string_view name, unsigned int defaultValue = 0) const;
+        float valueAsFloat(std::string_view name, float defaultValue = 0.f) const;
+        std::string valueAsString(std::string_view name, const std::string& defaultValue = "") const;
 
         // extra types...
-        std::array<float, 3> valueAsFloat3(const std::string& name, const std::array<float, 3> defaultValue = {1.0, 1.0, 1.0}) const;
-        std::array<float, 4> valueAsFloat4(const std::string& name, const std::array<float, 4> defaultValue = {1.0, 1.0, 1.0, 1.0}) const;
-        vsg::vec3 valueAsVec3(const std::string& name, const vsg::vec3& defaultValue = {1.0, 1.0, 1.0}) const; // don't use 1.f as vsg::vec3 could be doubles
-        vsg::vec4 valueAsColor(const std::string& name, const vsg::vec4& defaultValue = {1.f, 1.f, 1.f, 1.f}) const;
-        SiegeRot valueAsSiegeRot(const std::string& name, const SiegeRot& defaultValue = { {0.0, 0.0, 0.0, 0.0} }) const;
-        SiegePos valueAsSiegePos(const std::string& name, const SiegePos& defaultValue = {{0.0, 0.0, 0.0}, 0}) const;
-
-        //! create a deep copy of the node that must be deleted by the user
-        FuelBlock* clone(FuelBlock* parent = nullptr) const;
+        std::array<float, 3> valueAsFloat3(std::string_view name, const std::array<float, 3> defaultValue = {1.0, 1.0, 1.0}) const;
+        std::array<float, 4> valueAsFloat4(std::string_view name, const std::array<float, 4> defaultValue = {1.0, 1.0, 1.0, 1.0}) const;
+        vsg::vec3 valueAsVec3(std::string_view name, const vsg::vec3& defaultValue = {1.0, 1.0, 1.0}) const; // don't use 1.f as vsg::vec3 could be doubles
+        vsg::vec4 valueAsColor(std::string_view name, const vsg::vec4& defaultValue = {1.f, 1.f, 1.f, 1.f}) const;
+        SiegeRot valueAsSiegeRot(std::string_view name, const SiegeRot& defaultValue = { {0.0, 0.0, 0.0, 0.0} }) const;
+        SiegePos valueAsSiegePos(std::string_view name, const SiegePos& defaultValue = {{0.0, 0.0, 0.0}, 0}) const;
+
+        bool valueAsBool(const FuelPath& path, bool defaultValue = false) const;
+        int valueAsInt(const FuelPath& path, int defaultValue = 0) const;
+        unsigned int valueAsUInt(const FuelPath& path, unsigned int defaultValue = 0) const;
+        float valueAsFloat(const FuelPath& path, float defaultValue = 0.f) const;
+        std::string valueAsString(const FuelPath& path, const std::string& defaultValue = "") const;
+
+        std::array<float, 3> valueAsFloat3(const FuelPath& path, const std::array<float, 3> defaultValue = {1.0, 1.0, 1.0}) const;
+        std::array<float, 4> valueAsFloat4(const FuelPath& path, const std::array<float, 4> defaultValue = {1.0, 1.0, 1.0, 1.0}) const;
+        vsg::vec3 valueAsVec3(const FuelPath& path, const vsg::vec3& defaultValue = {1.0, 1.0, 1.0}) const;
+        vsg::vec4 valueAsColor(const FuelPath& path, const vsg::vec4& defaultValue = {1.f, 1.f, 1.f, 1.f}) const;
+        SiegeRot valueAsSiegeRot(const FuelPath& path, const SiegeRot& defaultValue = { {0.0, 0.0, 0.0, 0.0} }) const;
+        SiegePos valueAsSiegePos(const FuelPath& path, const SiegePos& defaultValue = {{0.0, 0.0, 0.0}, 0}) const;
+
+        //! create a deep copy of the node inside arena, the copy lives exactly as long as the arena does
+        FuelBlock* clone(FuelArena& arena, FuelBlock* parent = nullptr) const;
 
         /**
              * merge the contents of this node into the result node
@@ -137,24 +267,75 @@ namespace ehb
              */
         void merge(FuelBlock* result) const;
 
+        /**
+             * the same tree base->clone(arena) followed by merge would give, except that whatever of base this
+             * node does not override is shared with base instead of copied. only blocks on the way to an override
+             * and the overriding values themselves end up in arena
+             *
+             * base has to outlive the result and a shared block still has its parent in base. the result is
+             * meant to be read, merging into it or appending to its shared blocks would change base as well
+             */
+        FuelBlock* overlay(const FuelBlock* base, FuelArena& arena, FuelBlock* parent = nullptr) const;
+
         void write(std::ostream& stream) const;
 
     protected:
-        FuelBlock(FuelBlock* parent = nullptr);
+        FuelBlock(FuelArena* arena, FuelBlock* parent = nullptr);
 
     private:
-        const Attribute* attribute(const std::string& name) const;
+        friend class FuelBatch;
+        friend class GasCache;
+
+        const Attribute* attribute(std::string_view name) const;
+        const Attribute* attribute(const FuelPath& path) const;
+
+        // conversions shared by the string and FuelPath lookups, attr may be null
+        static bool asBool(const Attribute* attr, bool defaultValue);
+        static int asInt(const Attribute* attr, int defaultValue);
+        static unsigned int asUInt(const Attribute* attr, unsigned int defaultValue);
+        static float asFloat(const Attribute* attr, float defaultValue);
+        static std::string asString(const Attribute* attr, const std::string& defaultValue);
+        static std::array<float, 3> asFloat3(const Attribute* attr, const std::array<float, 3>& defaultValue);
+        static std::array<float, 4> asFloat4(const Attribute* attr, const std::array<float, 4>& defaultValue);
+        static vsg::vec3 asVec3(const Attribute* attr, const vsg::vec3& defaultValue);
+        static vsg::vec4 asColor(const Attribute* attr, const vsg::vec4& defaultValue);
+        static SiegeRot asSiegeRot(const Attribute* attr, const SiegeRot& defaultValue);
+        static SiegePos asSiegePos(const Attribute* attr, const SiegePos& defaultValue);
+
+        FuelBlock* createChild(const std::string& name, const std::string& type);
+
+        /*
+         * open addressing tables over the names of the children and attributes, built the first time a block
+         * with at least INDEX_THRESHOLD entries is searched and dropped whenever the block is modified
+         */
+        struct Index
+        {
+            uint32_t childMask;
+            uint32_t attributeMask;
+            const uint32_t* childSlots; // position + 1, 0 marks an empty slot
+            const uint32_t* attributeSlots;
+        };
+
+        static constexpr size_t INDEX_THRESHOLD = 8;
+
+        const Index* index() const;
+        void invalidateIndex();
+
+    protected:
+        FuelArena* mArena;
 
     private:
-        std::string mName;
-        std::string mType;
         FuelBlock* mParent;
-        std::vector<FuelBlock*> mChildren;
-        std::vector<Attribute> mAttributes;
+        const std::string* mName;
+        const std::string* mType;
+        FuelList<FuelBlock*> mChildren;
+        FuelList<Attribute> mAttributes;
+
+        mutable std::atomic<const Index*> mIndex{nullptr};
     };
 
-    inline FuelBlock::FuelBlock(FuelBlock* parent) :
-        mParent(parent)
+    inline FuelBlock::FuelBlock(FuelArena* arena, FuelBlock* parent) :
+        mArena(arena), mParent(parent), mName(&StringPool::empty()), mType(&StringPool::empty())
     {
     }
 
@@ -165,12 +346,12 @@ namespace ehb
 
     inline const std::string& FuelBlock::name() const
     {
-        return mName;
+        return *mName;
     }
 
     inline const std::string& FuelBlock::type() const
     {
-        return mType;
+        return *mType;
     }
 
     inline bool FuelBlock::isEmpty() const
@@ -178,32 +359,24 @@ namespace ehb
         return mChildren.empty() && mAttributes.empty();
     }
 
-    inline const std::vector<FuelBlock*>& FuelBlock::eachChild() const
+    inline const FuelList<FuelBlock*>& FuelBlock::eachChild() const
     {
         return mChildren;
     }
 
-    inline bool FuelBlock::hasAttr(const std::string& name) const
+    inline bool FuelBlock::hasAttr(std::string_view name) const
     {
-        for (const Attribute& attr : mAttributes)
-        {
-            if (attr.name == name)
-            {
-                return true;
-            }
-        }
-
-        return false;
+        return findAttribute(name, fuelHash(name)) != nullptr;
     }
 
-    inline const std::vector<Attribute>& FuelBlock::eachAttribute() const
+    inline const FuelList<Attribute>& FuelBlock::eachAttribute() const
     {
         return mAttributes;
     }
 
-    inline void FuelBlock::appendValue(const std::string& name, const std::string& value)
+    inline void FuelBlock::appendValue(std::string_view name, std::string_view value)
     {
-        appendValue(name, "", value);
+        appendValue(name, std::string_view(), value);
     }
 
     inline unsigned int FuelBlock::valueCount() const
@@ -212,7 +385,7 @@ namespace ehb
         return static_cast<unsigned int>(mAttributes.size());
     }
 
-    inline const std::string& FuelBlock::valueOf(const std::string& name, const std::string& defaultValue) const
+    inline std::string_view FuelBlock::valueOf(std::string_view name, std::string_view defaultValue) const
     {
         if (const Attribute* attr = attribute(name))
         {
@@ -222,7 +395,7 @@ namespace ehb
         return defaultValue;
     }
 
-    inline const std::string& FuelBlock::typeOf(const std::string& name, const std::string& defaultValue) const
+    inline std::string_view FuelBlock::typeOf(std::string_view name, std::string_view defaultValue) const
     {
         if (const Attribute* attr = attribute(name))
         {
@@ -232,7 +405,27 @@ namespace ehb
         return defaultValue;
     }
 
-    inline const std::string& FuelBlock::nameOf(unsigned int index, const std::string& defaultValue) const
+    inline std::string_view FuelBlock::valueOf(const FuelPath& path, std::string_view defaultValue) const
+    {
+        if (const Attribute* attr = attribute(path))
+        {
+            return attr->value;
+        }
+
+        return defaultValue;
+    }
+
+    inline std::string_view FuelBlock::typeOf(const FuelPath& path, std::string_view defaultValue) const
+    {
+        if (const Attribute* attr = attribute(path))
+        {
+            return attr->type;
+        }
+
+        return defaultValue;
+    }
+
+    inline std::string_view FuelBlock::nameOf(unsigned int index, std::string_view defaultValue) const
     {
         if (index < mAttributes.size())
         {
@@ -242,7 +435,7 @@ namespace ehb
         return defaultValue;
     }
 
-    inline const std::string& FuelBlock::typeOf(unsigned int index, const std::string& defaultValue) const
+    inline std::string_view FuelBlock::typeOf(unsigned int index, std::string_view defaultValue) const
     {
         if (index < mAttributes.size())
         {
@@ -252,7 +445,7 @@ namespace ehb
         return defaultValue;
     }
 
-    inline const std::string& FuelBlock::valueOf(unsigned int index, const std::string& defaultValue) const
+    inline std::string_view FuelBlock::valueOf(unsigned int index, std::string_view defaultValue) const
     {
         if (index < mAttributes.size())
         {
@@ -262,13 +455,38 @@ namespace ehb
         return defaultValue;
     }
 
+    class MappedFile;
     class Fuel : public FuelBlock
     {
     public:
-        bool load(std::istream& stream);
-        bool load(const std::string& filename);
+        Fuel();
+
+        Fuel(const Fuel&) = delete;
+        Fuel& operator=(const Fuel&) = delete;
+
+        //! parse straight out of the view without copying the text, see readFuel for recovery and diagnostics
+        bool load(const MappedFile& file, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+        bool load(std::istream& stream, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+        bool load(const std::string& filename, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
 
         bool save(std::ostream& stream) const;
         bool save(const std::string& filename) const;
+
+        //! everything below the root, released when the document is destroyed
+        const FuelArena& arena() const;
+
+    private:
+        FuelArena documentArena;
     };
+
+    inline Fuel::Fuel() :
+        FuelBlock(nullptr)
+    {
+        mArena = &documentArena;
+    }
+
+    inline const FuelArena& Fuel::arena() const
+    {
+        return documentArena;
+    }
 } // namespace ehb
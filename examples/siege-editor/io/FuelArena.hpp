@@ -0,0 +1,242 @@
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ehb
+{
+    /**
+     * bump allocator backing the blocks, attributes and values of a fuel document
+     *
+     * memory is handed out from a list of chunks that grow geometrically and is only ever released all at once
+     * when the arena is destroyed, so nothing placed in here may need its destructor run
+     */
+    class FuelArena
+    {
+    public:
+        FuelArena() = default;
+
+        FuelArena(const FuelArena&) = delete;
+        FuelArena& operator=(const FuelArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        template <typename T, typename... Args>
+        T* create(Args&&... args);
+
+        template <typename T>
+        T* allocateArray(size_t count);
+
+        //! copy the characters into the arena followed by a null terminator
+        std::string_view copy(std::string_view value);
+
+        /**
+         * same as allocate but serialized against other callers of allocateShared
+         *
+         * for data built lazily behind a const interface (lookup indices) where several readers may race to
+         * build it, plain allocate is only safe while one thread owns the document
+         */
+        void* allocateShared(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        //! hold off allocateShared for a writer that keeps adding to an arena other threads already read from
+        std::unique_lock<std::mutex> lockShared();
+
+        //! @return bytes handed out and bytes reserved from the system
+        size_t bytesUsed() const;
+        size_t bytesReserved() const;
+
+    private:
+        static constexpr size_t FIRST_CHUNK_SIZE = 4 * 1024;
+        static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> chunks;
+
+        char* cursor = nullptr;
+        char* limit = nullptr;
+
+        std::mutex sharedMutex;
+
+        size_t nextChunkSize = FIRST_CHUNK_SIZE;
+        size_t used = 0;
+        size_t reserved = 0;
+    };
+
+    /**
+     * growable array whose storage lives in a FuelArena
+     *
+     * growing copies into a new allocation and leaves the old one behind in the arena, blocks rarely have more
+     * than a handful of children or attributes so the waste is small compared to a heap allocation per vector
+     *
+     * a list can also share the elements of another one, push_back and detach copy them out before the first
+     * change. writing through operator[] or begin on a shared list writes into the other list as well
+     */
+    template <typename T>
+    class FuelList
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FuelList never runs destructors");
+
+    public:
+        typedef const T* const_iterator;
+
+        const T* begin() const { return mData; }
+        const T* end() const { return mData + mSize; }
+
+        T* begin() { return mData; }
+        T* end() { return mData + mSize; }
+
+        size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        const T& operator[](size_t index) const { return mData[index]; }
+        T& operator[](size_t index) { return mData[index]; }
+
+        const T& front() const { return mData[0]; }
+        const T& back() const { return mData[mSize - 1]; }
+
+        void push_back(FuelArena& arena, const T& value);
+        void reserve(FuelArena& arena, size_t capacity);
+
+        //! read the elements of other from now on, it has to outlive this list or the next detach
+        void share(const FuelList& other);
+        bool shared() const { return mCapacity < mSize; }
+
+        //! give a shared list storage of its own so it can be written to
+        void detach(FuelArena& arena);
+
+    private:
+        T* mData = nullptr;
+        uint32_t mSize = 0;
+        uint32_t mCapacity = 0;
+    };
+
+    inline void* FuelArena::allocate(size_t size, size_t alignment)
+    {
+        char* result = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+
+        if (cursor == nullptr || result + size > limit)
+        {
+            // oversized requests get a chunk of their own so they don't force the next chunks to grow
+            const size_t chunkSize = std::max(nextChunkSize, size + alignment);
+
+            chunks.emplace_back(new char[chunkSize]);
+
+            cursor = chunks.back().get();
+            limit = cursor + chunkSize;
+            reserved += chunkSize;
+
+            nextChunkSize = std::min(nextChunkSize * 2, MAX_CHUNK_SIZE);
+
+            result = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        }
+
+        cursor = result + size;
+        used += size;
+
+        return result;
+    }
+
+    inline void* FuelArena::allocateShared(size_t size, size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+
+        return allocate(size, alignment);
+    }
+
+    inline std::unique_lock<std::mutex> FuelArena::lockShared()
+    {
+        return std::unique_lock<std::mutex>(sharedMutex);
+    }
+
+    template <typename T, typename... Args>
+    inline T* FuelArena::create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "the arena never runs destructors");
+
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    inline T* FuelArena::allocateArray(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    inline std::string_view FuelArena::copy(std::string_view value)
+    {
+        if (value.empty())
+        {
+            return std::string_view();
+        }
+
+        char* data = static_cast<char*>(allocate(value.size() + 1, 1));
+
+        std::memcpy(data, value.data(), value.size());
+        data[value.size()] = '\0';
+
+        return std::string_view(data, value.size());
+    }
+
+    inline size_t FuelArena::bytesUsed() const
+    {
+        return used;
+    }
+
+    inline size_t FuelArena::bytesReserved() const
+    {
+        return reserved;
+    }
+
+    template <typename T>
+    inline void FuelList<T>::push_back(FuelArena& arena, const T& value)
+    {
+        if (mSize >= mCapacity)
+        {
+            reserve(arena, mSize == 0 ? 4 : mSize * 2);
+        }
+
+        new (mData + mSize++) T(value);
+    }
+
+    template <typename T>
+    inline void FuelList<T>::reserve(FuelArena& arena, size_t capacity)
+    {
+        if (capacity > mCapacity)
+        {
+            T* data = arena.allocateArray<T>(capacity);
+
+            // copy constructed rather than copied bytewise, an Attribute holds an atomic. the old elements are
+            // left in the arena without being destroyed, which is fine for the trivially destructible types we hold
+            std::uninitialized_copy(mData, mData + mSize, data);
+
+            mData = data;
+            mCapacity = static_cast<uint32_t>(capacity);
+        }
+    }
+
+    template <typename T>
+    inline void FuelList<T>::share(const FuelList& other)
+    {
+        // a capacity below the size is what marks the storage as someone else's
+        mData = other.mData;
+        mSize = other.mSize;
+        mCapacity = 0;
+    }
+
+    template <typename T>
+    inline void FuelList<T>::detach(FuelArena& arena)
+    {
+        if (shared())
+        {
+            reserve(arena, mSize);
+        }
+    }
+} // namespace ehb
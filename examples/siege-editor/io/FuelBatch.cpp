@@ -0,0 +1,65 @@
+
+#include "FuelBatch.hpp"
+
+#include "FuelReader.hpp"
+#include "ParallelFor.hpp"
+
+namespace ehb
+{
+    FuelBatch::FuelBatch(size_t count, unsigned maxThreads) :
+        mDocuments(count, nullptr), adopted(count)
+    {
+        for (unsigned i = 0; i < workerCount(count, maxThreads); ++i)
+        {
+            arenas.emplace_back(std::make_unique<FuelArena>());
+        }
+    }
+
+    FuelBatch FuelBatch::parse(const std::vector<InputView>& inputs, unsigned maxThreads, FuelRecovery recovery)
+    {
+        FuelBatch batch(inputs.size(), maxThreads);
+
+        parallelForWorkers(inputs.size(), [&](unsigned worker, size_t i) {
+            if (inputs[i])
+            {
+                batch.parseDocument(worker, i, *inputs[i], recovery);
+            }
+        }, maxThreads);
+
+        return batch;
+    }
+
+    size_t FuelBatch::bytesReserved() const
+    {
+        size_t result = 0;
+
+        for (const auto& arena : arenas)
+        {
+            result += arena->bytesReserved();
+        }
+
+        return result;
+    }
+
+    bool FuelBatch::parseDocument(unsigned worker, size_t index, const MappedFile& file, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics)
+    {
+        FuelArena& arena = *arenas[worker];
+
+        FuelBlock* root = new (arena.allocate(sizeof(FuelBlock), alignof(FuelBlock))) FuelBlock(&arena);
+
+        // whatever a failed parse built stays in the arena until the batch goes, same as a discarded Fuel would
+        if (readFuel(file, *root, recovery, diagnostics))
+        {
+            mDocuments[index] = root;
+            return true;
+        }
+
+        return false;
+    }
+
+    void FuelBatch::adopt(size_t index, std::unique_ptr<Fuel> doc)
+    {
+        mDocuments[index] = doc.get();
+        adopted[index] = std::move(doc);
+    }
+} // namespace ehb
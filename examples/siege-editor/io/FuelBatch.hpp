@@ -0,0 +1,72 @@
+
+#pragma once
+
+#include "Fuel.hpp"
+#include "MappedFile.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace ehb
+{
+    /**
+     * documents parsed together on a bounded pool of threads
+     *
+     * every worker builds into an arena of its own so the threads never share an allocator, the documents come
+     * back in the order they were asked for whichever thread parsed them and all of them live exactly as long
+     * as the batch does. the arenas are only written while the batch is being filled, once it is handed out the
+     * documents are as safe to read concurrently as any Fuel
+     */
+    class FuelBatch
+    {
+    public:
+        FuelBatch() = default;
+
+        FuelBatch(FuelBatch&&) = default;
+        FuelBatch& operator=(FuelBatch&&) = default;
+
+        //! parse every input, inputs that are null or fail to parse leave a null document behind, see readFuel for recovery
+        static FuelBatch parse(const std::vector<InputView>& inputs, unsigned maxThreads = 0, FuelRecovery recovery = FuelRecovery::FailFast);
+
+        size_t size() const;
+
+        //! @return the root of document index, nullptr if it could not be loaded
+        FuelBlock* operator[](size_t index) const;
+
+        const std::vector<FuelBlock*>& documents() const;
+
+        //! @return bytes reserved by the worker arenas, documents that came out of the gas cache aren't counted
+        size_t bytesReserved() const;
+
+    private:
+        friend class IFileSys;
+
+        FuelBatch(size_t count, unsigned maxThreads);
+
+        //! only ever called by one worker for a given index, which is what makes filling the batch lock free
+        bool parseDocument(unsigned worker, size_t index, const MappedFile& file, FuelRecovery recovery, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+        void adopt(size_t index, std::unique_ptr<Fuel> doc);
+
+    private:
+        std::vector<std::unique_ptr<FuelArena>> arenas;
+        std::vector<FuelBlock*> mDocuments;
+
+        // documents from the gas cache come with an arena of their own, slot i belongs to document i
+        std::vector<std::unique_ptr<Fuel>> adopted;
+    };
+
+    inline size_t FuelBatch::size() const
+    {
+        return mDocuments.size();
+    }
+
+    inline FuelBlock* FuelBatch::operator[](size_t index) const
+    {
+        return mDocuments[index];
+    }
+
+    inline const std::vector<FuelBlock*>& FuelBatch::documents() const
+    {
+        return mDocuments;
+    }
+} // namespace ehb
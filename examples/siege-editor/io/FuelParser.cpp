@@ -50,7 +50,7 @@
 // Unqualified %code blocks.
 #line 37 "src/FuelParser.y" // lalr1.cc:413
 
-static int yylex(std::string* yylval, ehb::FuelScanner& scanner)
+static int yylex(std::string_view* yylval, ehb::FuelScanner& scanner)
 {
     return scanner.scan(yylval);
 }
@@ -125,13 +125,14 @@ namespace ehb
 #line 129 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:479
 
     /// Build a parser object.
-    FuelParser ::FuelParser(ehb::FuelScanner& scanner_yyarg, ehb::FuelBlock* node_yyarg) :
+    FuelParser ::FuelParser(ehb::FuelScanner& scanner_yyarg, ehb::FuelHandler& handler_yyarg, ehb::FuelRecovery recovery_yyarg) :
 #if YYDEBUG
         yydebug_(false),
         yycdebug_(&std::cerr),
 #endif
         scanner(scanner_yyarg),
-        node(node_yyarg)
+        handler(handler_yyarg),
+        recovery(recovery_yyarg)
     {
     }
 
@@ -522,7 +523,7 @@ namespace ehb
                     case 3:
 #line 62 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node = node->parent();
+                        if (!leaveBlock(yystack_.size() - yylen)) YYACCEPT;
                     }
 #line 557 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -530,7 +531,10 @@ namespace ehb
                     case 4:
 #line 63 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node = node->parent();
+                        if (!leaveBlock(yystack_.size() - yylen)) YYACCEPT;
+
+                        // the '}' the grammar resumed at has to be this block's own, otherwise everything after it lands at the wrong depth
+                        if (scanner.depth() != open.size()) YYABORT;
 
                         // account for rogue characters found in gpg gas file
                         yyerrok;
@@ -541,7 +545,7 @@ namespace ehb
                     case 5:
 #line 72 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node = node->appendChild((yystack_[0].value));
+                        if (!enterBlock((yystack_[0].value), std::string_view(), yystack_.size() - yylen - 1)) YYACCEPT;
                     }
 #line 574 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -549,7 +553,7 @@ namespace ehb
                     case 6:
 #line 73 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node = node->appendChild((yystack_[0].value), (yystack_[4].value));
+                        if (!enterBlock((yystack_[0].value), (yystack_[4].value), yystack_.size() - yylen - 1)) YYACCEPT;
                     }
 #line 580 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -559,7 +563,7 @@ namespace ehb
                     {
 
                         // TODO: do something with $1... like check for "dev"?
-                        node = node->appendChild((yystack_[0].value), (yystack_[4].value));
+                        if (!enterBlock((yystack_[0].value), (yystack_[4].value), yystack_.size() - yylen - 1)) YYACCEPT;
                     }
 #line 591 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -567,7 +571,7 @@ namespace ehb
                     case 14:
 #line 98 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node->appendValue((yystack_[3].value), (yystack_[1].value));
+                        if (!attribute((yystack_[3].value), std::string_view(), (yystack_[1].value))) YYACCEPT;
                     }
 #line 597 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -575,7 +579,7 @@ namespace ehb
                     case 15:
 #line 99 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        node->appendValue((yystack_[3].value), (yystack_[4].value), (yystack_[1].value));
+                        if (!attribute((yystack_[3].value), (yystack_[4].value), (yystack_[1].value))) YYACCEPT;
                     }
 #line 603 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -583,7 +587,7 @@ namespace ehb
                     case 18:
 #line 108 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        (yylhs.value) = (yystack_[1].value) + (yystack_[0].value);
+                        (yylhs.value) = join((yystack_[1].value), (yystack_[0].value));
                     }
 #line 609 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -594,8 +598,8 @@ namespace ehb
 
                         (yylhs.value) = (yystack_[0].value);
 
-                        (yylhs.value).erase(0, (yylhs.value).find_first_not_of(" \n\r\t"));
-                        (yylhs.value).erase((yylhs.value).find_last_not_of(" \n\r\t") + 1);
+                        (yylhs.value).remove_prefix(std::min((yylhs.value).find_first_not_of(" \n\r\t"), (yylhs.value).size()));
+                        (yylhs.value) = (yylhs.value).substr(0, (yylhs.value).find_last_not_of(" \n\r\t") + 1);
                     }
 #line 622 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -603,7 +607,7 @@ namespace ehb
                     case 23:
 #line 129 "src/FuelParser.y" // lalr1.cc:859
                     {
-                        (yylhs.value) = (yystack_[2].value) + ':' + (yystack_[0].value);
+                        (yylhs.value) = joinPath((yystack_[2].value), (yystack_[0].value));
                     }
 #line 628 "E:/Programming/Projects/gitea/GameState/build/FuelParser.cpp" // lalr1.cc:859
                     break;
@@ -636,7 +640,17 @@ namespace ehb
             if (!yyerrstatus_)
             {
                 ++yynerrs_;
-                error(yysyntax_error_(yystack_[0].state, yyla));
+                yyreport_syntax_error_(yystack_[0].state, yyla);
+            }
+
+            // a character the scanner doesn't know is never skipped over in place, and with NextBlock nothing is: the
+            // grammar's own recovery would carry on inside the broken block and take whatever comes after it along
+            if (yyla.type_get() == 2 || recovery == FuelRecovery::NextBlock)
+            {
+                if (yyerrstatus_)
+                    yyreport_syntax_error_(yystack_[0].state, yyla);
+
+                YYABORT;
             }
 
             if (yyerrstatus_ == 3)
@@ -760,9 +774,80 @@ namespace ehb
 
     // Generate an error message.
     std::string
-    FuelParser ::yysyntax_error_(state_type, const symbol_type&) const
+    FuelParser ::yysyntax_error_(state_type yystate, const symbol_type& yyla) const
     {
-        return YY_("syntax error");
+        std::string yyres = YY_("syntax error, unexpected ") + yysymbol_name_(yyla);
+
+        const std::vector<std::string> yyexpected = yyexpected_(yystate);
+
+        for (size_t yyi = 0; yyi < yyexpected.size(); ++yyi)
+        {
+            yyres += yyi == 0 ? YY_(", expecting ") : YY_(" or ");
+            yyres += yyexpected[yyi];
+        }
+
+        return yyres;
+    }
+
+    std::vector<std::string>
+    FuelParser ::yyexpected_(state_type yystate) const
+    {
+        // more than this and the list says less than "syntax error" alone
+        enum { YYERROR_VERBOSE_EXPECTED_MAXIMUM = 4 };
+
+        std::vector<std::string> yyres;
+
+        int yyn = yypact_[yystate];
+        if (!yy_pact_value_is_default_(yyn))
+        {
+            /* Start YYX at -YYN if negative to avoid negative indexes in
+               YYCHECK.  In other words, skip the first -YYN actions for
+               this state because they are default actions.  */
+            int yyxbegin = yyn < 0 ? -yyn : 0;
+            // Stay within bounds of both yycheck and yytname.
+            int yychecklim = yylast_ - yyn + 1;
+            int yyxend = yychecklim < yyntokens_ ? yychecklim : yyntokens_;
+            for (int yyx = yyxbegin; yyx < yyxend; ++yyx)
+                if (yycheck_[yyx + yyn] == yyx && yyx != yyterror_ && !yy_table_value_is_error_(yytable_[yyx + yyn]))
+                {
+                    if (yyres.size() == YYERROR_VERBOSE_EXPECTED_MAXIMUM)
+                        return {};
+
+                    yyres.emplace_back(yytname_[yyx]);
+                }
+        }
+
+        // "expression" reads better without the quotes bison keeps around aliases
+        for (std::string& yyname : yyres)
+            if (yyname.size() > 1 && yyname.front() == '"')
+                yyname = yyname.substr(1, yyname.size() - 2);
+
+        return yyres;
+    }
+
+    std::string
+    FuelParser ::yysymbol_name_(const symbol_type& yyla) const
+    {
+        const int yytype = yyla.type_get();
+
+        // the character the scanner didn't know what to do with says more than "$undefined"
+        if (yytype == 2)
+            return "'" + std::string(scanner.lastToken()) + "'";
+
+        std::string yyname = yytname_[yytype];
+
+        if (yyname.size() > 1 && yyname.front() == '"')
+            yyname = yyname.substr(1, yyname.size() - 2);
+
+        return yyname;
+    }
+
+    void
+    FuelParser ::yyreport_syntax_error_(state_type yystate, const symbol_type& yyla)
+    {
+        error(yysyntax_error_(yystate, yyla));
+
+        mDiagnostics.back().expected = yyexpected_(yystate);
     }
 
     const signed char FuelParser ::yypact_ninf_ = -27;
@@ -843,18 +928,18 @@ namespace ehb
                 1, 2, 1, 1, 4, 5, 1, 1, 2, 0,
                 1, 1, 1, 3};
 
-#if YYDEBUG
     // YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
     // First, the terminals, then, starting at \a yyntokens_, nonterminals.
     const char* const FuelParser ::yytname_[] =
         {
-            "$end", "error", "$undefined", "\"expression\"", "\"identifier\"",
+            "\"end of file\"", "error", "$undefined", "\"expression\"", "\"identifier\"",
             "'['", "']'", "'{'", "'}'", "':'", "','", "'='", "';'", "$accept",
             "translation_unit", "element", "element_name", "element_body",
             "element_body_list", "element_body_item", "attribute", "type_id",
             "expression_list", "expression_statement", "simple_identifier",
             "identifier", YY_NULLPTR};
 
+#if YYDEBUG
     const unsigned char
         FuelParser ::yyrline_[] =
             {
@@ -946,7 +1031,144 @@ namespace ehb
 {
     void FuelParser::error(const std::string& msg)
     {
-        // TODO: don't print this to cerr, but somewhere else user defined
-        std::cerr << msg << std::endl;
+        FuelDiagnostic& diagnostic = mDiagnostics.emplace_back();
+
+        scanner.location(diagnostic.line, diagnostic.column);
+        diagnostic.found = scanner.lastToken();
+        diagnostic.message = msg;
+    }
+
+    bool FuelParser::closeOpenBlocks()
+    {
+        while (!open.empty())
+        {
+            if (!closeBlock())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string_view FuelParser::join(std::string_view first, std::string_view second)
+    {
+        if (first.empty())
+        {
+            return second;
+        }
+
+        if (second.empty() || first.data() + first.size() == second.data())
+        {
+            return std::string_view(first.data(), first.size() + second.size());
+        }
+
+        // a comment split the value, the previous join can be extended in place as nothing else refers to it
+        if (!joined.empty() && first.data() == joined.back().data() && first.size() == joined.back().size())
+        {
+            joined.back().append(second);
+        }
+        else
+        {
+            joined.emplace_back(first).append(second);
+        }
+
+        return joined.back();
+    }
+
+    std::string_view FuelParser::joinPath(std::string_view first, std::string_view second)
+    {
+        // with nothing but the ':' in between the whole path is already in the source
+        if (first.data() + first.size() + 1 == second.data())
+        {
+            return std::string_view(first.data(), first.size() + 1 + second.size());
+        }
+
+        return join(join(first, ":"), second);
+    }
+
+    bool FuelParser::enterBlock(std::string_view name, std::string_view type, size_t position)
+    {
+        if (skipping)
+        {
+            open.push_back({position, false});
+            return true;
+        }
+
+        const FuelVisit result = handler.enterBlock(name, type);
+
+        // the handler is done with every view it was given so nothing joined so far is needed any more
+        joined.clear();
+
+        open.push_back({position, result != FuelVisit::Skip});
+
+        if (result == FuelVisit::Skip)
+        {
+            skipping = true;
+            skipBase = open.size();
+        }
+
+        return result != FuelVisit::Stop;
+    }
+
+    bool FuelParser::attribute(std::string_view name, std::string_view type, std::string_view value)
+    {
+        if (skipping)
+        {
+            return true;
+        }
+
+        const FuelVisit result = handler.attribute(name, type, value);
+
+        joined.clear();
+
+        if (result == FuelVisit::Skip)
+        {
+            skipping = true;
+            skipBase = open.size();
+        }
+
+        return result != FuelVisit::Stop;
+    }
+
+    bool FuelParser::leaveBlock(size_t position)
+    {
+        // blocks opened after this one that error recovery threw away before their '}' turned up
+        while (!open.empty() && open.back().position > position)
+        {
+            if (!closeBlock())
+            {
+                return false;
+            }
+        }
+
+        return open.empty() || closeBlock();
+    }
+
+    bool FuelParser::closeBlock()
+    {
+        const bool reported = open.back().reported;
+
+        open.pop_back();
+
+        if (skipping && open.size() < skipBase)
+        {
+            skipping = false;
+        }
+
+        if (!reported || skipping)
+        {
+            return true;
+        }
+
+        const FuelVisit result = handler.leaveBlock();
+
+        if (result == FuelVisit::Skip)
+        {
+            skipping = true;
+            skipBase = open.size();
+        }
+
+        return result != FuelVisit::Stop;
     }
 } // namespace ehb
@@ -42,9 +42,11 @@
 // //                    "%code requires" blocks.
 #line 29 "src/FuelParser.y" // lalr1.cc:377
 
-#include "Fuel.hpp"
+#include "FuelReader.hpp"
 #include "FuelScanner.hpp"
+#include <deque>
 #include <string>
+#include <string_view>
 
 #line 52 "E:/Programming/Projects/gitea/GameState/build/FuelParser.hpp" // lalr1.cc:377
 
@@ -122,7 +124,7 @@ namespace ehb
     public:
 #ifndef YYSTYPE
         /// Symbol semantic values.
-        typedef std::string semantic_type;
+        typedef std::string_view semantic_type;
 #else
         typedef YYSTYPE semantic_type;
 #endif
@@ -241,7 +243,7 @@ namespace ehb
         typedef basic_symbol<by_type> symbol_type;
 
         /// Build a parser object.
-        FuelParser(ehb::FuelScanner& scanner_yyarg, ehb::FuelBlock* node_yyarg);
+        FuelParser(ehb::FuelScanner& scanner_yyarg, ehb::FuelHandler& handler_yyarg, ehb::FuelRecovery recovery_yyarg = ehb::FuelRecovery::FailFast);
         virtual ~FuelParser();
 
         /// Parse.
@@ -269,6 +271,16 @@ namespace ehb
         /// Report a syntax error.
         void error(const syntax_error& err);
 
+        //! syntax errors in the order they were found, including any the grammar recovered from by itself
+        const std::vector<FuelDiagnostic>& diagnostics() const;
+
+        /**
+         * report leaveBlock for every block the handler saw entered but not left, for when parse gave up half way
+         *
+         * @return false if the handler asked for the parse to stop
+         */
+        bool closeOpenBlocks();
+
     private:
         /// This class is not copyable.
         FuelParser(const FuelParser&);
@@ -335,10 +347,19 @@ namespace ehb
         // YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.
         static const unsigned char yyr2_[];
 
-#if YYDEBUG
         /// For a symbol, its name in clear.
         static const char* const yytname_[];
 
+        /// Convert the tokens this parser would have accepted in \a yystate to their names.
+        std::vector<std::string> yyexpected_(state_type yystate) const;
+
+        /// Name of the lookahead \a yyla as a diagnostic shows it.
+        std::string yysymbol_name_(const symbol_type& yyla) const;
+
+        /// Record a syntax error at the scanner's last token.
+        void yyreport_syntax_error_(state_type yystate, const symbol_type& yyla);
+
+#if YYDEBUG
         // YYRLINE[YYN] -- Source line where rule number YYN was defined.
         static const unsigned char yyrline_[];
         /// Report on the debug stream that the rule \a r is going to be reduced.
@@ -452,9 +473,44 @@ namespace ehb
 
         // User arguments.
         ehb::FuelScanner& scanner;
-        ehb::FuelBlock* node;
+        ehb::FuelHandler& handler;
+        ehb::FuelRecovery recovery;
+
+        // values are views into the source, only pieces that aren't next to each other there get copied in here
+        std::deque<std::string> joined;
+
+        std::string_view join(std::string_view first, std::string_view second);
+        std::string_view joinPath(std::string_view first, std::string_view second);
+
+        std::vector<FuelDiagnostic> mDiagnostics;
+
+        struct OpenBlock
+        {
+            // index of its '[' in yystack_, error recovery can pop a block without it ever being reduced
+            size_t position;
+
+            // whether the handler gets a leaveBlock for it
+            bool reported;
+        };
+
+        std::vector<OpenBlock> open;
+
+        // set when the handler asked to skip, nothing reaches it until the block count drops below skipBase
+        bool skipping = false;
+        size_t skipBase = 0;
+
+        // forward to the handler, false once it wants the parse stopped
+        bool enterBlock(std::string_view name, std::string_view type, size_t position);
+        bool attribute(std::string_view name, std::string_view type, std::string_view value);
+        bool leaveBlock(size_t position);
+        bool closeBlock();
     };
 
+    inline const std::vector<FuelDiagnostic>& FuelParser::diagnostics() const
+    {
+        return mDiagnostics;
+    }
+
 #line 24 "src/FuelParser.y" // lalr1.cc:377
 } // namespace ehb
 #line 469 "E:/Programming/Projects/gitea/GameState/build/FuelParser.hpp" // lalr1.cc:377
@@ -0,0 +1,120 @@
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace ehb
+{
+    //! hash used to index block and attribute names, FNV-1a so it can be evaluated at compile time
+    constexpr uint32_t fuelHash(std::string_view name)
+    {
+        uint32_t result = 2166136261u;
+
+        for (char c : name)
+        {
+            result = (result ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+
+        return result;
+    }
+
+    /**
+     * a ':' separated query split into segments and hashed up front
+     *
+     * passing a string to FuelBlock::child or valueOf re-splits and re-hashes it on every call, a FuelPath does
+     * that once so the same query can be run against thousands of blocks for the cost of the lookups alone.
+     * paths built from literals are folded at compile time:
+     *
+     *     static constexpr FuelPath targetNode("siege_node_list:targetnode");
+     *
+     * the path text is not copied and has to outlive the FuelPath
+     */
+    class FuelPath
+    {
+    public:
+        static constexpr size_t MAX_SEGMENTS = 8;
+
+        struct Segment
+        {
+            std::string_view name;
+            uint32_t hash = 0;
+        };
+
+        constexpr explicit FuelPath(std::string_view path);
+
+        constexpr size_t size() const { return mSize; }
+        constexpr bool empty() const { return mSize == 0; }
+
+        constexpr const Segment& operator[](size_t index) const { return mSegments[index]; }
+
+        constexpr const Segment* begin() const { return mSegments.data(); }
+        constexpr const Segment* end() const { return mSegments.data() + mSize; }
+
+        constexpr const Segment& back() const { return mSegments[mSize - 1]; }
+
+        //! the path without its first count segments, used to strip a template name off a content query
+        constexpr FuelPath subpath(size_t count) const;
+
+        constexpr std::string_view str() const { return mPath; }
+
+    private:
+        constexpr FuelPath() = default;
+
+        std::string_view mPath;
+        std::array<Segment, MAX_SEGMENTS> mSegments = {};
+        size_t mSize = 0;
+    };
+
+    constexpr FuelPath::FuelPath(std::string_view path) :
+        mPath(path)
+    {
+        if (path.empty())
+        {
+            return;
+        }
+
+        for (size_t start = 0;;)
+        {
+            const size_t end = path.find(':', start);
+
+            // a constant expression that gets here fails to compile, which is what we want for an over long literal
+            if (mSize == MAX_SEGMENTS)
+            {
+                throw std::length_error("fuel path has too many segments");
+            }
+
+            const std::string_view name = path.substr(start, end - start);
+
+            mSegments[mSize++] = Segment{name, fuelHash(name)};
+
+            if (end == std::string_view::npos)
+            {
+                break;
+            }
+
+            start = end + 1;
+        }
+    }
+
+    constexpr FuelPath FuelPath::subpath(size_t count) const
+    {
+        FuelPath result;
+
+        for (size_t i = count; i < mSize; ++i)
+        {
+            result.mSegments[result.mSize++] = mSegments[i];
+        }
+
+        if (result.mSize != 0)
+        {
+            const size_t first = static_cast<size_t>(result.mSegments[0].name.data() - mPath.data());
+
+            result.mPath = mPath.substr(first);
+        }
+
+        return result;
+    }
+} // namespace ehb
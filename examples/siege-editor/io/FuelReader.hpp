@@ -0,0 +1,149 @@
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FuelPath.hpp"
+#include "MappedFile.hpp"
+
+namespace ehb
+{
+    class FuelBlock;
+
+    //! what a FuelHandler wants the parser to do after a callback returns
+    enum class FuelVisit
+    {
+        Continue,
+        Skip, // nothing more from inside the current block, see FuelHandler
+        Stop  // end the parse here, readFuel still reports success
+    };
+
+    /**
+     * receives a fuel document as the parser walks it, without a FuelBlock tree ever being built
+     *
+     * the views passed in are only valid for the duration of the call. returning Skip from enterBlock drops the
+     * block with everything inside it and its leaveBlock, from attribute or leaveBlock it drops the rest of the
+     * block the call was made in but its leaveBlock is still reported
+     *
+     * names arrive as written, one with a ':' in it is not split into nested blocks like FuelBlock does
+     */
+    class FuelHandler
+    {
+    public:
+        virtual ~FuelHandler() = default;
+
+        virtual FuelVisit enterBlock(std::string_view /*name*/, std::string_view /*type*/) { return FuelVisit::Continue; }
+        virtual FuelVisit attribute(std::string_view /*name*/, std::string_view /*type*/, std::string_view /*value*/) { return FuelVisit::Continue; }
+        virtual FuelVisit leaveBlock() { return FuelVisit::Continue; }
+    };
+
+    //! a syntax error, line and column count from 1 and tabs are a single column
+    struct FuelDiagnostic
+    {
+        uint32_t line = 0;
+        uint32_t column = 0;
+
+        //! the offending token as written, empty at the end of the file
+        std::string found;
+
+        //! tokens that would have been accepted instead, empty when there are too many to be of any help
+        std::vector<std::string> expected;
+
+        std::string message;
+    };
+
+    //! what happens to the rest of a document after a syntax error
+    enum class FuelRecovery
+    {
+        FailFast, // the grammar recovers inside a block where it can, anything else rejects the document
+        NextBlock // blocks left open are closed and parsing picks up again at the next top level block header
+    };
+
+    /**
+     * with FailFast the return is false if the document has a syntax error before the handler stopped it. with
+     * NextBlock only the broken top level block is lost, everything the handler saw of it before the error stays
+     * seen, and the return is always true
+     *
+     * errors are appended to diagnostics when one is given, with FailFast the grammar's own recovery inside a block
+     * can leave entries there even when the document is accepted. a character the scanner doesn't know is never
+     * recovered from inside the block it turns up in
+     */
+    bool readFuel(const MappedFile& file, FuelHandler& handler, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+    bool readFuel(std::istream& stream, FuelHandler& handler, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+
+    //! parse into root with the handler behind Fuel::load, everything is allocated from the arena of root
+    bool readFuel(const MappedFile& file, FuelBlock& root, FuelRecovery recovery = FuelRecovery::FailFast, std::vector<FuelDiagnostic>* diagnostics = nullptr);
+
+    /**
+     * picks the value FuelBlock::valueOf(path) would return out of a document and stops as soon as it has it
+     *
+     * blocks off the path are skipped, so for a value near the top of a file most of it is never looked at
+     */
+    class FuelPathReader : public FuelHandler
+    {
+    public:
+        explicit FuelPathReader(const FuelPath& path);
+
+        FuelVisit enterBlock(std::string_view name, std::string_view type) override;
+        FuelVisit attribute(std::string_view name, std::string_view type, std::string_view value) override;
+        FuelVisit leaveBlock() override;
+
+        bool found() const { return mFound; }
+
+        const std::string& type() const { return mType; }
+        const std::string& value() const { return mValue; }
+
+    private:
+        FuelPath path;
+        size_t depth = 0;
+
+        bool mFound = false;
+        std::string mType;
+        std::string mValue;
+    };
+
+    //! the conversions behind FuelBlock::valueAsInt, valueAsUInt and valueAsFloat for raw values, false if it doesn't parse
+    bool parseFuelValue(std::string_view type, std::string_view value, int& result);
+    bool parseFuelValue(std::string_view type, std::string_view value, unsigned int& result);
+    bool parseFuelValue(std::string_view type, std::string_view value, float& result);
+
+    inline FuelPathReader::FuelPathReader(const FuelPath& path) :
+        path(path)
+    {
+    }
+
+    inline FuelVisit FuelPathReader::enterBlock(std::string_view name, std::string_view /*type*/)
+    {
+        if (depth + 1 < path.size() && name == path[depth].name)
+        {
+            ++depth;
+            return FuelVisit::Continue;
+        }
+
+        return FuelVisit::Skip;
+    }
+
+    inline FuelVisit FuelPathReader::attribute(std::string_view name, std::string_view type, std::string_view value)
+    {
+        if (depth + 1 == path.size() && name == path.back().name)
+        {
+            mFound = true;
+            mType.assign(type);
+            mValue.assign(value);
+
+            return FuelVisit::Stop;
+        }
+
+        return FuelVisit::Continue;
+    }
+
+    inline FuelVisit FuelPathReader::leaveBlock()
+    {
+        // only the first block matching each segment is searched, same as FuelBlock::child
+        return FuelVisit::Stop;
+    }
+} // namespace ehb
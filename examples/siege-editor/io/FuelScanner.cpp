@@ -23,24 +23,110 @@
 #include "FuelScanner.hpp"
 #include "FuelParser.hpp"
 
+// FUEL_SCANNER_NO_SSE2 keeps the plain loops on any target, the tests build the scanner that way as well
+#if !defined(FUEL_SCANNER_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FUEL_SCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace ehb
 {
-    int FuelScanner::scan(std::string* yylval)
+    namespace
+    {
+        /*
+         * the state machine below looks at one byte at a time, which is fine around punctuation but slow over the
+         * long runs of indentation, comments and value text that make up most of a gas file. these find the end of
+         * such a run sixteen bytes at a time and fall back to a plain loop for the tail and targets without sse2
+         */
+        inline unsigned lowestBit(unsigned mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        //! @return the first byte in [cursor, limit) that is (Stop) or isn't (!Stop) one of Chars, limit if there is none
+        template <bool Stop, char... Chars>
+        const char* scanRun(const char* cursor, const char* limit)
+        {
+#if defined(FUEL_SCANNER_SSE2)
+            for (; limit - cursor >= 16; cursor += 16)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+
+                __m128i hits = _mm_setzero_si128();
+                ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(Chars)))), ...);
+
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)) ^ (Stop ? 0u : 0xffffu);
+
+                if (mask != 0)
+                {
+                    return cursor + lowestBit(mask);
+                }
+            }
+#endif
+
+            while (cursor < limit && (((*cursor == Chars) || ...) != Stop))
+            {
+                ++cursor;
+            }
+
+            return cursor;
+        }
+
+        template <char... Chars>
+        const char* findAny(const char* cursor, const char* limit)
+        {
+            return scanRun<true, Chars...>(cursor, limit);
+        }
+
+        template <char... Chars>
+        const char* skipAll(const char* cursor, const char* limit)
+        {
+            return scanRun<false, Chars...>(cursor, limit);
+        }
+    } // namespace
+
+    int FuelScanner::scan(std::string_view* yylval)
     {
 #define YYCTYPE char
 #define YYCURSOR cursor
 #define YYLIMIT limit
 #define YYMARKER marker
-#define YYFILL(n)
+#define YYFILL(n) do {} while (0)
 
-#define yytext std::string(start, cursor - start)
+// the end of the input reads as a null character, which every state treats as the end of the file
+#define YYPEEK() (YYCURSOR < YYLIMIT ? *YYCURSOR : '\0')
+
+#define yytext std::string_view(start, cursor - start)
 
         while (1)
         {
-            const char* start = cursor;
+            const char* start = token = cursor;
+
+            // whatever state we are in, running out of input ends it
+            if (cursor >= limit)
+            {
+                return 0;
+            }
 
             if (state.empty())
             {
+                // blank lines and indentation never produce a token
+                if (const char* end = skipAll<' ', '\t', '\r', '\n'>(cursor, limit); end != cursor)
+                {
+                    cursor = end;
+                    continue;
+                }
+
                 /*
                  * HACK: line 35 of ui/interfaces/backend/console_output/console_output.gas: [t:window;n:rollover_console]
                  * there is a typo here as the ';' should be a ','
@@ -51,7 +137,7 @@ namespace ehb
                     unsigned char yych;
 
                     if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     if (yych <= ':')
                     {
                         if (yych <= ' ')
@@ -121,20 +207,22 @@ namespace ehb
                         }
                     }
                 yy2:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     if (yych == '*') goto yy34;
                     if (yych == '/') goto yy36;
                 yy3 :
 #line 70 "src/FuelScanner.r2c"
                 {
-                    std::cerr << "unexpected character found: '" << start[0] << "' (" << static_cast<int>(start[0]) << ")" << std::endl;
-                    return 0;
+                    // the character itself isn't a token the grammar knows, so the parser reports it where it is
+                    return static_cast<unsigned char>(start[0]);
                 }
 #line 111 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy4:
                     ++YYCURSOR;
 #line 53 "src/FuelScanner.r2c"
                     {
+                        if (braces == 0) header = start;
                         return '[';
                     }
 #line 116 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
@@ -149,6 +237,7 @@ namespace ehb
                     ++YYCURSOR;
 #line 55 "src/FuelScanner.r2c"
                     {
+                        ++braces;
                         return '{';
                     }
 #line 126 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
@@ -156,6 +245,7 @@ namespace ehb
                     ++YYCURSOR;
 #line 56 "src/FuelScanner.r2c"
                     {
+                        if (braces > 0) --braces;
                         return '}';
                     }
 #line 131 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
@@ -190,7 +280,7 @@ namespace ehb
 #line 151 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy20:
                     ++YYCURSOR;
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     goto yy33;
                 yy21 :
 #line 63 "src/FuelScanner.r2c"
@@ -200,7 +290,7 @@ namespace ehb
 #line 159 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy22:
                     ++YYCURSOR;
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     goto yy31;
                 yy23 :
 #line 65 "src/FuelScanner.r2c"
@@ -211,7 +301,7 @@ namespace ehb
                 yy24:
                     ++YYCURSOR;
                     if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     if (yych == '\n') goto yy24;
 #line 66 "src/FuelScanner.r2c"
                     {
@@ -226,12 +316,13 @@ namespace ehb
                     }
 #line 180 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy29:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy3;
                 yy30:
                     ++YYCURSOR;
                     if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                 yy31:
                     if (yych <= '\f')
                     {
@@ -247,7 +338,7 @@ namespace ehb
                 yy32:
                     ++YYCURSOR;
                     if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                 yy33:
                     if (yych <= '9')
                     {
@@ -278,34 +369,25 @@ namespace ehb
                         }
                     }
                 yy34:
+                    // an unterminated block comment ends the input, the cursor never goes past the limit
+                    if (YYLIMIT <= YYCURSOR) return (token = YYCURSOR = YYLIMIT, 0);
                     ++YYCURSOR;
-                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
-                    if (yych == '*') goto yy39;
-                    goto yy34;
+                    YYCURSOR = findAny<'*'>(YYCURSOR, YYLIMIT);
+                    if (YYLIMIT <= YYCURSOR) return (token = YYCURSOR = YYLIMIT, 0);
+                    goto yy39;
                 yy36:
                     ++YYCURSOR;
-                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
-                    if (yych <= '\n')
-                    {
-                        if (yych <= 0x00) goto yy38;
-                        if (yych <= '\t') goto yy36;
-                    }
-                    else
-                    {
-                        if (yych != '\r') goto yy36;
-                    }
-                yy38 :
+                    YYCURSOR = findAny<'\n', '\r', '\0'>(YYCURSOR, YYLIMIT);
 #line 50 "src/FuelScanner.r2c"
                 {
                     continue;
                 }
 #line 240 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy39:
+                    if (YYLIMIT <= YYCURSOR) return (token = YYCURSOR = YYLIMIT, 0);
                     ++YYCURSOR;
-                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) return (token = YYCURSOR = YYLIMIT, 0);
+                    yych = YYPEEK();
                     if (yych != '/') goto yy34;
                     ++YYCURSOR;
 #line 51 "src/FuelScanner.r2c"
@@ -318,12 +400,18 @@ namespace ehb
             }
             else if (state.top() == embedded_statement)
             {
+                // the parser joins consecutive expressions back together so a whole run can go out as one
+                if (const char* end = findAny<'/', ']'>(cursor, limit); end != cursor)
+                {
+                    cursor = end;
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
 
 #line 257 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 {
                     unsigned char yych;
                     if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     if (yych <= 0x1F)
                     {
                         if (yych <= '\n')
@@ -352,7 +440,7 @@ namespace ehb
                         }
                     }
                     ++YYCURSOR;
-                    if ((yych = *YYCURSOR) == '/') goto yy53;
+                    if ((yych = YYPEEK()) == '/') goto yy53;
                 yy45 :
 #line 80 "src/FuelScanner.r2c"
                 {
@@ -360,7 +448,8 @@ namespace ehb
                 }
 #line 285 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy46:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     if (yych == ']') goto yy51;
                     goto yy45;
                 yy47:
@@ -372,10 +461,12 @@ namespace ehb
                 }
 #line 295 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy49:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy48;
                 yy50:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy45;
                 yy51:
                     ++YYCURSOR;
@@ -387,18 +478,7 @@ namespace ehb
 #line 306 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy53:
                     ++YYCURSOR;
-                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
-                    if (yych <= '\n')
-                    {
-                        if (yych <= 0x00) goto yy55;
-                        if (yych <= '\t') goto yy53;
-                    }
-                    else
-                    {
-                        if (yych != '\r') goto yy53;
-                    }
-                yy55 :
+                    YYCURSOR = findAny<'\n', '\r', '\0'>(YYCURSOR, YYLIMIT);
 #line 77 "src/FuelScanner.r2c"
                 {
                     continue;
@@ -409,12 +489,17 @@ namespace ehb
             }
             else if (state.top() == expression_statement)
             {
+                if (const char* end = findAny<'"', '/', ';', '['>(cursor, limit); end != cursor)
+                {
+                    cursor = end;
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
 
 #line 329 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 {
                     unsigned char yych;
                     if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     if (yych <= '!')
                     {
                         if (yych <= '\f')
@@ -446,7 +531,7 @@ namespace ehb
                         }
                     }
                     ++YYCURSOR;
-                    if ((yych = *YYCURSOR) == '/') goto yy71;
+                    if ((yych = YYPEEK()) == '/') goto yy71;
                 yy59 :
 #line 95 "src/FuelScanner.r2c"
                 {
@@ -462,7 +547,8 @@ namespace ehb
                     }
 #line 365 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy62:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     if (yych == '[') goto yy69;
                     goto yy59;
                 yy63:
@@ -482,10 +568,12 @@ namespace ehb
                 }
 #line 380 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy67:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy66;
                 yy68:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy59;
                 yy69:
                     ++YYCURSOR;
@@ -497,18 +585,7 @@ namespace ehb
 #line 391 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy71:
                     ++YYCURSOR;
-                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
-                    yych = *YYCURSOR;
-                    if (yych <= '\n')
-                    {
-                        if (yych <= 0x00) goto yy73;
-                        if (yych <= '\t') goto yy71;
-                    }
-                    else
-                    {
-                        if (yych != '\r') goto yy71;
-                    }
-                yy73 :
+                    YYCURSOR = findAny<'\n', '\r', '\0'>(YYCURSOR, YYLIMIT);
 #line 89 "src/FuelScanner.r2c"
                 {
                     continue;
@@ -519,12 +596,17 @@ namespace ehb
             }
             else if (state.top() == string_literal)
             {
+                if (const char* end = findAny<'"', '\\'>(cursor, limit); end != cursor)
+                {
+                    cursor = end;
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
 
 #line 414 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 {
                     unsigned char yych;
                     if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
-                    yych = *YYCURSOR;
+                    yych = YYPEEK();
                     if (yych <= 0x1F)
                     {
                         if (yych <= '\n')
@@ -568,11 +650,12 @@ namespace ehb
                 }
 #line 446 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy80:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy79;
                 yy81:
                     ++YYCURSOR;
-                    if ((yych = *YYCURSOR) == '.') goto yy84;
+                    if ((yych = YYPEEK()) == '.') goto yy84;
                 yy82 :
 #line 107 "src/FuelScanner.r2c"
                 {
@@ -580,7 +663,8 @@ namespace ehb
                 }
 #line 456 "E:/Programming/Projects/gitea/GameState/build/FuelScanner.cpp"
                 yy83:
-                    yych = *++YYCURSOR;
+                    ++YYCURSOR;
+                    yych = YYPEEK();
                     goto yy82;
                 yy84:
                     ++YYCURSOR;
@@ -596,4 +680,84 @@ namespace ehb
             assert(false);
         }
     }
+
+    void FuelScanner::location(uint32_t& line, uint32_t& column) const
+    {
+        line = 1;
+        column = 1;
+
+        for (const char* itr = content; itr < token; ++itr)
+        {
+            if (*itr == '\n')
+            {
+                ++line;
+                column = 1;
+            }
+            else
+            {
+                ++column;
+            }
+        }
+    }
+
+    bool FuelScanner::resync()
+    {
+        // the parser choked on a top level header, that is as good a place to start over as any
+        if (token == header && token < cursor && token != resumed)
+        {
+            cursor = resumed = token;
+            state = {};
+
+            return true;
+        }
+
+        // offset of itr from the start of its line, or -1 if something other than blanks comes before it
+        const auto indentOf = [this](const char* itr) -> ptrdiff_t {
+            const char* begin = itr;
+
+            while (begin > content && begin[-1] != '\n' && begin[-1] != '\r')
+            {
+                --begin;
+            }
+
+            return std::string_view(begin, itr - begin).find_first_not_of(" \t") == std::string_view::npos ? itr - begin : -1;
+        };
+
+        const ptrdiff_t indent = indentOf(header);
+
+        const char* fallback = nullptr;
+        std::string_view value;
+
+        for (int type; (type = scan(&value)) != 0;)
+        {
+            if (type != '[')
+            {
+                continue;
+            }
+
+            if (braces == 0)
+            {
+                cursor = resumed = token;
+                state = {};
+
+                return true;
+            }
+
+            if (fallback == nullptr && indent >= 0 && indentOf(token) == indent)
+            {
+                fallback = token;
+            }
+        }
+
+        if (fallback != nullptr)
+        {
+            cursor = resumed = header = fallback;
+            braces = 0;
+            state = {};
+
+            return true;
+        }
+
+        return false;
+    }
 } // namespace ehb
@@ -20,18 +20,44 @@
 
 #pragma once
 
-#include <cstring>
+#include <cstddef>
+#include <cstdint>
 #include <stack>
-#include <string>
+#include <string_view>
 
 namespace ehb
 {
     class FuelScanner
     {
     public:
-        FuelScanner(const char* content);
+        /**
+         * content does not need a null terminator, the scanner never reads past content + length
+         *
+         * tokens are views into content so it has to outlive everything the parser builds from them
+         */
+        FuelScanner(const char* content, size_t length);
 
-        int scan(std::string* yylval);
+        int scan(std::string_view* yylval);
+
+        //! line and column of the token scan last returned, both counted from 1
+        void location(uint32_t& line, uint32_t& column) const;
+
+        //! the source text of the token scan last returned, empty at the end of the input
+        std::string_view lastToken() const;
+
+        //! braces opened and not yet closed by the tokens returned so far
+        size_t depth() const;
+
+        /**
+         * after a syntax error, move on to the next block header outside of any braces so a fresh parser can pick
+         * the document up from there
+         *
+         * when the braces never balance out again the next header starting a line at the column the broken top
+         * level block did is taken instead
+         *
+         * @return false if there is no header left to resume at
+         */
+        bool resync();
 
     private:
         enum
@@ -48,11 +74,30 @@ namespace ehb
         const char* cursor;
         const char* limit;
         const char* marker;
+
+        // start of the last token, and of the '[' of the top level block it belongs to
+        const char* token;
+        const char* header;
+
+        // where the last resync put the scanner, it never resumes at the same header twice
+        const char* resumed = nullptr;
+
+        // braces open around the cursor
+        size_t braces = 0;
     };
 
-    inline FuelScanner::FuelScanner(const char* content) :
-        content(content), cursor(content)
+    inline FuelScanner::FuelScanner(const char* content, size_t length) :
+        content(content), cursor(content), limit(content + length), token(content), header(content)
+    {
+    }
+
+    inline std::string_view FuelScanner::lastToken() const
+    {
+        return std::string_view(token, cursor - token);
+    }
+
+    inline size_t FuelScanner::depth() const
     {
-        limit = content + strlen(content);
+        return braces;
     }
 } // namespace ehb
@@ -0,0 +1,769 @@
+
+#include "GasCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace ehb
+{
+    namespace
+    {
+        /*
+         * layout of a compiled document, every section is 4 byte aligned
+         *
+         * integers are written in the byte order of the machine that compiled the entry so it can be read straight
+         * out of the mapping. a cache is never meant to move between machines, but if one does the version reads
+         * back byte swapped on a machine of the other order and every entry is rejected as out of date:
+         *
+         * Header
+         * uint32_t stringOffsets[stringCount + 1]    string i is [offsets[i], offsets[i + 1]) in the string data
+         * char     stringData[stringBytes]           padded to 4 bytes
+         * Block    blocks[blockCount]                block 0 is the document root
+         * Attr     attributes[attributeCount]
+         *
+         * string 0 is always the source path the entry was compiled from
+         */
+        constexpr char MAGIC[4] = {'G', 'A', 'S', 'C'};
+        constexpr uint32_t VERSION = 1;
+
+        constexpr uint32_t byteSwap(uint32_t value)
+        {
+            return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+        }
+
+        // the version doubles as the byte order mark, which only works as long as swapping it changes it
+        static_assert(byteSwap(VERSION) != VERSION, "VERSION has to tell the byte orders apart");
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            int64_t writeTime;
+            uint64_t sourceHash;
+            uint32_t stringCount;
+            uint32_t stringBytes;
+            uint32_t blockCount;
+            uint32_t attributeCount;
+        };
+
+        struct Block
+        {
+            uint32_t name;
+            uint32_t type;
+            uint32_t firstChild;
+            uint32_t childCount;
+            uint32_t firstAttribute;
+            uint32_t attributeCount;
+        };
+
+        struct Attr
+        {
+            uint32_t name;
+            uint32_t type;
+            uint32_t value;
+        };
+
+        /*
+         * layout of a compiled set, same conventions as above including the byte order:
+         *
+         * SetHeader
+         * uint32_t stringOffsets[stringCount + 1]
+         * char     stringData[stringBytes]           padded to 4 bytes
+         * Root     roots[rootCount]
+         * uint32_t messages[messageCount]            strings the caller wants handed back along with the roots
+         * SetBlock blocks[blockCount]
+         * uint32_t children[childCount]              block indices, a block's children are a range in here
+         * Attr     attributes[attributeCount]
+         *
+         * blocks and lists are shared by pointing at the same block or the same range
+         */
+        constexpr char SET_MAGIC[4] = {'G', 'A', 'S', 'S'};
+        constexpr uint32_t SET_VERSION = 2;
+
+        static_assert(byteSwap(SET_VERSION) != SET_VERSION, "SET_VERSION has to tell the byte orders apart");
+        constexpr uint32_t NONE = ~uint32_t(0);
+
+        struct SetHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t key;
+            uint32_t stringCount;
+            uint32_t stringBytes;
+            uint32_t rootCount;
+            uint32_t messageCount;
+            uint32_t blockCount;
+            uint32_t childCount;
+            uint32_t attributeCount;
+        };
+
+        struct Root
+        {
+            uint32_t name;
+            uint32_t block;
+        };
+
+        struct SetBlock
+        {
+            uint32_t name;
+            uint32_t type;
+            uint32_t parent;
+            uint32_t firstChild;
+            uint32_t childCount;
+            uint32_t firstAttribute;
+            uint32_t attributeCount;
+        };
+
+        size_t align4(size_t value)
+        {
+            return (value + 3) & ~size_t(3);
+        }
+
+        class StringTable
+        {
+        public:
+            uint32_t intern(std::string_view value)
+            {
+                const auto itr = index.emplace(std::string(value), static_cast<uint32_t>(offsets.size()));
+
+                if (itr.second)
+                {
+                    offsets.push_back(static_cast<uint32_t>(data.size()));
+                    data.insert(data.end(), value.begin(), value.end());
+                }
+
+                return itr.first->second;
+            }
+
+            std::unordered_map<std::string, uint32_t> index;
+            std::vector<uint32_t> offsets;
+            std::vector<char> data;
+        };
+
+        template <typename T>
+        void append(std::vector<uint8_t>& out, const T* values, size_t count)
+        {
+            const auto bytes = reinterpret_cast<const uint8_t*>(values);
+            out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+        }
+    } // namespace
+
+    GasCache::GasCache(const fs::path& cacheDir) :
+        directory(cacheDir / "gas")
+    {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+    }
+
+    uint64_t GasCache::hash(const void* data, size_t size)
+    {
+        // FNV-1a, plenty for telling two versions of the same file apart
+        uint64_t result = 0xcbf29ce484222325ull;
+
+        for (auto bytes = static_cast<const uint8_t*>(data), end = bytes + size; bytes != end; ++bytes)
+        {
+            result = (result ^ *bytes) * 0x100000001b3ull;
+        }
+
+        return result;
+    }
+
+    fs::path GasCache::entryFileName(const std::string& filename) const
+    {
+        std::ostringstream name;
+        name << std::hex << hash(filename.data(), filename.size()) << ".gasc";
+
+        return directory / name.str();
+    }
+
+    std::unique_ptr<Fuel> GasCache::load(const std::string& filename, int64_t writeTime, const MappedFile* source) const
+    {
+        auto entry = MappedFile::map(entryFileName(filename).string());
+
+        if (!entry || entry->size() < sizeof(Header))
+        {
+            return {};
+        }
+
+        Header header;
+        std::memcpy(&header, entry->data(), sizeof(Header));
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        {
+            return {};
+        }
+
+        if (writeTime != 0)
+        {
+            if (header.writeTime != writeTime)
+            {
+                return {};
+            }
+        }
+        else if (source == nullptr || header.writeTime != 0 || header.sourceHash != hash(source->data(), source->size()))
+        {
+            return {};
+        }
+
+        // two paths hashing to the same entry is unlikely but cheap to rule out, string 0 is the source path
+        const size_t stringsStart = sizeof(Header) + (size_t(header.stringCount) + 1) * sizeof(uint32_t);
+
+        if (header.stringCount == 0 || stringsStart + header.stringBytes > entry->size())
+        {
+            return {};
+        }
+
+        const auto offsets = reinterpret_cast<const uint32_t*>(entry->data() + sizeof(Header));
+        const auto strings = reinterpret_cast<const char*>(entry->data() + stringsStart);
+
+        if (offsets[0] > offsets[1] || offsets[1] > header.stringBytes || std::string_view(strings + offsets[0], offsets[1] - offsets[0]) != filename)
+        {
+            return {};
+        }
+
+        if (auto doc = std::make_unique<Fuel>(); decompile(*entry, *doc))
+        {
+            return doc;
+        }
+
+        return {};
+    }
+
+    void GasCache::store(const std::string& filename, int64_t writeTime, const MappedFile& source, const FuelBlock& doc) const
+    {
+        // the hash is only a fallback for file systems that can't tell us when a file changed
+        const uint64_t sourceHash = writeTime != 0 ? 0 : hash(source.data(), source.size());
+
+        const std::vector<uint8_t> data = compile(doc, filename, writeTime, sourceHash);
+
+        write(entryFileName(filename), data);
+    }
+
+    bool GasCache::write(const fs::path& file, const std::vector<uint8_t>& data)
+    {
+        // several threads can be storing at once, write somewhere private and rename into place
+        std::ostringstream temp;
+        temp << file.string() << '.' << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+        {
+            std::ofstream stream(temp.str(), std::ios::binary | std::ios::trunc);
+
+            if (!stream.is_open() || !stream.write(reinterpret_cast<const char*>(data.data()), data.size()))
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temp.str(), file, ec);
+
+        if (ec)
+        {
+            fs::remove(temp.str(), ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> GasCache::compile(const FuelBlock& root, const std::string& filename, int64_t writeTime, uint64_t sourceHash)
+    {
+        StringTable strings;
+        strings.intern(filename);
+
+        std::vector<Block> blocks;
+        std::vector<Attr> attributes;
+
+        // breadth first so every block's children end up next to each other
+        std::vector<const FuelBlock*> queue = {&root};
+
+        blocks.push_back({strings.intern(root.name()), strings.intern(root.type()), 0, 0, 0, 0});
+
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            const FuelBlock* node = queue[i];
+
+            Block& block = blocks[i];
+
+            block.firstChild = static_cast<uint32_t>(blocks.size());
+            block.childCount = static_cast<uint32_t>(node->eachChild().size());
+            block.firstAttribute = static_cast<uint32_t>(attributes.size());
+            block.attributeCount = node->valueCount();
+
+            for (const Attribute& attr : node->eachAttribute())
+            {
+                attributes.push_back({strings.intern(attr.name), strings.intern(attr.type), strings.intern(attr.value)});
+            }
+
+            for (const FuelBlock* child : node->eachChild())
+            {
+                queue.push_back(child);
+
+                // push_back may move the array so block can't be used past this point
+                blocks.push_back({strings.intern(child->name()), strings.intern(child->type()), 0, 0, 0, 0});
+            }
+        }
+
+        strings.offsets.push_back(static_cast<uint32_t>(strings.data.size()));
+
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.writeTime = writeTime;
+        header.sourceHash = sourceHash;
+        header.stringCount = static_cast<uint32_t>(strings.offsets.size() - 1);
+        header.stringBytes = static_cast<uint32_t>(strings.data.size());
+        header.blockCount = static_cast<uint32_t>(blocks.size());
+        header.attributeCount = static_cast<uint32_t>(attributes.size());
+
+        std::vector<uint8_t> out;
+        out.reserve(sizeof(Header) + strings.offsets.size() * 4 + align4(strings.data.size()) + blocks.size() * sizeof(Block) + attributes.size() * sizeof(Attr));
+
+        append(out, &header, 1);
+        append(out, strings.offsets.data(), strings.offsets.size());
+        append(out, strings.data.data(), strings.data.size());
+        out.resize(align4(out.size()), 0);
+        append(out, blocks.data(), blocks.size());
+        append(out, attributes.data(), attributes.size());
+
+        return out;
+    }
+
+    bool GasCache::decompile(const MappedFile& data, Fuel& doc)
+    {
+        if (data.size() < sizeof(Header))
+        {
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, data.data(), sizeof(Header));
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.stringCount == 0 || header.blockCount == 0)
+        {
+            return false;
+        }
+
+        const size_t offsetsStart = sizeof(Header);
+        const size_t stringsStart = offsetsStart + (size_t(header.stringCount) + 1) * sizeof(uint32_t);
+        const size_t blocksStart = align4(stringsStart + header.stringBytes);
+        const size_t attributesStart = blocksStart + size_t(header.blockCount) * sizeof(Block);
+        const size_t end = attributesStart + size_t(header.attributeCount) * sizeof(Attr);
+
+        if (end != data.size())
+        {
+            return false;
+        }
+
+        // every section is 4 byte aligned and the mapping is page aligned so these can be read in place
+        const auto offsets = reinterpret_cast<const uint32_t*>(data.data() + offsetsStart);
+        const auto stringData = reinterpret_cast<const char*>(data.data() + stringsStart);
+        const auto blocks = reinterpret_cast<const Block*>(data.data() + blocksStart);
+        const auto attributes = reinterpret_cast<const Attr*>(data.data() + attributesStart);
+
+        for (uint32_t i = 0; i < header.stringCount; ++i)
+        {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.stringBytes)
+            {
+                return false;
+            }
+        }
+
+        auto string = [&](uint32_t index) {
+            return index < header.stringCount ? std::string_view(stringData + offsets[index], offsets[index + 1] - offsets[index]) : std::string_view();
+        };
+
+        FuelArena& arena = *doc.mArena;
+        StringPool& pool = StringPool::global();
+
+        // every distinct string is interned or copied into the arena once no matter how many blocks use it
+        std::vector<const std::string*> interned(header.stringCount, nullptr);
+        std::vector<std::string_view> copied(header.stringCount);
+        std::vector<bool> isCopied(header.stringCount, false);
+
+        auto intern = [&](uint32_t index) -> const std::string& {
+            if (index >= header.stringCount)
+            {
+                return StringPool::empty();
+            }
+
+            if (interned[index] == nullptr)
+            {
+                interned[index] = &pool.intern(string(index));
+            }
+
+            return *interned[index];
+        };
+
+        auto copy = [&](uint32_t index) {
+            if (index >= header.stringCount)
+            {
+                return std::string_view();
+            }
+
+            if (!isCopied[index])
+            {
+                copied[index] = arena.copy(string(index));
+                isCopied[index] = true;
+            }
+
+            return copied[index];
+        };
+
+        std::vector<FuelBlock*> nodes(header.blockCount, nullptr);
+        nodes[0] = &doc;
+
+        for (uint32_t i = 0; i < header.blockCount; ++i)
+        {
+            const Block& block = blocks[i];
+            FuelBlock* node = nodes[i];
+
+            // breadth first order means a block is always created by its parent before it is visited
+            if (node == nullptr || block.firstChild < i + 1 || size_t(block.firstChild) + block.childCount > header.blockCount ||
+                size_t(block.firstAttribute) + block.attributeCount > header.attributeCount)
+            {
+                return false;
+            }
+
+            node->mName = &intern(block.name);
+            node->mType = &intern(block.type);
+
+            node->mAttributes.reserve(arena, block.attributeCount);
+
+            for (uint32_t a = block.firstAttribute; a < block.firstAttribute + block.attributeCount; ++a)
+            {
+                node->mAttributes.push_back(arena, Attribute{intern(attributes[a].name), intern(attributes[a].type), copy(attributes[a].value), {}});
+            }
+
+            node->mChildren.reserve(arena, block.childCount);
+
+            for (uint32_t c = block.firstChild; c < block.firstChild + block.childCount; ++c)
+            {
+                if (nodes[c] != nullptr)
+                {
+                    return false;
+                }
+
+                nodes[c] = node->createChild(StringPool::empty(), StringPool::empty());
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> GasCache::compileSet(const std::vector<std::pair<std::string_view, const FuelBlock*>>& roots, uint64_t key, const std::vector<std::string>& messages)
+    {
+        StringTable strings;
+
+        std::vector<Root> rootTable;
+        std::vector<uint32_t> messageTable;
+        std::vector<SetBlock> blocks;
+        std::vector<uint32_t> children;
+        std::vector<Attr> attributes;
+
+        std::vector<const FuelBlock*> queue;
+        std::unordered_map<const FuelBlock*, uint32_t> blockIndex;
+
+        // a shared list is the very same array in both blocks so its address identifies it, the value is the range written for it
+        std::unordered_map<const void*, std::pair<uint32_t, uint32_t>> childRanges;
+        std::unordered_map<const void*, std::pair<uint32_t, uint32_t>> attributeRanges;
+
+        auto add = [&](const FuelBlock* node) {
+            const auto itr = blockIndex.emplace(node, static_cast<uint32_t>(queue.size()));
+
+            if (itr.second)
+            {
+                queue.push_back(node);
+                blocks.push_back({strings.intern(node->name()), strings.intern(node->type()), NONE, 0, 0, 0, 0});
+            }
+
+            return itr.first->second;
+        };
+
+        for (const auto& root : roots)
+        {
+            rootTable.push_back({strings.intern(root.first), add(root.second)});
+        }
+
+        for (const auto& message : messages)
+        {
+            messageTable.push_back(strings.intern(message));
+        }
+
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            const FuelBlock* node = queue[i];
+
+            const auto& nodeChildren = node->eachChild();
+            const auto& nodeAttributes = node->eachAttribute();
+
+            const uint32_t childCount = static_cast<uint32_t>(nodeChildren.size());
+            const uint32_t attributeCount = node->valueCount();
+
+            std::pair<uint32_t, uint32_t> childRange = {0, 0};
+            std::pair<uint32_t, uint32_t> attributeRange = {0, 0};
+
+            if (childCount != 0)
+            {
+                const auto itr = childRanges.emplace(nodeChildren.begin(), std::make_pair(static_cast<uint32_t>(children.size()), childCount));
+
+                // a list that grew in place after being shared is the same array with more in it, that needs a range of its own
+                if (childRange = itr.first->second; !itr.second && childRange.second != childCount)
+                {
+                    childRange = {static_cast<uint32_t>(children.size()), childCount};
+                }
+
+                if (childRange.first == children.size())
+                {
+                    for (const FuelBlock* child : nodeChildren)
+                    {
+                        // add may grow blocks but never children
+                        children.push_back(add(child));
+                    }
+                }
+            }
+
+            if (attributeCount != 0)
+            {
+                const auto itr = attributeRanges.emplace(nodeAttributes.begin(), std::make_pair(static_cast<uint32_t>(attributes.size()), attributeCount));
+
+                if (attributeRange = itr.first->second; !itr.second && attributeRange.second != attributeCount)
+                {
+                    attributeRange = {static_cast<uint32_t>(attributes.size()), attributeCount};
+                }
+
+                if (attributeRange.first == attributes.size())
+                {
+                    for (const Attribute& attr : nodeAttributes)
+                    {
+                        attributes.push_back({strings.intern(attr.name), strings.intern(attr.type), strings.intern(attr.value)});
+                    }
+                }
+            }
+
+            SetBlock& block = blocks[i];
+
+            block.firstChild = childRange.first;
+            block.childCount = childRange.second;
+            block.firstAttribute = attributeRange.first;
+            block.attributeCount = attributeRange.second;
+        }
+
+        // a shared block keeps the parent it was first built under, which is in the set as long as its template is
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            if (const auto itr = blockIndex.find(queue[i]->parent()); itr != blockIndex.end())
+            {
+                blocks[i].parent = itr->second;
+            }
+        }
+
+        strings.offsets.push_back(static_cast<uint32_t>(strings.data.size()));
+
+        SetHeader header;
+        std::memcpy(header.magic, SET_MAGIC, sizeof(SET_MAGIC));
+        header.version = SET_VERSION;
+        header.key = key;
+        header.stringCount = static_cast<uint32_t>(strings.offsets.size() - 1);
+        header.stringBytes = static_cast<uint32_t>(strings.data.size());
+        header.rootCount = static_cast<uint32_t>(rootTable.size());
+        header.messageCount = static_cast<uint32_t>(messageTable.size());
+        header.blockCount = static_cast<uint32_t>(blocks.size());
+        header.childCount = static_cast<uint32_t>(children.size());
+        header.attributeCount = static_cast<uint32_t>(attributes.size());
+
+        std::vector<uint8_t> out;
+        out.reserve(sizeof(SetHeader) + strings.offsets.size() * 4 + align4(strings.data.size()) + rootTable.size() * sizeof(Root) + messageTable.size() * sizeof(uint32_t) + blocks.size() * sizeof(SetBlock) +
+                    children.size() * sizeof(uint32_t) + attributes.size() * sizeof(Attr));
+
+        append(out, &header, 1);
+        append(out, strings.offsets.data(), strings.offsets.size());
+        append(out, strings.data.data(), strings.data.size());
+        out.resize(align4(out.size()), 0);
+        append(out, rootTable.data(), rootTable.size());
+        append(out, messageTable.data(), messageTable.size());
+        append(out, blocks.data(), blocks.size());
+        append(out, children.data(), children.size());
+        append(out, attributes.data(), attributes.size());
+
+        return out;
+    }
+
+    bool GasCache::decompileSet(const MappedFile& data, uint64_t key, FuelArena& arena, std::vector<std::pair<std::string_view, FuelBlock*>>& roots, std::vector<std::string>* messages)
+    {
+        if (data.size() < sizeof(SetHeader))
+        {
+            return false;
+        }
+
+        SetHeader header;
+        std::memcpy(&header, data.data(), sizeof(SetHeader));
+
+        if (std::memcmp(header.magic, SET_MAGIC, sizeof(SET_MAGIC)) != 0 || header.version != SET_VERSION || header.key != key)
+        {
+            return false;
+        }
+
+        const size_t offsetsStart = sizeof(SetHeader);
+        const size_t stringsStart = offsetsStart + (size_t(header.stringCount) + 1) * sizeof(uint32_t);
+        const size_t rootsStart = align4(stringsStart + header.stringBytes);
+        const size_t messagesStart = rootsStart + size_t(header.rootCount) * sizeof(Root);
+        const size_t blocksStart = messagesStart + size_t(header.messageCount) * sizeof(uint32_t);
+        const size_t childrenStart = blocksStart + size_t(header.blockCount) * sizeof(SetBlock);
+        const size_t attributesStart = childrenStart + size_t(header.childCount) * sizeof(uint32_t);
+        const size_t end = attributesStart + size_t(header.attributeCount) * sizeof(Attr);
+
+        if (end != data.size())
+        {
+            return false;
+        }
+
+        const auto offsets = reinterpret_cast<const uint32_t*>(data.data() + offsetsStart);
+        const auto stringData = reinterpret_cast<const char*>(data.data() + stringsStart);
+        const auto rootTable = reinterpret_cast<const Root*>(data.data() + rootsStart);
+        const auto messageTable = reinterpret_cast<const uint32_t*>(data.data() + messagesStart);
+        const auto blocks = reinterpret_cast<const SetBlock*>(data.data() + blocksStart);
+        const auto children = reinterpret_cast<const uint32_t*>(data.data() + childrenStart);
+        const auto attributes = reinterpret_cast<const Attr*>(data.data() + attributesStart);
+
+        for (uint32_t i = 0; i < header.stringCount; ++i)
+        {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.stringBytes)
+            {
+                return false;
+            }
+        }
+
+        auto string = [&](uint32_t index) {
+            return index < header.stringCount ? std::string_view(stringData + offsets[index], offsets[index + 1] - offsets[index]) : std::string_view();
+        };
+
+        StringPool& pool = StringPool::global();
+
+        std::vector<const std::string*> interned(header.stringCount, nullptr);
+        std::vector<std::string_view> copied(header.stringCount);
+        std::vector<bool> isCopied(header.stringCount, false);
+
+        auto intern = [&](uint32_t index) -> const std::string& {
+            if (index >= header.stringCount)
+            {
+                return StringPool::empty();
+            }
+
+            if (interned[index] == nullptr)
+            {
+                interned[index] = &pool.intern(string(index));
+            }
+
+            return *interned[index];
+        };
+
+        auto copy = [&](uint32_t index) {
+            if (index >= header.stringCount)
+            {
+                return std::string_view();
+            }
+
+            if (!isCopied[index])
+            {
+                copied[index] = arena.copy(string(index));
+                isCopied[index] = true;
+            }
+
+            return copied[index];
+        };
+
+        // every block exists before any list is filled in since a shared child can come before its parent
+        std::vector<FuelBlock*> nodes(header.blockCount);
+
+        for (uint32_t i = 0; i < header.blockCount; ++i)
+        {
+            FuelBlock* node = new (arena.allocate(sizeof(FuelBlock), alignof(FuelBlock))) FuelBlock(&arena);
+
+            node->mName = &intern(blocks[i].name);
+            node->mType = &intern(blocks[i].type);
+
+            nodes[i] = node;
+        }
+
+        // the first block to use a range fills it in, every other one shares its list
+        std::unordered_map<uint64_t, const FuelBlock*> childOwners;
+        std::unordered_map<uint64_t, const FuelBlock*> attributeOwners;
+
+        for (uint32_t i = 0; i < header.blockCount; ++i)
+        {
+            const SetBlock& block = blocks[i];
+            FuelBlock* node = nodes[i];
+
+            if ((block.parent != NONE && block.parent >= header.blockCount) || size_t(block.firstChild) + block.childCount > header.childCount ||
+                size_t(block.firstAttribute) + block.attributeCount > header.attributeCount)
+            {
+                return false;
+            }
+
+            node->mParent = block.parent != NONE ? nodes[block.parent] : nullptr;
+
+            if (block.childCount != 0)
+            {
+                if (const auto owner = childOwners.emplace(uint64_t(block.firstChild) << 32 | block.childCount, node); !owner.second)
+                {
+                    node->mChildren.share(owner.first->second->mChildren);
+                }
+                else
+                {
+                    node->mChildren.reserve(arena, block.childCount);
+
+                    for (uint32_t c = block.firstChild; c < block.firstChild + block.childCount; ++c)
+                    {
+                        if (children[c] >= header.blockCount)
+                        {
+                            return false;
+                        }
+
+                        node->mChildren.push_back(arena, nodes[children[c]]);
+                    }
+                }
+            }
+
+            if (block.attributeCount != 0)
+            {
+                if (const auto owner = attributeOwners.emplace(uint64_t(block.firstAttribute) << 32 | block.attributeCount, node); !owner.second)
+                {
+                    node->mAttributes.share(owner.first->second->mAttributes);
+                }
+                else
+                {
+                    node->mAttributes.reserve(arena, block.attributeCount);
+
+                    for (uint32_t a = block.firstAttribute; a < block.firstAttribute + block.attributeCount; ++a)
+                    {
+                        node->mAttributes.push_back(arena, Attribute{intern(attributes[a].name), intern(attributes[a].type), copy(attributes[a].value), {}});
+                    }
+                }
+            }
+        }
+
+        roots.reserve(roots.size() + header.rootCount);
+
+        for (uint32_t i = 0; i < header.rootCount; ++i)
+        {
+            if (rootTable[i].block >= header.blockCount)
+            {
+                return false;
+            }
+
+            roots.emplace_back(string(rootTable[i].name), nodes[rootTable[i].block]);
+        }
+
+        for (uint32_t i = 0; messages && i < header.messageCount; ++i)
+        {
+            messages->emplace_back(string(messageTable[i]));
+        }
+
+        return true;
+    }
+} // namespace ehb
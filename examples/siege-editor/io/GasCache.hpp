@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "Fuel.hpp"
+#include "MappedFile.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    /**
+     * on disk cache of parsed gas files in a compact binary form
+     *
+     * a compiled document is a header, an interned string table and two flat arrays, one of blocks and one of
+     * attributes, that reference each other and the strings by index. blocks are laid out breadth first so the
+     * children of every block are contiguous and the whole tree can be rebuilt in one pass without re-running
+     * the scanner or the parser
+     *
+     * entries are keyed by the source path and validated against the source write time when the file system
+     * knows it, otherwise against a hash of the source text
+     */
+    class GasCache
+    {
+    public:
+        explicit GasCache(const fs::path& cacheDir);
+
+        /**
+         * @param writeTime write time of the source as reported by IFileSys::lastWriteTime, 0 if unknown
+         * @param source the source text, only needed (and only hashed) when writeTime is 0
+         * @return the cached document or nullptr when there is no valid entry for the source
+         */
+        std::unique_ptr<Fuel> load(const std::string& filename, int64_t writeTime, const MappedFile* source) const;
+
+        //! write doc as the entry for filename, failures are silent since the cache is only an optimization
+        void store(const std::string& filename, int64_t writeTime, const MappedFile& source, const FuelBlock& doc) const;
+
+        //! serialize a parsed tree, the source stamp is filled in by the caller
+        static std::vector<uint8_t> compile(const FuelBlock& root, const std::string& filename, int64_t writeTime, uint64_t sourceHash);
+
+        //! rebuild a tree from compiled data, returns false if the data is truncated or not a compiled document
+        static bool decompile(const MappedFile& data, Fuel& doc);
+
+        static uint64_t hash(const void* data, size_t size);
+
+        /**
+         * serialize a set of named trees that may share blocks and lists with each other, as the ones
+         * FuelBlock::overlay builds do. whatever is shared is written once and comes back shared
+         *
+         * @param key whatever the caller needs the set to be valid for, decompileSet only accepts the same key
+         * @param messages stored as they are and handed back by decompileSet, for whatever went wrong building the set
+         */
+        static std::vector<uint8_t> compileSet(const std::vector<std::pair<std::string_view, const FuelBlock*>>& roots, uint64_t key, const std::vector<std::string>& messages = {});
+
+        /**
+         * rebuild a set written by compileSet into arena, the names point into data
+         *
+         * @return false if the data is truncated, not a compiled set or was compiled with another key
+         */
+        static bool decompileSet(const MappedFile& data, uint64_t key, FuelArena& arena, std::vector<std::pair<std::string_view, FuelBlock*>>& roots, std::vector<std::string>* messages = nullptr);
+
+        //! write data to file through a temporary so a reader never maps a half written file, false on failure
+        static bool write(const fs::path& file, const std::vector<uint8_t>& data);
+
+    private:
+        fs::path entryFileName(const std::string& filename) const;
+
+    private:
+        fs::path directory;
+    };
+} // namespace ehb
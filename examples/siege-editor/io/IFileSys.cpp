@@ -0,0 +1,130 @@
+
+#include "IFileSys.hpp"
+#include "GasCache.hpp"
+#include "ParallelFor.hpp"
+
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace ehb
+{
+    void IFileSys::setGasCache(std::shared_ptr<GasCache> cache)
+    {
+        gasCache = std::move(cache);
+    }
+
+    std::unique_ptr<Fuel> IFileSys::loadGasFile(const std::string& file)
+    {
+        int64_t writeTime = 0;
+        InputView view;
+
+        if (auto doc = loadCachedGasFile(file, writeTime, view))
+        {
+            return doc;
+        }
+
+        if (view)
+        {
+            std::vector<FuelDiagnostic> diagnostics;
+
+            if (auto doc = std::make_unique<Fuel>(); doc->load(*view, FuelRecovery::NextBlock, &diagnostics))
+            {
+                if (reportDiagnostics(file, diagnostics) && gasCache)
+                {
+                    gasCache->store(file, writeTime, *view, *doc);
+                }
+
+                return doc;
+            }
+        }
+
+        return {};
+    }
+
+    bool IFileSys::reportDiagnostics(const std::string& file, const std::vector<FuelDiagnostic>& diagnostics)
+    {
+        if (diagnostics.empty())
+        {
+            return true;
+        }
+
+        if (auto log = spdlog::get("log"))
+        {
+            for (const auto& diagnostic : diagnostics)
+            {
+                log->warn("{}:{}:{}: {}", file, diagnostic.line, diagnostic.column, diagnostic.message);
+            }
+        }
+
+        return false;
+    }
+
+    std::unique_ptr<Fuel> IFileSys::loadCachedGasFile(const std::string& file, int64_t& writeTime, InputView& view)
+    {
+        // when the file system knows write times a valid entry saves opening the source at all
+        writeTime = gasCache ? lastWriteTime(file) : 0;
+
+        if (gasCache && writeTime != 0)
+        {
+            if (auto doc = gasCache->load(file, writeTime, nullptr))
+            {
+                return doc;
+            }
+        }
+
+        if (view = createInputView(file); view && gasCache && writeTime == 0)
+        {
+            return gasCache->load(file, writeTime, view.get());
+        }
+
+        return {};
+    }
+
+    FuelBatch IFileSys::loadGasBatch(const std::vector<std::string>& files, unsigned maxThreads)
+    {
+        FuelBatch batch(files.size(), maxThreads);
+
+        parallelForWorkers(files.size(), [&](unsigned worker, size_t i) {
+            int64_t writeTime = 0;
+            InputView view;
+
+            if (auto doc = loadCachedGasFile(files[i], writeTime, view))
+            {
+                batch.adopt(i, std::move(doc));
+            }
+            else if (view)
+            {
+                std::vector<FuelDiagnostic> diagnostics;
+
+                if (batch.parseDocument(worker, i, *view, FuelRecovery::NextBlock, &diagnostics) && reportDiagnostics(files[i], diagnostics) && gasCache)
+                {
+                    gasCache->store(files[i], writeTime, *view, *batch[i]);
+                }
+            }
+        }, maxThreads);
+
+        return batch;
+    }
+
+    bool IFileSys::readGasFile(const std::string& file, FuelHandler& handler)
+    {
+        if (auto view = createInputView(file))
+        {
+            std::vector<FuelDiagnostic> diagnostics;
+
+            const bool result = readFuel(*view, handler, FuelRecovery::NextBlock, &diagnostics);
+
+            reportDiagnostics(file, diagnostics);
+
+            return result;
+        }
+
+        if (auto log = spdlog::get("log"))
+        {
+            log->warn("{} could not be opened", file);
+        }
+
+        return false;
+    }
+} // namespace ehb
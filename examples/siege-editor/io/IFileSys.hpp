@@ -2,12 +2,16 @@
 #pragma once
 
 #include "Fuel.hpp"
+#include "FuelBatch.hpp"
+#include "FuelReader.hpp"
+#include "MappedFile.hpp"
 #include <algorithm>
 #include <functional>
 #include <istream>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #ifdef WIN32
 #    include <filesystem>
@@ -23,6 +27,7 @@ namespace ehb
     typedef std::unique_ptr<std::istream> InputStream;
 
     class IConfig;
+    class GasCache;
     class IFileSys
     {
     public:
@@ -32,15 +37,64 @@ namespace ehb
 
         virtual InputStream createInputStream(const std::string& filename) = 0;
 
+        //! @return a read-only view of the whole file, implementations that can map their files should override this
+        virtual InputView createInputView(const std::string& filename);
+
         virtual FileList getFiles() const = 0;
         virtual FileList getDirectoryContents(const std::string& directory) const = 0;
 
+        //! @return every file and directory whose path starts with prefix, the default filters getFiles()
+        virtual FileList getFilesUnder(const std::string& prefix) const;
+
+        //! @return every .gas file under directory in sorted order
+        std::vector<std::string> gasFilesUnder(const std::string& directory) const;
+
+        //! @return when the file was last written in implementation defined units, 0 if unknown, only ever compared for equality
+        virtual int64_t lastWriteTime(const std::string& filename) const;
+
+        //! route every gas load through a compiled cache so unchanged files skip parsing, nullptr turns it off
+        void setGasCache(std::shared_ptr<GasCache> cache);
+
+        /**
+         * safe to call concurrently as long as createInputView is
+         *
+         * a syntax error only costs the top level block it is in, it gets logged with its position and the
+         * document is kept out of the gas cache so it is looked at again next time
+         */
         std::unique_ptr<Fuel> loadGasFile(const std::string& file);
 
+        /**
+         * stream a gas file through handler without building a document, the gas cache is not consulted
+         *
+         * syntax errors are recovered from and logged the same way loadGasFile does it, so the return is only
+         * false, and logged, when the file can't be opened
+         */
+        bool readGasFile(const std::string& file, FuelHandler& handler);
+
         void eachGasFile(const std::string& directory, std::function<void(const std::string&, std::unique_ptr<Fuel>)> func);
+
+        /**
+         * load every file in one FuelBatch, document i is files[i] or nullptr if it is missing
+         *
+         * syntax errors are recovered from and logged the same way loadGasFile does it
+         *
+         * the files are read and parsed on a bounded pool of threads, each of which builds into its own arena instead
+         * of one per document, and the result can be kept around as a whole
+         */
+        FuelBatch loadGasBatch(const std::vector<std::string>& files, unsigned maxThreads = 0);
+
+    private:
+        //! the gas cache lookup shared by every loader, on a miss view holds the source if it exists
+        std::unique_ptr<Fuel> loadCachedGasFile(const std::string& file, int64_t& writeTime, InputView& view);
+
+        //! log what a recovering parse of file ran into, @return true if it was clean
+        static bool reportDiagnostics(const std::string& file, const std::vector<FuelDiagnostic>& diagnostics);
+
+    private:
+        std::shared_ptr<GasCache> gasCache;
     };
 
-    inline std::string convertToLowerCase(const std::string& str)
+    inline std::string convertToLowerCase(std::string_view str)
     {
         std::string lowcase_str(str);
         std::transform(std::begin(lowcase_str), std::end(lowcase_str), std::begin(lowcase_str), ::tolower);
@@ -73,42 +127,64 @@ namespace ehb
         return convertToLowerCase(getFileExtension(filename));
     }
 
-    inline std::unique_ptr<Fuel> IFileSys::loadGasFile(const std::string& file)
+    //! collect the range of a sorted file list that shares the given prefix in O(log n + k)
+    inline FileList filesWithPrefix(const FileList& files, const std::string& prefix)
+    {
+        FileList result;
+
+        for (auto itr = files.lower_bound(prefix); itr != files.end() && itr->compare(0, prefix.size(), prefix) == 0; ++itr)
+        {
+            result.emplace_hint(result.end(), *itr);
+        }
+
+        return result;
+    }
+
+    inline FileList IFileSys::getFilesUnder(const std::string& prefix) const
+    {
+        return filesWithPrefix(getFiles(), prefix);
+    }
+
+    inline InputView IFileSys::createInputView(const std::string& filename)
     {
-        if (auto stream = createInputStream(file))
+        if (auto stream = createInputStream(filename))
         {
-            if (auto doc = std::make_unique<Fuel>(); doc->load(*stream))
+            return MappedFile::fromStream(*stream);
+        }
+
+        return {};
+    }
+
+    inline std::vector<std::string> IFileSys::gasFilesUnder(const std::string& directory) const
+    {
+        std::vector<std::string> result;
+
+        for (const auto& filename : getFilesUnder(directory))
+        {
+            if (getLowerCaseFileExtension(filename) == ".gas")
             {
-                return doc;
+                result.emplace_back(filename);
             }
         }
 
-        return {};
+        return result;
+    }
+
+    inline int64_t IFileSys::lastWriteTime(const std::string& /*filename*/) const
+    {
+        return 0;
     }
 
     inline void IFileSys::eachGasFile(const std::string& directory, std::function<void(const std::string&, std::unique_ptr<Fuel>)> func)
     {
-        for (const auto& filename : getFiles())
+        for (const auto& filename : getFilesUnder(directory))
         {
             if (getLowerCaseFileExtension(filename) == ".gas")
             {
-                if (filename.find(directory) == 0)
+                // loadGasFile already logged why a file it returns nothing for didn't load
+                if (auto doc = loadGasFile(filename))
                 {
-                    if (auto stream = createInputStream(filename))
-                    {
-                        if (auto doc = std::make_unique<Fuel>(); doc->load(*stream))
-                        {
-                            func(filename, std::move(doc));
-                        }
-                        else
-                        {
-                            // log->error("{}: could not parse", filename);
-                        }
-                    }
-                    else
-                    {
-                        // log->error("{}: could not create input stream", filename);
-                    }
+                    func(filename, std::move(doc));
                 }
             }
         }
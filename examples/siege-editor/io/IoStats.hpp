@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ehb
+{
+    /**
+     * process wide counters for what the file systems hand out, bumped by each IFileSys implementation
+     * whenever it opens a stream or a view for a caller
+     *
+     * these are cheap relaxed increments so they stay on all the time, the startup profiler diffs them per phase
+     */
+    struct IoStats
+    {
+        std::atomic<uint64_t> filesOpened{0};
+        std::atomic<uint64_t> bytesRead{0};
+
+        static IoStats& global();
+
+        static void recordFile(uint64_t bytes);
+    };
+
+    inline IoStats& IoStats::global()
+    {
+        static IoStats stats;
+        return stats;
+    }
+
+    inline void IoStats::recordFile(uint64_t bytes)
+    {
+        IoStats& stats = global();
+
+        stats.filesOpened.fetch_add(1, std::memory_order_relaxed);
+        stats.bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    }
+} // namespace ehb
@@ -0,0 +1,234 @@
+
+#include "LayeredFileSys.hpp"
+#include "LocalFileSys.hpp"
+#include "TankFileSys.hpp"
+#include "cfg/IConfig.hpp"
+
+#include <sstream>
+
+namespace ehb
+{
+    namespace
+    {
+        std::string normalizePath(const std::string& path)
+        {
+            std::string result = convertToLowerCase(path);
+
+            std::replace(result.begin(), result.end(), '\\', '/');
+
+            if (result.empty() || result.front() != '/')
+            {
+                result.insert(result.begin(), '/');
+            }
+
+            if (result.size() > 1 && result.back() == '/')
+            {
+                result.pop_back();
+            }
+
+            return result;
+        }
+
+        std::string parentPath(const std::string& path)
+        {
+            const auto pos = path.rfind('/');
+
+            return pos == 0 || pos == std::string::npos ? "/" : path.substr(0, pos);
+        }
+
+        bool isTank(const fs::path& path)
+        {
+            const auto ext = getLowerCaseFileExtension(path.string());
+
+            return ext == ".dsres" || ext == ".dsmap";
+        }
+    } // namespace
+
+    void LayeredFileSys::init(IConfig& config)
+    {
+        log = spdlog::get("log");
+
+        layers.clear();
+
+        cacheDir = config.getString("cache-dir");
+
+        // getString returns its default argument by reference for a missing key, a temporary that is gone before it
+        // could be used, so everything read here is copied
+        if (const std::string bits = config.getString("bits"); !bits.empty())
+        {
+            mount(bits);
+        }
+
+        mountPaths(config.getString("mod_paths"));
+
+        // fall back to the retail layout of the install when no explicit paths were given
+        const std::string installPath = config.getString("ds-install-path");
+
+        if (const std::string mapPaths = config.getString("map_paths"); !mapPaths.empty())
+        {
+            mountPaths(mapPaths);
+        }
+        else if (!installPath.empty())
+        {
+            mount(fs::path(installPath) / "Maps");
+        }
+
+        if (const std::string resPaths = config.getString("res_paths"); !resPaths.empty())
+        {
+            mountPaths(resPaths);
+        }
+        else if (!installPath.empty())
+        {
+            mount(fs::path(installPath) / "Resources");
+        }
+
+        buildIndex();
+
+        log->info("LayeredFileSys: {} layers, {} entries", layers.size(), entries.size());
+    }
+
+    bool LayeredFileSys::mount(const fs::path& path)
+    {
+        std::error_code ec;
+
+        if (fs::is_regular_file(path, ec) && isTank(path))
+        {
+            if (auto tank = std::make_unique<TankFileSys>(); tank->open(path.string()))
+            {
+                layers.emplace_back(std::move(tank));
+                return true;
+            }
+
+            log->warn("LayeredFileSys: could not open archive {}", path.string());
+            return false;
+        }
+
+        if (!fs::is_directory(path, ec))
+        {
+            log->warn("LayeredFileSys: {} is neither a directory nor a tank archive", path.string());
+            return false;
+        }
+
+        // a directory holding archives mounts each of them, otherwise it is a tree of loose files
+        std::vector<std::unique_ptr<TankFileSys>> tanks;
+
+        for (const auto& itr : fs::directory_iterator(path, ec))
+        {
+            if (fs::is_regular_file(itr.path(), ec) && isTank(itr.path()))
+            {
+                if (auto tank = std::make_unique<TankFileSys>(); tank->open(itr.path().string()))
+                {
+                    tanks.emplace_back(std::move(tank));
+                }
+                else
+                {
+                    log->warn("LayeredFileSys: could not open archive {}", itr.path().string());
+                }
+            }
+        }
+
+        if (tanks.empty())
+        {
+            layers.emplace_back(std::make_unique<LocalFileSys>(path, cacheDir));
+            return true;
+        }
+
+        std::stable_sort(tanks.begin(), tanks.end(), [](const auto& lhs, const auto& rhs) { return lhs->priority() > rhs->priority(); });
+
+        for (auto& tank : tanks)
+        {
+            layers.emplace_back(std::move(tank));
+        }
+
+        return true;
+    }
+
+    void LayeredFileSys::mountPaths(const std::string& paths)
+    {
+        std::istringstream stream(paths);
+
+        for (std::string path; std::getline(stream, path, ';');)
+        {
+            if (!path.empty())
+            {
+                mount(path);
+            }
+        }
+    }
+
+    void LayeredFileSys::buildIndex()
+    {
+        files.clear();
+        entries.clear();
+        directories.clear();
+
+        for (const auto& layer : layers)
+        {
+            for (const auto& entry : layer->getFiles())
+            {
+                std::string path = normalizePath(entry);
+
+                // layers are walked highest priority first so the first layer to claim a path owns it
+                if (files.emplace(path, layer.get()).second)
+                {
+                    directories[parentPath(path)].emplace(path);
+                    entries.emplace(std::move(path));
+                }
+            }
+        }
+    }
+
+    IFileSys* LayeredFileSys::find(const std::string& filename) const
+    {
+        const auto itr = files.find(normalizePath(filename));
+
+        return itr != files.end() ? itr->second : nullptr;
+    }
+
+    InputStream LayeredFileSys::createInputStream(const std::string& filename)
+    {
+        if (IFileSys* layer = find(filename))
+        {
+            return layer->createInputStream(filename);
+        }
+
+        return {};
+    }
+
+    InputView LayeredFileSys::createInputView(const std::string& filename)
+    {
+        if (IFileSys* layer = find(filename))
+        {
+            return layer->createInputView(filename);
+        }
+
+        return {};
+    }
+
+    FileList LayeredFileSys::getFiles() const
+    {
+        return entries;
+    }
+
+    FileList LayeredFileSys::getFilesUnder(const std::string& prefix) const
+    {
+        return filesWithPrefix(entries, prefix);
+    }
+
+    FileList LayeredFileSys::getDirectoryContents(const std::string& directory) const
+    {
+        const auto itr = directories.find(normalizePath(directory));
+
+        return itr != directories.end() ? itr->second : FileList();
+    }
+
+    int64_t LayeredFileSys::lastWriteTime(const std::string& filename) const
+    {
+        if (IFileSys* layer = find(filename))
+        {
+            return layer->lastWriteTime(filename);
+        }
+
+        return 0;
+    }
+} // namespace ehb
@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include "IFileSys.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace ehb
+{
+    /**
+     * stacks several file systems on top of each other the same way the game does:
+     * loose bits win over mod archives which win over retail map and resource archives
+     *
+     * every layer is walked once during init() and the result is flattened into a single index
+     * that maps a file to the layer that owns it, so opening a file is one hash probe instead of
+     * asking each layer in turn
+     */
+    class LayeredFileSys : public IFileSys
+    {
+    public:
+        LayeredFileSys() = default;
+
+        virtual ~LayeredFileSys() = default;
+
+        //! mounts bits, mod_paths, map_paths and res_paths (in that priority) and builds the index
+        virtual void init(IConfig& config) override;
+
+        virtual InputStream createInputStream(const std::string& filename) override;
+        virtual InputView createInputView(const std::string& filename) override;
+
+        virtual FileList getFiles() const override;
+        virtual FileList getDirectoryContents(const std::string& directory) const override;
+        virtual FileList getFilesUnder(const std::string& prefix) const override;
+
+        virtual int64_t lastWriteTime(const std::string& filename) const override;
+
+    private:
+        //! mount a directory of loose files or a single .dsres / .dsmap archive below all current layers
+        bool mount(const fs::path& path);
+
+        //! mount each entry of a semicolon separated path list from the config
+        void mountPaths(const std::string& paths);
+
+        void buildIndex();
+
+        IFileSys* find(const std::string& filename) const;
+
+    private:
+        // highest priority first
+        std::vector<std::unique_ptr<IFileSys>> layers;
+
+        // loose layers persist their file index here
+        fs::path cacheDir;
+
+        std::unordered_map<std::string, IFileSys*> files;
+
+        FileList entries;
+        std::unordered_map<std::string, FileList> directories;
+
+        std::shared_ptr<spdlog::logger> log;
+    };
+} // namespace ehb
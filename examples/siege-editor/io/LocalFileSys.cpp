@@ -1,22 +1,38 @@
 
 #include "LocalFileSys.hpp"
+#include "IoStats.hpp"
 #include "cfg/IConfig.hpp"
 
 #include <algorithm>
+#include <charconv>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 namespace ehb
 {
+    LocalFileSys::LocalFileSys(const fs::path& bitsDir, const fs::path& cacheDir) :
+        bitsDir(bitsDir), cacheDir(cacheDir)
+    {
+        log = spdlog::get("log");
+    }
+
     void LocalFileSys::init(IConfig& config)
     {
         log = spdlog::get("log");
 
         bitsDir = config.getString("bits");
+        cacheDir = config.getString("cache-dir");
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        indexed = false;
+        entries.clear();
+        directories.clear();
     }
 
-    InputStream LocalFileSys::createInputStream(const std::string& filename_)
+    fs::path LocalFileSys::resolve(const std::string& filename_) const
     {
         if (bitsDir.empty())
         {
@@ -30,69 +46,373 @@ namespace ehb
             filename.erase(0, 1);
         }
 
-        auto path = bitsDir / filename;
+        return bitsDir / filename;
+    }
+
+    InputStream LocalFileSys::createInputStream(const std::string& filename)
+    {
+        const fs::path path = resolve(filename);
 
-        if (auto stream = std::make_unique<std::ifstream>(bitsDir / filename, std::ios_base::binary); stream->is_open())
+        if (auto stream = std::make_unique<std::ifstream>(path, std::ios_base::binary); stream->is_open())
         {
+            std::error_code ec;
+            const auto size = fs::file_size(path, ec);
+
+            IoStats::recordFile(ec ? 0 : size);
+
             return stream;
         }
 
         return InputStream();
     }
 
+    InputView LocalFileSys::createInputView(const std::string& filename)
+    {
+        auto view = MappedFile::map(resolve(filename).string());
+
+        if (view)
+        {
+            IoStats::recordFile(view->size());
+        }
+
+        return view;
+    }
+
     FileList LocalFileSys::getFiles() const
     {
+        ensureIndex();
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        return entries;
+    }
+
+    FileList LocalFileSys::getDirectoryContents(const std::string& directory_) const
+    {
+        std::string directory = convertToLowerCase(directory_);
+
+        std::replace(directory.begin(), directory.end(), '\\', '/');
+
+        if (directory.empty() || directory.front() != '/')
+        {
+            directory.insert(directory.begin(), '/');
+        }
+
+        if (directory.size() > 1 && directory.back() == '/')
+        {
+            directory.pop_back();
+        }
+
+        ensureIndex();
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+
         FileList result;
 
-        try
+        if (const auto itr = directories.find(directory); itr != directories.end())
         {
-            for (auto& itr : fs::recursive_directory_iterator(bitsDir))
+            for (const auto& path : itr->second.subdirectories)
+            {
+                result.emplace("/" + convertToLowerCase(path));
+            }
+
+            for (const auto& path : itr->second.files)
             {
-                const auto& filename = itr.path();
+                result.emplace("/" + convertToLowerCase(path));
+            }
+        }
 
-                if (fs::is_directory(filename) || fs::is_regular_file(filename))
+        return result;
+    }
+
+    FileList LocalFileSys::getFilesUnder(const std::string& prefix) const
+    {
+        ensureIndex();
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        return filesWithPrefix(entries, prefix);
+    }
+
+    int64_t LocalFileSys::lastWriteTime(const std::string& filename) const
+    {
+        std::error_code ec;
+        const auto time = fs::last_write_time(resolve(filename), ec);
+
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    void LocalFileSys::refresh()
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        buildIndex();
+    }
+
+    void LocalFileSys::ensureIndex() const
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        if (!indexed)
+        {
+            buildIndex();
+        }
+    }
+
+    void LocalFileSys::buildIndex() const
+    {
+        if (bitsDir.empty())
+        {
+            return;
+        }
+
+        // on the very first build the previous state comes from the cache on disk
+        DirectoryCache previous;
+        bool dirty = false;
+
+        if (indexed)
+        {
+            previous = std::move(directories);
+        }
+        else if (!loadCache(previous))
+        {
+            // whatever was read before the cache turned out to be unusable is not trusted either
+            previous.clear();
+            dirty = true;
+        }
+
+        DirectoryCache current;
+        entries.clear();
+
+        walk(std::string(), previous, current, dirty);
+
+        // anything left over in the previous state has been deleted
+        dirty = dirty || !previous.empty();
+
+        directories = std::move(current);
+        indexed = true;
+
+        if (dirty)
+        {
+            saveCache(directories);
+        }
+
+        log->info("LocalFileSys: indexed {} entries under {}{}", entries.size(), bitsDir.string(), dirty ? "" : " (cached)");
+    }
+
+    void LocalFileSys::walk(const std::string& diskPath, DirectoryCache& previous, DirectoryCache& current, bool& dirty) const
+    {
+        const fs::path path = bitsDir / diskPath;
+        const std::string key = "/" + convertToLowerCase(diskPath);
+
+        std::error_code ec;
+        const auto writeTime = fs::last_write_time(path, ec);
+
+        if (ec)
+        {
+            log->warn("LocalFileSys: could not stat {}: {}", path.string(), ec.message());
+            return;
+        }
+
+        CachedDirectory directory;
+
+        if (auto itr = previous.find(key); itr != previous.end())
+        {
+            directory = std::move(itr->second);
+            previous.erase(itr);
+        }
+
+        // a directory's write time changes whenever an entry is added, removed or renamed inside of it
+        if (directory.diskPath != diskPath || directory.writeTime != writeTime.time_since_epoch().count())
+        {
+            directory = CachedDirectory();
+            directory.writeTime = writeTime.time_since_epoch().count();
+            directory.diskPath = diskPath;
+            dirty = true;
+
+            for (fs::directory_iterator itr(path, ec), end; !ec && itr != end; itr.increment(ec))
+            {
+                // links to files are served like the files themselves but links to directories aren't followed, they
+                // can loop back up the tree. a dangling link only loses itself, not the rest of the listing
+                std::error_code statusError;
+                const auto linkStatus = itr->symlink_status(statusError);
+                const auto status = fs::is_symlink(linkStatus) ? itr->status(statusError) : linkStatus;
+                const std::string name = itr->path().filename().generic_string();
+                std::string child = diskPath.empty() ? name : diskPath + "/" + name;
+
+                if (fs::is_directory(status))
+                {
+                    if (fs::is_symlink(linkStatus))
+                    {
+                        log->warn("LocalFileSys: not following directory link {}", itr->path().string());
+                        continue;
+                    }
+
+                    directory.subdirectories.emplace_back(std::move(child));
+                }
+                else if (fs::is_regular_file(status))
                 {
-                    auto unixStylePath = filename.generic_string().substr(bitsDir.string().size());
-                    result.emplace(convertToLowerCase(unixStylePath));
+                    directory.files.emplace_back(std::move(child));
                 }
             }
+
+            if (ec)
+            {
+                log->warn("LocalFileSys: could not list {}: {}", path.string(), ec.message());
+            }
         }
-        catch (std::exception& e)
+
+        for (const auto& file : directory.files)
         {
-            log->warn("LocalFileSys::getFiles(): {}", e.what());
+            entries.emplace("/" + convertToLowerCase(file));
         }
 
-        return result;
+        for (const auto& subdirectory : directory.subdirectories)
+        {
+            entries.emplace("/" + convertToLowerCase(subdirectory));
+
+            walk(subdirectory, previous, current, dirty);
+        }
+
+        current[key] = std::move(directory);
     }
 
-    FileList LocalFileSys::getDirectoryContents(const std::string& directory_) const
+    fs::path LocalFileSys::cacheFileName() const
     {
-        std::string directory = convertToLowerCase(directory_);
-        if (directory.front() == '/' || directory.front() == '\\')
+        if (cacheDir.empty())
         {
-            directory.erase(0, 1);
+            return fs::path();
         }
 
-        FileList result;
+        std::ostringstream name;
+        name << "fileindex-" << std::hex << std::hash<std::string>()(bitsDir.generic_string()) << ".txt";
+
+        return cacheDir / name.str();
+    }
+
+    /*
+     * the cache is a plain text file:
+     *
+     * OpenSiegeFileIndex <version>
+     * <bits directory>
+     * D <write time> <directory>       one per directory followed by its contents
+     * F <file>
+     * S <subdirectory>
+     */
+    static constexpr const char* CACHE_MAGIC = "OpenSiegeFileIndex 1";
+
+    bool LocalFileSys::loadCache(DirectoryCache& cache) const
+    {
+        const fs::path filename = cacheFileName();
+
+        if (filename.empty())
+        {
+            return false;
+        }
+
+        std::ifstream stream(filename);
+
+        if (std::string line; !stream.is_open() || !std::getline(stream, line) || line != CACHE_MAGIC || !std::getline(stream, line) || line != bitsDir.generic_string())
+        {
+            return false;
+        }
+
+        CachedDirectory* directory = nullptr;
 
-        try
+        for (std::string line; std::getline(stream, line);)
         {
-            for (auto& itr : fs::directory_iterator(bitsDir / directory))
+            if (line.size() < 2 || line[1] != ' ')
             {
-                const auto& filename = itr.path();
+                return false;
+            }
+
+            if (line[0] == 'D')
+            {
+                const auto space = line.find(' ', 2);
 
-                if (fs::is_directory(filename) || fs::is_regular_file(filename))
+                if (space == std::string::npos)
                 {
-                    auto unixStylePath = filename.generic_string().substr(bitsDir.string().size());
-                    result.emplace(convertToLowerCase(unixStylePath));
+                    return false;
+                }
+
+                const std::string diskPath = line.substr(space + 1);
+
+                directory = &cache["/" + convertToLowerCase(diskPath)];
+                directory->diskPath = diskPath;
+                const char* const begin = line.data() + 2;
+
+                // a damaged cache is walked again from scratch
+                if (const auto [ptr, ec] = std::from_chars(begin, line.data() + space, directory->writeTime); ec != std::errc() || ptr != line.data() + space)
+                {
+                    return false;
                 }
             }
+            else if (directory && line[0] == 'F')
+            {
+                directory->files.emplace_back(line.substr(2));
+            }
+            else if (directory && line[0] == 'S')
+            {
+                directory->subdirectories.emplace_back(line.substr(2));
+            }
+            else
+            {
+                return false;
+            }
         }
-        catch (std::exception& e)
+
+        return true;
+    }
+
+    void LocalFileSys::saveCache(const DirectoryCache& cache) const
+    {
+        const fs::path filename = cacheFileName();
+
+        if (filename.empty())
         {
-            log->warn("LocalFileSys::getDirectoryContents({}): {}", directory, e.what());
+            return;
         }
 
-        return result;
+        // the first run against a fresh cache directory has to make it
+        std::error_code ec;
+        fs::create_directories(cacheDir, ec);
+
+        // write to the side and swap it in so a crash never leaves a half written index behind
+        fs::path temporary = filename;
+        temporary += ".tmp";
+
+        if (std::ofstream stream(temporary); stream.is_open())
+        {
+            stream << CACHE_MAGIC << '\n' << bitsDir.generic_string() << '\n';
+
+            for (const auto& entry : cache)
+            {
+                const CachedDirectory& directory = entry.second;
+
+                stream << "D " << directory.writeTime << ' ' << directory.diskPath << '\n';
+
+                for (const auto& file : directory.files)
+                {
+                    stream << "F " << file << '\n';
+                }
+
+                for (const auto& subdirectory : directory.subdirectories)
+                {
+                    stream << "S " << subdirectory << '\n';
+                }
+            }
+
+            if (!stream.good())
+            {
+                return;
+            }
+        }
+
+        fs::rename(temporary, filename, ec);
+
+        if (ec)
+        {
+            log->warn("LocalFileSys: could not write file index {}: {}", filename.string(), ec.message());
+        }
     }
 } // namespace ehb
@@ -3,7 +3,10 @@
 
 #include "IFileSys.hpp"
 #include "vsg/io/FileSystem.h"
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -24,17 +27,60 @@ namespace ehb
     public:
         LocalFileSys() = default;
 
+        //! serve files from bitsDir without going through the config, used when layering several roots
+        explicit LocalFileSys(const fs::path& bitsDir, const fs::path& cacheDir = fs::path());
+
         virtual ~LocalFileSys() = default;
 
         virtual void init(IConfig& config) override;
 
         virtual InputStream createInputStream(const std::string& filename) override;
+        virtual InputView createInputView(const std::string& filename) override;
 
         virtual FileList getFiles() const override;
         virtual FileList getDirectoryContents(const std::string& directory) const override;
+        virtual FileList getFilesUnder(const std::string& prefix) const override;
+
+        virtual int64_t lastWriteTime(const std::string& filename) const override;
+
+        //! re-validate the file index against the disk, only directories whose write time changed are walked again
+        void refresh();
+
+    private:
+        fs::path resolve(const std::string& filename) const;
+
+        struct CachedDirectory
+        {
+            int64_t writeTime = 0;
+
+            // paths relative to the bits directory exactly as they are spelled on disk
+            std::string diskPath;
+            std::vector<std::string> files;
+            std::vector<std::string> subdirectories;
+        };
+
+        typedef std::map<std::string, CachedDirectory> DirectoryCache;
+
+        void ensureIndex() const;
+        void buildIndex() const;
+        void walk(const std::string& diskPath, DirectoryCache& previous, DirectoryCache& current, bool& dirty) const;
+
+        fs::path cacheFileName() const;
+        bool loadCache(DirectoryCache& cache) const;
+        void saveCache(const DirectoryCache& cache) const;
 
     private:
         fs::path bitsDir;
+        fs::path cacheDir;
+
+        /*
+         * the index is built on first use, every directory is keyed by its lower case unix style path and
+         * remembers its write time so the next startup only has to stat directories to prove the cache is good
+         */
+        mutable std::mutex indexMutex;
+        mutable bool indexed = false;
+        mutable FileList entries;
+        mutable DirectoryCache directories;
 
         std::shared_ptr<spdlog::logger> log;
     };
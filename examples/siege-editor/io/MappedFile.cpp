@@ -0,0 +1,157 @@
+
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#ifdef WIN32
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace ehb
+{
+    namespace
+    {
+        class BufferFile : public MappedFile
+        {
+        public:
+            explicit BufferFile(std::vector<uint8_t> bytes) :
+                buffer(std::move(bytes))
+            {
+                mData = buffer.data();
+                mSize = buffer.size();
+            }
+
+        private:
+            std::vector<uint8_t> buffer;
+        };
+
+#ifdef WIN32
+        class SystemMappedFile : public MappedFile
+        {
+        public:
+            SystemMappedFile(HANDLE mapping, const void* view, size_t size) :
+                mapping(mapping)
+            {
+                mData = static_cast<const uint8_t*>(view);
+                mSize = size;
+            }
+
+            virtual ~SystemMappedFile()
+            {
+                UnmapViewOfFile(mData);
+                CloseHandle(mapping);
+            }
+
+        private:
+            HANDLE mapping;
+        };
+#else
+        class SystemMappedFile : public MappedFile
+        {
+        public:
+            SystemMappedFile(void* address, size_t size)
+            {
+                mData = static_cast<const uint8_t*>(address);
+                mSize = size;
+            }
+
+            virtual ~SystemMappedFile()
+            {
+                munmap(const_cast<uint8_t*>(mData), mSize);
+            }
+        };
+#endif
+
+        std::shared_ptr<const MappedFile> readWholeFile(const std::string& filename)
+        {
+            if (std::ifstream stream(filename, std::ios_base::binary); stream.is_open())
+            {
+                return MappedFile::fromStream(stream);
+            }
+
+            return {};
+        }
+    } // namespace
+
+    std::shared_ptr<const MappedFile> MappedFile::map(const std::string& filename)
+    {
+        // empty files can't be mapped, reading them costs nothing anyway
+#ifdef WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return {};
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return readWholeFile(filename);
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        // the mapping holds its own reference to the file
+        CloseHandle(file);
+
+        if (mapping == nullptr)
+        {
+            return readWholeFile(filename);
+        }
+
+        if (const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0); view != nullptr)
+        {
+            return std::make_shared<SystemMappedFile>(mapping, view, static_cast<size_t>(fileSize.QuadPart));
+        }
+
+        CloseHandle(mapping);
+
+        return readWholeFile(filename);
+#else
+        const int fd = open(filename.c_str(), O_RDONLY);
+
+        if (fd == -1)
+        {
+            return {};
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+        {
+            close(fd);
+            return readWholeFile(filename);
+        }
+
+        const size_t size = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // the mapping stays valid after the descriptor is closed
+        close(fd);
+
+        if (address == MAP_FAILED)
+        {
+            return readWholeFile(filename);
+        }
+
+        return std::make_shared<SystemMappedFile>(address, size);
+#endif
+    }
+
+    std::shared_ptr<const MappedFile> MappedFile::fromBuffer(std::vector<uint8_t> buffer)
+    {
+        return std::make_shared<BufferFile>(std::move(buffer));
+    }
+
+    std::shared_ptr<const MappedFile> MappedFile::fromStream(std::istream& stream)
+    {
+        return fromBuffer(std::vector<uint8_t>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+    }
+} // namespace ehb
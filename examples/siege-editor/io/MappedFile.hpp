@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ehb
+{
+    /**
+     * read-only view over the contents of a file
+     *
+     * depending on where the data came from the bytes are either mapped straight from disk
+     * or held in an owned buffer, either way the view stays valid for the lifetime of the object
+     *
+     * NOTE: the data is not null terminated, readers have to stop at size()
+     */
+    class MappedFile
+    {
+    public:
+        virtual ~MappedFile() = default;
+
+        const uint8_t* data() const;
+        size_t size() const;
+        bool empty() const;
+
+        std::string_view view() const;
+
+        //! map a file from the local disk, returns nullptr if the file can't be opened
+        static std::shared_ptr<const MappedFile> map(const std::string& filename);
+
+        //! wrap an already loaded buffer, i.e. data that had to be decompressed
+        static std::shared_ptr<const MappedFile> fromBuffer(std::vector<uint8_t> buffer);
+
+        //! drain a stream into an owned buffer, used by file systems that can't map their files
+        static std::shared_ptr<const MappedFile> fromStream(std::istream& stream);
+
+    protected:
+        MappedFile() = default;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+    };
+
+    typedef std::shared_ptr<const MappedFile> InputView;
+
+    inline const uint8_t* MappedFile::data() const
+    {
+        return mData;
+    }
+
+    inline size_t MappedFile::size() const
+    {
+        return mSize;
+    }
+
+    inline bool MappedFile::empty() const
+    {
+        return mSize == 0;
+    }
+
+    inline std::string_view MappedFile::view() const
+    {
+        return std::string_view(reinterpret_cast<const char*>(mData), mSize);
+    }
+} // namespace ehb
@@ -0,0 +1,134 @@
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ehb
+{
+    //! number of workers to throw at count items, never more than the machine has cores and never zero
+    inline unsigned workerCount(size_t count, unsigned maxThreads = 0)
+    {
+        const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        const unsigned limit = maxThreads != 0 ? std::min(maxThreads, hardware) : hardware;
+
+        return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(count, limit)));
+    }
+
+    //! threads that are joined when the group goes out of scope, however it is left
+    class ThreadGroup
+    {
+    public:
+        ThreadGroup() = default;
+        ThreadGroup(const ThreadGroup&) = delete;
+        ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+        ~ThreadGroup()
+        {
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+        }
+
+        template <typename... Args>
+        void start(Args&&... args)
+        {
+            threads.emplace_back(std::forward<Args>(args)...);
+        }
+
+    private:
+        std::vector<std::thread> threads;
+    };
+
+    //! keeps the first exception thrown by any of a group of workers so the thread that started them can rethrow it
+    class FirstException
+    {
+    public:
+        void capture()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+
+        //! safe to call while workers are still running
+        void rethrow()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (std::exception_ptr first = error)
+            {
+                lock.unlock();
+                std::rethrow_exception(first);
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
+
+    /**
+     * call func(worker, i) for every i in [0, count) spread over workerCount(count, maxThreads) threads, the calling
+     * thread is worker 0
+     *
+     * items are handed out one at a time from a shared cursor so a thread that lands on a couple of large
+     * files doesn't hold everyone else up, func must be safe to call concurrently. worker lets func keep per
+     * thread state in a plain array instead of behind a lock
+     *
+     * once func throws no more items are handed out, and the first exception is rethrown after every thread joined
+     */
+    template <typename Func>
+    void parallelForWorkers(size_t count, Func&& func, unsigned maxThreads = 0)
+    {
+        std::atomic<size_t> cursor{0};
+        FirstException error;
+
+        auto worker = [&cursor, &func, &error, count](unsigned index) {
+            try
+            {
+                for (size_t i = cursor.fetch_add(1); i < count; i = cursor.fetch_add(1))
+                {
+                    func(index, i);
+                }
+            }
+            catch (...)
+            {
+                cursor.store(count);
+                error.capture();
+            }
+        };
+
+        {
+            ThreadGroup threads;
+
+            for (unsigned i = 1; i < workerCount(count, maxThreads); ++i)
+            {
+                threads.start(worker, i);
+            }
+
+            worker(0);
+        }
+
+        error.rethrow();
+    }
+
+    //! call func(i) for every i in [0, count), see parallelForWorkers
+    template <typename Func>
+    void parallelFor(size_t count, Func&& func, unsigned maxThreads = 0)
+    {
+        parallelForWorkers(count, [&func](unsigned, size_t i) { func(i); }, maxThreads);
+    }
+} // namespace ehb
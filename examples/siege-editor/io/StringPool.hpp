@@ -0,0 +1,86 @@
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ehb
+{
+    /**
+     * process wide pool of interned strings
+     *
+     * fuel block names, block types and attribute names come from a small vocabulary that repeats across every
+     * document, interning them means each distinct spelling is stored once and equal names share an address.
+     * strings are never removed so references stay valid for the lifetime of the process
+     *
+     * lookups take a shared lock so the parallel loaders only serialize when they meet a new spelling
+     */
+    class StringPool
+    {
+    public:
+        const std::string& intern(std::string_view value);
+
+        size_t size() const;
+
+        static StringPool& global();
+
+        //! the interned empty string, handy as a default for names and types
+        static const std::string& empty();
+
+    private:
+        mutable std::shared_mutex mutex;
+
+        // a deque never moves its elements so the views used as keys stay valid as it grows
+        std::deque<std::string> strings;
+        std::unordered_map<std::string_view, const std::string*> index;
+    };
+
+    inline const std::string& StringPool::intern(std::string_view value)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+
+            if (const auto itr = index.find(value); itr != index.end())
+            {
+                return *itr->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        // another thread may have added it between the two locks
+        if (const auto itr = index.find(value); itr != index.end())
+        {
+            return *itr->second;
+        }
+
+        const std::string& result = strings.emplace_back(value);
+
+        index.emplace(result, &result);
+
+        return result;
+    }
+
+    inline size_t StringPool::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        return strings.size();
+    }
+
+    inline StringPool& StringPool::global()
+    {
+        static StringPool pool;
+        return pool;
+    }
+
+    inline const std::string& StringPool::empty()
+    {
+        static const std::string& result = global().intern(std::string_view());
+        return result;
+    }
+} // namespace ehb
@@ -0,0 +1,660 @@
+
+#include "TankFileSys.hpp"
+#include "IoStats.hpp"
+
+#include <cstring>
+#include <functional>
+#include <streambuf>
+
+#include <zlib.h>
+
+namespace ehb
+{
+    /*
+     * layout of the pieces of a tank we care about, everything is little endian
+     *
+     * header:      "DSig" "Tank" version dirSetOffset fileSetOffset indexSize dataOffset
+     *              productVersion[3] minimumVersion[3] priority flags ... (copyright, build strings etc)
+     * dir set:     count, offsets[count] relative to the dir set
+     * dir entry:   parentOffset childCount fileTime(8) name childOffsets[childCount]
+     * file set:    count, offsets[count] relative to the file set
+     * file entry:  parentOffset size offset crc32 fileTime(8) format(2) flags(2) name
+     *              compressed entries follow with: compressedSize chunkSize chunkHeaders[ceil(size / chunkSize)]
+     *
+     * names are a 16 bit length followed by the characters padded out to a 4 byte boundary
+     * and parent offsets of both dir and file entries are relative to the dir set
+     */
+    static constexpr uint32_t HEADER_PRIORITY_OFFSET = 52;
+
+    namespace
+    {
+        class TankIndexReader
+        {
+        public:
+            TankIndexReader(const uint8_t* data, size_t size) :
+                data(data), size(size) {}
+
+            bool seek(size_t offset)
+            {
+                position = offset;
+                return position <= size;
+            }
+
+            //! bytes between the read position and the end of the archive, what any count read from it has to fit in
+            size_t remaining() const { return position < size ? size - position : 0; }
+
+            bool readUInt16(uint16_t& value) { return readBytes(&value, sizeof(value)); }
+            bool readUInt32(uint32_t& value) { return readBytes(&value, sizeof(value)); }
+            bool readUInt64(uint64_t& value) { return readBytes(&value, sizeof(value)); }
+
+            bool readName(std::string& name)
+            {
+                uint16_t length = 0;
+
+                if (!readUInt16(length) || position + length > size)
+                {
+                    return false;
+                }
+
+                name.assign(reinterpret_cast<const char*>(data + position), length);
+
+                // the length and the characters together are padded to a dword
+                position += ((sizeof(uint16_t) + length + 3) & ~size_t(3)) - sizeof(uint16_t);
+
+                return position <= size;
+            }
+
+        private:
+            bool readBytes(void* buffer, size_t count)
+            {
+                if (position + count > size)
+                {
+                    return false;
+                }
+
+                std::memcpy(buffer, data + position, count);
+                position += count;
+
+                return true;
+            }
+
+            const uint8_t* data;
+            size_t size;
+            size_t position = 0;
+        };
+
+        // view over a span of the archive that shares ownership of the whole archive mapping
+        class TankSubView : public MappedFile
+        {
+        public:
+            TankSubView(InputView tank, const uint8_t* begin, size_t length) :
+                tank(std::move(tank))
+            {
+                mData = begin;
+                mSize = length;
+            }
+
+        private:
+            InputView tank;
+        };
+
+        class ViewStreamBuf : public std::streambuf
+        {
+        public:
+            explicit ViewStreamBuf(InputView view) :
+                view(std::move(view))
+            {
+                char* begin = const_cast<char*>(reinterpret_cast<const char*>(this->view->data()));
+                setg(begin, begin, begin + this->view->size());
+            }
+
+        protected:
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+            {
+                char* target = nullptr;
+
+                switch (dir)
+                {
+                case std::ios_base::beg: target = eback() + off; break;
+                case std::ios_base::cur: target = gptr() + off; break;
+                default: target = egptr() + off; break;
+                }
+
+                if (!(which & std::ios_base::in) || target < eback() || target > egptr())
+                {
+                    return pos_type(off_type(-1));
+                }
+
+                setg(eback(), target, egptr());
+
+                return pos_type(target - eback());
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+            {
+                return seekoff(off_type(pos), std::ios_base::beg, which);
+            }
+
+        private:
+            InputView view;
+        };
+
+        class ViewStream : public std::istream
+        {
+        public:
+            explicit ViewStream(InputView view) :
+                std::istream(nullptr), buffer(std::move(view))
+            {
+                rdbuf(&buffer);
+            }
+
+        private:
+            ViewStreamBuf buffer;
+        };
+    } // namespace
+
+    /*
+     * LZO1X decompression with bounds checking on both the input and output buffers
+     * this follows the control flow of lzo1x_decompress_safe from the reference implementation,
+     * it's all we need from the library so we avoid pulling it in as a dependency
+     */
+    bool TankFileSys::decompressLzo(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize)
+    {
+        const uint8_t* ip = in;
+        const uint8_t* const ipEnd = in + inSize;
+        uint8_t* op = out;
+        uint8_t* const opEnd = out + outSize;
+
+        const uint8_t* mPos = nullptr;
+        size_t t = 0;
+
+        auto haveIn = [&](size_t n) { return static_cast<size_t>(ipEnd - ip) >= n; };
+        auto haveOut = [&](size_t n) { return static_cast<size_t>(opEnd - op) >= n; };
+
+        auto copyLiterals = [&](size_t n) {
+            if (!haveIn(n) || !haveOut(n)) return false;
+            std::memcpy(op, ip, n);
+            op += n;
+            ip += n;
+            return true;
+        };
+
+        // matches can overlap their own output so they are copied a byte at a time
+        auto copyMatch = [&](size_t n) {
+            if (mPos < out || mPos >= op || !haveOut(n)) return false;
+            while (n-- > 0) *op++ = *mPos++;
+            return true;
+        };
+
+        // a zero length is extended by 255 for every zero byte that follows
+        auto extendLength = [&](size_t base) {
+            while (haveIn(1) && *ip == 0)
+            {
+                t += 255;
+                ++ip;
+            }
+            if (!haveIn(1)) return false;
+            t += base + *ip++;
+            return true;
+        };
+
+        if (!haveIn(1)) return false;
+
+        if (*ip > 17)
+        {
+            t = *ip++ - 17;
+
+            if (t < 4) goto match_next;
+
+            if (!copyLiterals(t)) return false;
+
+            goto first_literal_run;
+        }
+
+        for (;;)
+        {
+            if (!haveIn(1)) return false;
+            t = *ip++;
+
+            if (t >= 16) goto match;
+
+            // a literal run
+            if (t == 0 && !extendLength(15)) return false;
+            if (!copyLiterals(t + 3)) return false;
+
+        first_literal_run:
+            if (!haveIn(1)) return false;
+            t = *ip++;
+
+            if (t >= 16) goto match;
+
+            if (!haveIn(1)) return false;
+            mPos = op - (1 + 0x0800);
+            mPos -= t >> 2;
+            mPos -= *ip++ << 2;
+            if (!copyMatch(3)) return false;
+
+            goto match_done;
+
+            for (;;)
+            {
+            match:
+                if (t >= 64)
+                {
+                    if (!haveIn(1)) return false;
+                    mPos = op - 1;
+                    mPos -= (t >> 2) & 7;
+                    mPos -= *ip++ << 3;
+                    t = (t >> 5) - 1;
+                }
+                else if (t >= 32)
+                {
+                    t &= 31;
+                    if (t == 0 && !extendLength(31)) return false;
+
+                    if (!haveIn(2)) return false;
+                    mPos = op - 1;
+                    mPos -= (ip[0] >> 2) + (ip[1] << 6);
+                    ip += 2;
+                }
+                else if (t >= 16)
+                {
+                    mPos = op;
+                    mPos -= (t & 8) << 11;
+                    t &= 7;
+                    if (t == 0 && !extendLength(7)) return false;
+
+                    if (!haveIn(2)) return false;
+                    mPos -= (ip[0] >> 2) + (ip[1] << 6);
+                    ip += 2;
+
+                    if (mPos == op)
+                    {
+                        // end of stream marker
+                        return ip == ipEnd && op == opEnd;
+                    }
+
+                    mPos -= 0x4000;
+                }
+                else
+                {
+                    if (!haveIn(1)) return false;
+                    mPos = op - 1;
+                    mPos -= t >> 2;
+                    mPos -= *ip++ << 2;
+                    if (!copyMatch(2)) return false;
+
+                    goto match_done;
+                }
+
+                if (!copyMatch(t + 2)) return false;
+
+            match_done:
+                // the low bits of the last instruction carry up to 3 trailing literals
+                t = ip[-2] & 3;
+
+                if (t == 0) break;
+
+            match_next:
+                if (!copyLiterals(t)) return false;
+
+                if (!haveIn(1)) return false;
+                t = *ip++;
+            }
+        }
+    }
+
+    void TankFileSys::init(IConfig& /*config*/)
+    {
+        log = spdlog::get("log");
+    }
+
+    bool TankFileSys::open(const std::string& filename)
+    {
+        if (!log)
+        {
+            log = spdlog::get("log");
+        }
+
+        tankName = filename;
+        tank = MappedFile::map(filename);
+
+        if (!tank)
+        {
+            log->error("TankFileSys::open({}): unable to open archive", filename);
+            return false;
+        }
+
+        if (!readIndex())
+        {
+            log->error("TankFileSys::open({}): archive index is invalid", filename);
+
+            tank.reset();
+            files.clear();
+            entries.clear();
+            directories.clear();
+
+            return false;
+        }
+
+        log->info("{} opened with {} files", filename, files.size());
+
+        return true;
+    }
+
+    bool TankFileSys::readIndex()
+    {
+        TankIndexReader reader(tank->data(), tank->size());
+
+        if (tank->size() < HEADER_PRIORITY_OFFSET + sizeof(uint32_t) || std::memcmp(tank->data(), "DSigTank", 8) != 0)
+        {
+            return false;
+        }
+
+        uint32_t version = 0, dirSetOffset = 0, fileSetOffset = 0, indexSize = 0;
+
+        reader.seek(8);
+        reader.readUInt32(version);
+        reader.readUInt32(dirSetOffset);
+        reader.readUInt32(fileSetOffset);
+        reader.readUInt32(indexSize);
+        reader.readUInt32(dataOffset);
+
+        reader.seek(HEADER_PRIORITY_OFFSET);
+        reader.readUInt32(tankPriority);
+
+        // resolve the full path of every directory first, keyed by its offset in the dir set
+        std::unordered_map<uint32_t, std::string> dirPaths;
+        std::vector<std::pair<uint32_t, std::pair<uint32_t, std::string>>> dirEntries; // offset -> (parent, name)
+
+        // counts are checked against what is left of the archive before anything is sized from them
+        uint32_t dirCount = 0;
+        if (!reader.seek(dirSetOffset) || !reader.readUInt32(dirCount) || dirCount > reader.remaining() / sizeof(uint32_t))
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> dirOffsets(dirCount);
+        for (auto& offset : dirOffsets)
+        {
+            if (!reader.readUInt32(offset)) return false;
+        }
+
+        for (const auto offset : dirOffsets)
+        {
+            uint32_t parentOffset = 0, childCount = 0;
+            uint64_t fileTime = 0;
+            std::string name;
+
+            if (!reader.seek(dirSetOffset + offset) || !reader.readUInt32(parentOffset) || !reader.readUInt32(childCount) || !reader.readUInt64(fileTime) || !reader.readName(name))
+            {
+                return false;
+            }
+
+            dirEntries.emplace_back(offset, std::make_pair(parentOffset, convertToLowerCase(name)));
+        }
+
+        std::unordered_map<uint32_t, std::pair<uint32_t, std::string>> dirLookup(dirEntries.begin(), dirEntries.end());
+
+        std::function<const std::string&(uint32_t, uint32_t)> resolveDir;
+        resolveDir = [&](uint32_t offset, uint32_t depth) -> const std::string& {
+            static const std::string root;
+
+            if (const auto itr = dirPaths.find(offset); itr != dirPaths.end())
+            {
+                return itr->second;
+            }
+
+            const auto entry = dirLookup.find(offset);
+
+            // the root directory is its own parent and has no name, guard against cycles in broken archives
+            if (entry == dirLookup.end() || entry->second.second.empty() || depth > dirLookup.size())
+            {
+                return root;
+            }
+
+            const auto& [parentOffset, name] = entry->second;
+            const std::string& parentPath = parentOffset == offset ? root : resolveDir(parentOffset, depth + 1);
+
+            return dirPaths.emplace(offset, parentPath + "/" + name).first->second;
+        };
+
+        for (const auto& entry : dirEntries)
+        {
+            const std::string& path = resolveDir(entry.first, 0);
+
+            if (!path.empty())
+            {
+                entries.emplace(path);
+
+                const std::string parent = path.substr(0, path.find_last_of('/'));
+                directories[parent].emplace(path);
+                directories.emplace(path, FileList());
+            }
+        }
+
+        uint32_t fileCount = 0;
+        if (!reader.seek(fileSetOffset) || !reader.readUInt32(fileCount) || fileCount > reader.remaining() / sizeof(uint32_t))
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> fileOffsets(fileCount);
+        for (auto& offset : fileOffsets)
+        {
+            if (!reader.readUInt32(offset)) return false;
+        }
+
+        files.reserve(fileCount);
+
+        for (const auto offset : fileOffsets)
+        {
+            FileEntry file;
+
+            uint32_t parentOffset = 0, crc32 = 0;
+            uint16_t format = 0, flags = 0;
+            std::string name;
+
+            if (!reader.seek(fileSetOffset + offset) ||
+                !reader.readUInt32(parentOffset) || !reader.readUInt32(file.size) || !reader.readUInt32(file.offset) || !reader.readUInt32(crc32) ||
+                !reader.readUInt64(file.fileTime) || !reader.readUInt16(format) || !reader.readUInt16(flags) || !reader.readName(name))
+            {
+                return false;
+            }
+
+            file.format = static_cast<DataFormat>(format);
+            file.compressedSize = file.size;
+            file.chunkSize = 0;
+
+            if (file.format != DataFormat::Raw)
+            {
+                if (!reader.readUInt32(file.compressedSize) || !reader.readUInt32(file.chunkSize) || file.chunkSize == 0)
+                {
+                    return false;
+                }
+
+                // every chunk header is four dwords
+                const uint64_t chunkCount = (uint64_t(file.size) + file.chunkSize - 1) / file.chunkSize;
+
+                if (chunkCount > reader.remaining() / (4 * sizeof(uint32_t)))
+                {
+                    return false;
+                }
+
+                file.chunks.resize(static_cast<size_t>(chunkCount));
+
+                for (auto& chunk : file.chunks)
+                {
+                    if (!reader.readUInt32(chunk.uncompressedSize) || !reader.readUInt32(chunk.compressedSize) || !reader.readUInt32(chunk.extraBytes) || !reader.readUInt32(chunk.offset))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            const auto parent = dirPaths.find(parentOffset);
+            const std::string& parentPath = parent != dirPaths.end() ? parent->second : std::string();
+            const std::string path = parentPath + "/" + convertToLowerCase(name);
+
+            entries.emplace(path);
+            directories[parentPath].emplace(path);
+
+            files.emplace(path, std::move(file));
+        }
+
+        return true;
+    }
+
+    const TankFileSys::FileEntry* TankFileSys::find(const std::string& filename_) const
+    {
+        std::string filename = convertToLowerCase(filename_);
+
+        std::replace(filename.begin(), filename.end(), '\\', '/');
+
+        if (filename.empty() || filename.front() != '/')
+        {
+            filename.insert(filename.begin(), '/');
+        }
+
+        const auto itr = files.find(filename);
+
+        return itr != files.end() ? &itr->second : nullptr;
+    }
+
+    InputStream TankFileSys::createInputStream(const std::string& filename)
+    {
+        if (auto view = createInputView(filename))
+        {
+            return std::make_unique<ViewStream>(std::move(view));
+        }
+
+        return InputStream();
+    }
+
+    InputView TankFileSys::createInputView(const std::string& filename)
+    {
+        const FileEntry* file = tank ? find(filename) : nullptr;
+
+        if (!file)
+        {
+            return {};
+        }
+
+        IoStats::recordFile(file->size);
+
+        const size_t begin = static_cast<size_t>(dataOffset) + file->offset;
+
+        if (file->format == DataFormat::Raw)
+        {
+            if (begin + file->size > tank->size())
+            {
+                log->error("{}: {} extends past the end of the archive", tankName, filename);
+                return {};
+            }
+
+            // stored files are handed out straight from the archive mapping
+            return std::make_shared<TankSubView>(tank, tank->data() + begin, file->size);
+        }
+
+        std::vector<uint8_t> result(file->size);
+        size_t written = 0;
+
+        for (const auto& chunk : file->chunks)
+        {
+            const size_t chunkBegin = begin + chunk.offset;
+
+            if (chunkBegin + chunk.compressedSize + chunk.extraBytes > tank->size() || written + chunk.uncompressedSize > result.size() || chunk.extraBytes > chunk.uncompressedSize)
+            {
+                log->error("{}: chunk of {} is out of bounds", tankName, filename);
+                return {};
+            }
+
+            const uint8_t* src = tank->data() + chunkBegin;
+            uint8_t* dst = result.data() + written;
+
+            if (chunk.compressedSize == chunk.uncompressedSize)
+            {
+                // chunks that didn't compress are stored as is
+                std::memcpy(dst, src, chunk.uncompressedSize);
+            }
+            else
+            {
+                // extra bytes trail the compressed data and are copied raw onto the end of the chunk
+                const size_t decompressedSize = chunk.uncompressedSize - chunk.extraBytes;
+
+                bool ok = false;
+
+                if (file->format == DataFormat::Lzo)
+                {
+                    ok = decompressLzo(src, chunk.compressedSize, dst, decompressedSize);
+                }
+                else if (file->format == DataFormat::Zlib)
+                {
+                    uLongf destLen = static_cast<uLongf>(decompressedSize);
+                    ok = uncompress(dst, &destLen, src, chunk.compressedSize) == Z_OK && destLen == decompressedSize;
+                }
+
+                if (!ok)
+                {
+                    log->error("{}: failed to decompress {}", tankName, filename);
+                    return {};
+                }
+
+                std::memcpy(dst + decompressedSize, src + chunk.compressedSize, chunk.extraBytes);
+            }
+
+            written += chunk.uncompressedSize;
+        }
+
+        if (written != result.size())
+        {
+            log->error("{}: {} decompressed to {} bytes, expected {}", tankName, filename, written, result.size());
+            return {};
+        }
+
+        return MappedFile::fromBuffer(std::move(result));
+    }
+
+    FileList TankFileSys::getFiles() const
+    {
+        return entries;
+    }
+
+    FileList TankFileSys::getFilesUnder(const std::string& prefix) const
+    {
+        return filesWithPrefix(entries, prefix);
+    }
+
+    int64_t TankFileSys::lastWriteTime(const std::string& filename) const
+    {
+        const FileEntry* entry = find(filename);
+
+        return entry != nullptr ? static_cast<int64_t>(entry->fileTime) : 0;
+    }
+
+    FileList TankFileSys::getDirectoryContents(const std::string& directory_) const
+    {
+        std::string directory = convertToLowerCase(directory_);
+
+        std::replace(directory.begin(), directory.end(), '\\', '/');
+
+        if (directory.empty() || directory.front() != '/')
+        {
+            directory.insert(directory.begin(), '/');
+        }
+
+        if (directory.size() > 1 && directory.back() == '/')
+        {
+            directory.pop_back();
+        }
+
+        if (directory == "/")
+        {
+            directory.clear();
+        }
+
+        const auto itr = directories.find(directory);
+
+        return itr != directories.end() ? itr->second : FileList();
+    }
+} // namespace ehb
@@ -0,0 +1,105 @@
+
+#pragma once
+
+#include "IFileSys.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace ehb
+{
+    /**
+     * read-only file system over a single Dungeon Siege tank archive (.dsres, .dsmap)
+     *
+     * the directory and file sets are walked once when the archive is opened and flattened into
+     * an index keyed by lower case unix style paths, after that every lookup is a single hash probe
+     * and file data is only touched (and decompressed) when a stream or view is requested
+     */
+    class TankFileSys : public IFileSys
+    {
+    public:
+        TankFileSys() = default;
+
+        virtual ~TankFileSys() = default;
+
+        //! tanks don't read anything from the config, call open() with the archive to serve
+        virtual void init(IConfig& config) override;
+
+        bool open(const std::string& filename);
+
+        virtual InputStream createInputStream(const std::string& filename) override;
+        virtual InputView createInputView(const std::string& filename) override;
+
+        virtual FileList getFiles() const override;
+        virtual FileList getDirectoryContents(const std::string& directory) const override;
+        virtual FileList getFilesUnder(const std::string& prefix) const override;
+
+        //! the file time recorded in the archive index
+        virtual int64_t lastWriteTime(const std::string& filename) const override;
+
+        //! header priority of the archive, higher priorities win when archives are layered
+        uint32_t priority() const;
+
+    public:
+        enum class DataFormat : uint16_t
+        {
+            Raw = 0,
+            Zlib = 1,
+            Lzo = 2
+        };
+
+        struct ChunkHeader
+        {
+            uint32_t uncompressedSize;
+            uint32_t compressedSize;
+            uint32_t extraBytes;
+            uint32_t offset;
+        };
+
+        struct FileEntry
+        {
+            uint32_t size;
+            uint32_t offset; // relative to the start of the data section
+            uint64_t fileTime;
+            DataFormat format;
+
+            uint32_t compressedSize;
+            uint32_t chunkSize;
+            std::vector<ChunkHeader> chunks;
+        };
+
+        /**
+         * LZO1X decompression that checks every read and write against its buffer, the way lzo1x_decompress_safe does
+         *
+         * @return true only if in is a complete stream that decodes to exactly outSize bytes
+         */
+        static bool decompressLzo(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+    private:
+        bool readIndex();
+
+        const FileEntry* find(const std::string& filename) const;
+
+    private:
+        std::string tankName;
+        InputView tank;
+
+        uint32_t dataOffset = 0;
+        uint32_t tankPriority = 0;
+
+        std::unordered_map<std::string, FileEntry> files;
+
+        // every file and directory in the archive along with the direct children of each directory
+        FileList entries;
+        std::unordered_map<std::string, FileList> directories;
+
+        std::shared_ptr<spdlog::logger> log;
+    };
+
+    inline uint32_t TankFileSys::priority() const
+    {
+        return tankPriority;
+    }
+} // namespace ehb
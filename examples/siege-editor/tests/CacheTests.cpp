@@ -0,0 +1,349 @@
+
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "Test.hpp"
+
+#include "io/GasCache.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    static const std::string cacheSource = "[t:tmpl,n:a]\n{\n\tx = 1;\n\ts = \"quoted text\";\n\t[sub]\n\t{\n\t\tf scale = 1.5;\n\t\t[deeper] { v = 1,2,3; }\n\t}\n\t[*] { guid = 0x00000001; }\n}\n[t:other,n:b]\n{\n\tx = 1;\n}\n";
+
+    static std::string saved(const Fuel& doc)
+    {
+        std::ostringstream stream;
+        doc.save(stream);
+
+        return stream.str();
+    }
+
+    static std::shared_ptr<const MappedFile> toView(const std::string& text)
+    {
+        return MappedFile::fromBuffer(std::vector<uint8_t>(text.begin(), text.end()));
+    }
+
+    // a cache directory of its own that is gone again when the case is done
+    struct TempCache
+    {
+        const fs::path dir;
+
+        explicit TempCache(const std::string& name) :
+            dir(fs::temp_directory_path() / name)
+        {
+            fs::remove_all(dir);
+        }
+
+        ~TempCache()
+        {
+            std::error_code ec;
+            fs::remove_all(dir, ec);
+        }
+
+        //! where GasCache keeps the entry for filename
+        fs::path entry(const std::string& filename) const
+        {
+            std::ostringstream name;
+            name << std::hex << GasCache::hash(filename.data(), filename.size()) << ".gasc";
+
+            return dir / "gas" / name.str();
+        }
+    };
+
+    TEST(cache_round_trip)
+    {
+        const auto source = toView(cacheSource);
+
+        Fuel doc;
+        CHECK(doc.load(*source));
+
+        // straight through compile and decompile
+        const auto data = MappedFile::fromBuffer(GasCache::compile(doc, "/world/a.gas", 100, 0));
+
+        Fuel copy;
+        CHECK(GasCache::decompile(*data, copy));
+        CHECK_EQ(saved(copy), saved(doc));
+
+        // and through an entry on disk
+        const TempCache temp("siege-tests-cache");
+        const GasCache cache(temp.dir);
+
+        cache.store("/world/a.gas", 100, *source, doc);
+
+        const auto loaded = cache.load("/world/a.gas", 100, source.get());
+        CHECK(loaded != nullptr);
+
+        if (loaded)
+        {
+            CHECK_EQ(saved(*loaded), saved(doc));
+        }
+    }
+
+    TEST(cache_rejects_changed_write_time)
+    {
+        const auto source = toView(cacheSource);
+
+        Fuel doc;
+        doc.load(*source);
+
+        const TempCache temp("siege-tests-cache-time");
+        const GasCache cache(temp.dir);
+
+        cache.store("/world/a.gas", 100, *source, doc);
+
+        CHECK(cache.load("/world/a.gas", 100, nullptr) != nullptr);
+        CHECK(cache.load("/world/a.gas", 101, nullptr) == nullptr);
+        CHECK(cache.load("/world/a.gas", 99, source.get()) == nullptr);
+
+        // an entry stamped with a write time can't stand in for a file system that doesn't know one
+        CHECK(cache.load("/world/a.gas", 0, source.get()) == nullptr);
+    }
+
+    TEST(cache_hash_fallback)
+    {
+        const auto source = toView(cacheSource);
+
+        Fuel doc;
+        doc.load(*source);
+
+        const TempCache temp("siege-tests-cache-hash");
+        const GasCache cache(temp.dir);
+
+        // without a write time the entry is only good for exactly the text it was built from
+        cache.store("/world/a.gas", 0, *source, doc);
+
+        const auto loaded = cache.load("/world/a.gas", 0, source.get());
+        CHECK(loaded != nullptr);
+
+        if (loaded)
+        {
+            CHECK_EQ(saved(*loaded), saved(doc));
+        }
+
+        std::string changed = cacheSource;
+        changed[changed.find("x = 1")] = 'y';
+
+        CHECK(cache.load("/world/a.gas", 0, toView(changed).get()) == nullptr);
+        CHECK(cache.load("/world/a.gas", 0, nullptr) == nullptr);
+        CHECK(cache.load("/world/a.gas", 100, source.get()) == nullptr);
+    }
+
+    TEST(cache_rejects_other_path)
+    {
+        const auto source = toView(cacheSource);
+
+        Fuel doc;
+        doc.load(*source);
+
+        const TempCache temp("siege-tests-cache-path");
+        const GasCache cache(temp.dir);
+
+        cache.store("/world/a.gas", 100, *source, doc);
+
+        // stand in for two paths hashing to the same entry, string 0 still names the file it was built from
+        fs::copy_file(temp.entry("/world/a.gas"), temp.entry("/world/b.gas"));
+
+        CHECK(cache.load("/world/a.gas", 100, nullptr) != nullptr);
+        CHECK(cache.load("/world/b.gas", 100, nullptr) == nullptr);
+    }
+
+    TEST(cache_rejects_damaged_entries)
+    {
+        const auto source = toView(cacheSource);
+
+        Fuel doc;
+        doc.load(*source);
+
+        const std::vector<uint8_t> data = GasCache::compile(doc, "/world/a.gas", 100, 0);
+
+        // every cut is either too short for its header or doesn't add up to the sizes in it
+        for (size_t length = 0; length < data.size(); ++length)
+        {
+            Fuel copy;
+
+            if (GasCache::decompile(*MappedFile::fromBuffer(std::vector<uint8_t>(data.begin(), data.begin() + length)), copy))
+            {
+                test::fail(__FILE__, __LINE__, "an entry cut to " + std::to_string(length) + " bytes decompiled");
+            }
+        }
+
+        std::vector<uint8_t> padded = data;
+        padded.resize(data.size() + 4, 0);
+
+        Fuel paddedCopy;
+        CHECK(!GasCache::decompile(*MappedFile::fromBuffer(std::move(padded)), paddedCopy));
+
+        // a damaged byte anywhere may still decompile to something, but never reads outside the entry
+        for (size_t offset = 0; offset < data.size(); ++offset)
+        {
+            for (const uint8_t value : {uint8_t(0x00), uint8_t(0x7f), uint8_t(0xff)})
+            {
+                std::vector<uint8_t> damaged = data;
+                damaged[offset] = value;
+
+                Fuel copy;
+                GasCache::decompile(*MappedFile::fromBuffer(std::move(damaged)), copy);
+            }
+        }
+
+        // and the same through an entry on disk
+        const TempCache temp("siege-tests-cache-damaged");
+        const GasCache cache(temp.dir);
+
+        cache.store("/world/a.gas", 100, *source, doc);
+
+        const fs::path entry = temp.entry("/world/a.gas");
+
+        fs::resize_file(entry, data.size() - 1);
+        CHECK(cache.load("/world/a.gas", 100, nullptr) == nullptr);
+
+        std::ofstream(entry.string(), std::ios::binary | std::ios::trunc) << "GASC";
+        CHECK(cache.load("/world/a.gas", 100, nullptr) == nullptr);
+    }
+
+    static std::string written(const FuelBlock* block)
+    {
+        std::ostringstream stream;
+
+        if (block != nullptr)
+        {
+            block->write(stream);
+        }
+
+        return stream.str();
+    }
+
+    /*
+     * which blocks and lists b shares with a, by path, as overlay leaves them and as a compiled set has to bring
+     * them back
+     */
+    static std::string sharing(const FuelBlock* a, const FuelBlock* b)
+    {
+        std::ostringstream result;
+
+        std::function<void(const FuelBlock*, const FuelBlock*, const std::string&)> walk = [&](const FuelBlock* x, const FuelBlock* y, const std::string& path) {
+            result << path << (x == y ? " block" : "") << (x->eachChild().begin() == y->eachChild().begin() ? " children" : "")
+                   << (x->eachAttribute().begin() == y->eachAttribute().begin() ? " attributes" : "") << "\n";
+
+            for (const FuelBlock* child : y->eachChild())
+            {
+                if (const FuelBlock* other = x->child(child->name()))
+                {
+                    walk(other, child, path + ":" + child->name());
+                }
+            }
+        };
+
+        walk(a, b, "");
+
+        return result.str();
+    }
+
+    TEST(cache_set_round_trip)
+    {
+        Fuel base, middle, top;
+        base.load(*toView("[t:template,n:tmpl]\n{\n\ta = 1;\n\tb = 2;\n\t[aspect] { model = m; [sub] { v = 1; } }\n\t[common] { x = 1; }\n\t[physics] { mass = 1; }\n}\n"));
+        middle.load(*toView("[t:template,n:tmpl]\n{\n\tb = 3;\n\t[aspect] { model = m2; }\n}\n"));
+        top.load(*toView("[t:template,n:tmpl]\n{\n\tc = 4;\n\t[common] { y = 2; }\n}\n"));
+
+        const FuelBlock* baseTmpl = base.child("tmpl");
+        const FuelBlock* middleTmpl = middle.child("tmpl");
+        const FuelBlock* topTmpl = top.child("tmpl");
+
+        CHECK(baseTmpl != nullptr && middleTmpl != nullptr && topTmpl != nullptr);
+
+        if (baseTmpl == nullptr || middleTmpl == nullptr || topTmpl == nullptr)
+        {
+            return;
+        }
+
+        // what eager resolving without sharing gives
+        FuelArena eagerArena;
+
+        FuelBlock* eagerMiddle = baseTmpl->clone(eagerArena);
+        middleTmpl->merge(eagerMiddle);
+
+        FuelBlock* eagerTop = baseTmpl->clone(eagerArena);
+        middleTmpl->merge(eagerTop);
+        topTmpl->merge(eagerTop);
+
+        FuelArena arena;
+
+        const FuelBlock* overlaidMiddle = middleTmpl->overlay(baseTmpl, arena);
+        const FuelBlock* overlaidTop = topTmpl->overlay(overlaidMiddle, arena);
+
+        const std::string middleSharing = sharing(baseTmpl, overlaidMiddle);
+        const std::string topSharing = sharing(overlaidMiddle, overlaidTop);
+
+        // the overlays have to share something for the set to have anything to keep
+        CHECK(middleSharing.find(":common block") != std::string::npos);
+        CHECK(topSharing.find(":aspect block") != std::string::npos);
+
+        const std::vector<std::string> messages = {"first message", "", "third message"};
+        const auto data = MappedFile::fromBuffer(GasCache::compileSet({{"base", baseTmpl}, {"middle", overlaidMiddle}, {"top", overlaidTop}}, 7, messages));
+
+        FuelArena setArena;
+        std::vector<std::pair<std::string_view, FuelBlock*>> roots;
+        std::vector<std::string> setMessages;
+
+        CHECK(GasCache::decompileSet(*data, 7, setArena, roots, &setMessages));
+        CHECK_EQ(roots.size(), size_t(3));
+        CHECK(setMessages == messages);
+
+        if (roots.size() != 3)
+        {
+            return;
+        }
+
+        CHECK_EQ(roots[0].first, "base");
+        CHECK_EQ(roots[1].first, "middle");
+        CHECK_EQ(roots[2].first, "top");
+
+        CHECK_EQ(written(roots[0].second), written(baseTmpl));
+        CHECK_EQ(written(roots[1].second), written(eagerMiddle));
+        CHECK_EQ(written(roots[2].second), written(eagerTop));
+
+        CHECK_EQ(sharing(roots[0].second, roots[1].second), middleSharing);
+        CHECK_EQ(sharing(roots[1].second, roots[2].second), topSharing);
+    }
+
+    TEST(cache_set_rejects_other_key)
+    {
+        Fuel doc;
+        doc.load(*toView(cacheSource));
+
+        const std::vector<uint8_t> data = GasCache::compileSet({{"a", doc.child("a")}, {"b", doc.child("b")}}, 7, {"message"});
+
+        FuelArena arena;
+        std::vector<std::pair<std::string_view, FuelBlock*>> roots;
+        std::vector<std::string> messages;
+
+        CHECK(!GasCache::decompileSet(*MappedFile::fromBuffer(data), 8, arena, roots, &messages));
+        CHECK(roots.empty());
+        CHECK(messages.empty());
+
+        // a set compiled by the gas cache isn't a set at all
+        CHECK(!GasCache::decompileSet(*MappedFile::fromBuffer(GasCache::compile(doc, "/world/a.gas", 100, 0)), 7, arena, roots, &messages));
+
+        for (size_t length = 0; length < data.size(); ++length)
+        {
+            if (GasCache::decompileSet(*MappedFile::fromBuffer(std::vector<uint8_t>(data.begin(), data.begin() + length)), 7, arena, roots, &messages))
+            {
+                test::fail(__FILE__, __LINE__, "a set cut to " + std::to_string(length) + " bytes decompiled");
+            }
+        }
+
+        CHECK(GasCache::decompileSet(*MappedFile::fromBuffer(data), 7, arena, roots, &messages));
+        CHECK_EQ(roots.size(), size_t(2));
+        CHECK_EQ(messages.size(), size_t(1));
+    }
+} // namespace ehb
@@ -0,0 +1,289 @@
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/ostream_sink.h>
+
+#include "Test.hpp"
+
+#include "benchmarks/MemoryFileSys.hpp"
+#include "game/ContentDb.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    static constexpr int CHAIN_DEPTH = 64;
+
+    /*
+     * a template set with everything resolving has to cope with: a long specializes chain spread over several
+     * files with every specialization ahead of its super, a loop with a template hanging off it, a template whose
+     * super doesn't exist and names defined twice, in two files and in one
+     */
+    static void addTemplates(MemoryFileSys& fileSys)
+    {
+        fileSys.add("/world/contentdb/templates/base.gas",
+                    "[t:template,n:base]\n{\n\tcategory_name = base;\n\t[aspect]\n\t{\n\t\tmodel = m_base;\n\t\tscale = 1;\n\t}\n\t[common] { x = 1; }\n}\n");
+
+        std::string chains[4];
+
+        for (int i = CHAIN_DEPTH - 1; i >= 0; --i)
+        {
+            std::ostringstream text;
+            text << "[t:template,n:chain_" << i << "]\n{\n";
+            text << "\tspecializes = " << (i == 0 ? std::string("base") : "chain_" + std::to_string(i - 1)) << ";\n";
+            text << "\tlevel = " << i << ";\n";
+            text << "\t[aspect] { scale = " << i << "; }\n";
+            text << "\t[extra_" << i << "] { v = " << i << "; }\n";
+            text << "}\n";
+
+            chains[i % 4] += text.str();
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            fileSys.add("/world/contentdb/templates/chain/chain_" + std::to_string(i) + ".gas", chains[i]);
+        }
+
+        fileSys.add("/world/contentdb/templates/broken.gas",
+                    "[t:template,n:loop_a] { specializes = loop_b; a = 1; }\n"
+                    "[t:template,n:loop_b] { specializes = loop_a; b = 1; }\n"
+                    "[t:template,n:loop_child] { specializes = loop_a; c = 1; }\n"
+                    "[t:template,n:orphan] { specializes = nowhere; [aspect] { model = m_orphan; } }\n"
+                    "[t:template,n:twice] { which = first; }\n"
+                    "[t:template,n:twice] { which = second; }\n");
+
+        fileSys.add("/world/contentdb/templates/zz_duplicate.gas", "[t:template,n:base] { category_name = duplicate; }\n");
+    }
+
+    static std::vector<std::string> templateNames()
+    {
+        std::vector<std::string> result = {"base", "loop_a", "loop_b", "loop_child", "orphan", "twice", "nowhere"};
+
+        for (int i = 0; i < CHAIN_DEPTH; ++i)
+        {
+            result.emplace_back("chain_" + std::to_string(i));
+        }
+
+        return result;
+    }
+
+    //! every template as it saves, asked for deepest first so lazy mode resolves whole chains in one lookup
+    static std::string describe(const ContentDb& db)
+    {
+        std::vector<std::string> names = templateNames();
+        std::reverse(names.begin(), names.end());
+
+        std::ostringstream result;
+
+        for (const auto& name : names)
+        {
+            result << "== " << name << "\n";
+
+            if (const FuelBlock* tmpl = db.getGameObjectTmpl(name))
+            {
+                tmpl->write(result);
+            }
+            else
+            {
+                result << "<unresolved>\n";
+            }
+        }
+
+        return result.str();
+    }
+
+    // a snapshot file of its own that is gone again when the case is done
+    struct TempSnapshot
+    {
+        const fs::path file;
+
+        explicit TempSnapshot(const std::string& name) :
+            file(fs::temp_directory_path() / name)
+        {
+            fs::remove(file);
+        }
+
+        ~TempSnapshot()
+        {
+            std::error_code ec;
+            fs::remove(file, ec);
+        }
+    };
+
+    //! what is logged at error level while it is alive goes here instead of wherever the log sent it
+    class CapturedErrors
+    {
+    public:
+        CapturedErrors() :
+            log(spdlog::get("log")), sinks(log->sinks()), level(log->level())
+        {
+            auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(stream);
+            sink->set_pattern("%v");
+
+            log->sinks() = {sink};
+            log->set_level(spdlog::level::err);
+        }
+
+        ~CapturedErrors()
+        {
+            log->sinks() = sinks;
+            log->set_level(level);
+        }
+
+        std::string str() const { return stream.str(); }
+
+    private:
+        std::ostringstream stream;
+
+        std::shared_ptr<spdlog::logger> log;
+        std::vector<spdlog::sink_ptr> sinks;
+        spdlog::level::level_enum level;
+    };
+
+    TEST(content_resolves_template_set)
+    {
+        MemoryFileSys fileSys;
+        addTemplates(fileSys);
+
+        ContentDb db;
+        db.init(fileSys);
+
+        const FuelBlock* deepest = db.getGameObjectTmpl("chain_" + std::to_string(CHAIN_DEPTH - 1));
+        CHECK(deepest != nullptr);
+
+        if (deepest != nullptr)
+        {
+            CHECK_EQ(deepest->valueOf("level"), std::to_string(CHAIN_DEPTH - 1));
+            CHECK_EQ(deepest->valueOf("aspect:scale"), std::to_string(CHAIN_DEPTH - 1));
+            CHECK_EQ(deepest->valueOf("aspect:model"), "m_base");
+            CHECK_EQ(deepest->valueOf("common:x"), "1");
+            CHECK_EQ(deepest->valueOf("extra_0:v"), "0");
+            CHECK_EQ(deepest->eachChild().size(), size_t(2 + CHAIN_DEPTH));
+        }
+
+        CHECK_EQ(db.queryString("chain_0:aspect:scale"), "0");
+        CHECK_EQ(db.queryString("chain_1:extra_0:v"), "0");
+        CHECK_EQ(db.queryString("chain_0:extra_1:v", "none"), "none");
+
+        // nothing on a loop resolves, nor does anything specializing it
+        CHECK(db.getGameObjectTmpl("loop_a") == nullptr);
+        CHECK(db.getGameObjectTmpl("loop_b") == nullptr);
+        CHECK(db.getGameObjectTmpl("loop_child") == nullptr);
+
+        // a missing super is resolved as if there was none
+        CHECK_EQ(db.queryString("orphan:aspect:model"), "m_orphan");
+        CHECK(db.getGameObjectTmpl("nowhere") == nullptr);
+
+        // the first definition of a name wins, files are taken in order
+        CHECK_EQ(db.queryString("base:category_name"), "base");
+        CHECK_EQ(db.queryString("twice:which"), "first");
+    }
+
+    TEST(content_modes_agree)
+    {
+        MemoryFileSys fileSys;
+        addTemplates(fileSys);
+
+        std::string expected;
+        {
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", ContentDb::Mode::Eager);
+            expected = describe(db);
+        }
+
+        {
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", ContentDb::Mode::Lazy);
+            CHECK_EQ(describe(db), expected);
+        }
+
+        const TempSnapshot snapshot("siege-tests-content.snapshot");
+
+        // eager writes the snapshot before init returns, after that both modes reload it
+        for (const auto mode : {ContentDb::Mode::Eager, ContentDb::Mode::Eager, ContentDb::Mode::Lazy})
+        {
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", mode, snapshot.file.string());
+            CHECK_EQ(describe(db), expected);
+            CHECK(fs::exists(snapshot.file));
+        }
+
+        fs::remove(snapshot.file);
+
+        // lazy writes it on a thread of its own, which has to be left to finish before the ContentDb goes
+        {
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", ContentDb::Mode::Lazy, snapshot.file.string());
+            CHECK_EQ(describe(db), expected);
+
+            for (int i = 0; i < 500 && !fs::exists(snapshot.file); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            CHECK(fs::exists(snapshot.file));
+        }
+
+        for (const auto mode : {ContentDb::Mode::Eager, ContentDb::Mode::Lazy})
+        {
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", mode, snapshot.file.string());
+            CHECK_EQ(describe(db), expected);
+        }
+    }
+
+    TEST(content_snapshot_replays_diagnostics)
+    {
+        MemoryFileSys fileSys;
+        addTemplates(fileSys);
+
+        const TempSnapshot snapshot("siege-tests-content-diagnostics.snapshot");
+
+        std::string cold;
+        {
+            CapturedErrors errors;
+
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", ContentDb::Mode::Eager, snapshot.file.string());
+
+            cold = errors.str();
+        }
+
+        CHECK(cold.find("orphan (nowhere)") != std::string::npos);
+        CHECK(cold.find("loops back on itself") != std::string::npos);
+
+        // a warm start has nothing left to resolve, the errors come out of the snapshot as they went in
+        for (const auto mode : {ContentDb::Mode::Eager, ContentDb::Mode::Lazy})
+        {
+            CapturedErrors errors;
+
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", mode, snapshot.file.string());
+
+            CHECK_EQ(errors.str(), cold);
+        }
+
+        // once a template file changes the snapshot is out of date, along with the errors in it
+        fileSys.add("/world/contentdb/templates/broken.gas", "[t:template,n:orphan] { specializes = base; }\n");
+
+        {
+            CapturedErrors errors;
+
+            ContentDb db;
+            db.init(fileSys, "/world/contentdb/templates/", ContentDb::Mode::Eager, snapshot.file.string());
+
+            CHECK_EQ(db.queryString("orphan:aspect:model"), "m_base");
+            CHECK_EQ(errors.str(), "");
+        }
+    }
+} // namespace ehb
@@ -0,0 +1,458 @@
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+#include "TankWriter.hpp"
+#include "Test.hpp"
+
+#include "cfg/IConfig.hpp"
+#include "io/LayeredFileSys.hpp"
+#include "io/LocalFileSys.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    //! just the strings LayeredFileSys and LocalFileSys read out of a config
+    class TestConfig : public IConfig
+    {
+    public:
+        std::map<std::string, std::string> values;
+
+        bool getBool(const std::string& /*key*/, bool defaultValue) const override { return defaultValue; }
+        float getFloat(const std::string& /*key*/, float defaultValue) const override { return defaultValue; }
+        int getInt(const std::string& /*key*/, int defaultValue) const override { return defaultValue; }
+
+        const std::string& getString(const std::string& key, const std::string& defaultValue) const override
+        {
+            const auto itr = values.find(key);
+
+            return itr != values.end() ? itr->second : defaultValue;
+        }
+    };
+
+    // a directory of its own under the temp directory that is gone again when the case is done
+    struct TempTree
+    {
+        const fs::path root;
+
+        explicit TempTree(const std::string& name) :
+            root(fs::temp_directory_path() / name)
+        {
+            fs::remove_all(root);
+            fs::create_directories(root);
+        }
+
+        ~TempTree()
+        {
+            std::error_code ec;
+            fs::remove_all(root, ec);
+        }
+
+        fs::path add(const std::string& filename, const std::string& text) const
+        {
+            const fs::path path = root / filename;
+
+            fs::create_directories(path.parent_path());
+            std::ofstream(path.string(), std::ios::binary) << text;
+
+            return path;
+        }
+
+        fs::path addTank(const std::string& filename, const std::string& tag, uint32_t priority = TankWriter::PRIORITY) const
+        {
+            TankWriter writer;
+            writer.priority = priority;
+
+            const std::vector<uint8_t> tank = writer.write(tag + " raw", tag + " packed");
+
+            return add(filename, std::string(tank.begin(), tank.end()));
+        }
+    };
+
+    static std::string contents(IFileSys& fileSys, const std::string& filename)
+    {
+        if (auto stream = fileSys.createInputStream(filename))
+        {
+            return std::string(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+        }
+
+        return "<missing>";
+    }
+
+    /*
+     * every layer the game stacks, each holding world/raw.gas and world/packed.gas: loose bits with a file of
+     * their own, a mod directory of archives and a mod archive named directly, a map directory whose archives
+     * sort by name the other way around from their priorities, and a resource archive
+     */
+    static void addLayers(const TempTree& tree)
+    {
+        tree.add("bits/world/raw.gas", "bits raw");
+        tree.add("bits/world/bits_only.gas", "bits only");
+
+        tree.addTank("mods/second.dsres", "second mod");
+        tree.addTank("single/first.dsres", "first mod");
+
+        tree.addTank("maps/a_low.dsmap", "low map", 0x1000);
+        tree.addTank("maps/b_high.dsmap", "high map", 0x2000);
+
+        tree.addTank("res/res.dsres", "res");
+    }
+
+    TEST(files_layer_priority)
+    {
+        const TempTree tree("siege-tests-layers");
+        addLayers(tree);
+
+        const auto path = [&](const char* name) { return (tree.root / name).string(); };
+
+        const auto layered = [&](std::map<std::string, std::string> values) {
+            TestConfig config;
+            config.values = std::move(values);
+            config.values["cache-dir"] = path("cache");
+
+            auto fileSys = std::make_unique<LayeredFileSys>();
+            fileSys->init(config);
+
+            return fileSys;
+        };
+
+        {
+            // mod paths are in priority order, the first one listed wins
+            auto fileSys = layered({{"bits", path("bits")}, {"mod_paths", path("single/first.dsres") + ";" + path("mods")}, {"map_paths", path("maps")}, {"res_paths", path("res")}});
+
+            CHECK_EQ(contents(*fileSys, "/world/raw.gas"), "bits raw");
+            CHECK_EQ(contents(*fileSys, "/world/bits_only.gas"), "bits only");
+            CHECK_EQ(contents(*fileSys, "/world/packed.gas"), "first mod packed");
+            CHECK_EQ(contents(*fileSys, "/world/none.gas"), "<missing>");
+
+            // lookups don't care about case or which way the slashes go
+            CHECK_EQ(contents(*fileSys, "World\\Packed.gas"), "first mod packed");
+
+            CHECK(fileSys->lastWriteTime("/world/raw.gas") != 0);
+            CHECK_EQ(fileSys->lastWriteTime("/world/packed.gas"), static_cast<int64_t>(TankWriter::FILE_TIME));
+        }
+
+        {
+            auto fileSys = layered({{"mod_paths", path("mods") + ";" + path("single")}, {"res_paths", path("res")}});
+
+            CHECK_EQ(contents(*fileSys, "/world/raw.gas"), "second mod raw");
+        }
+
+        {
+            // the archives of a directory are stacked by priority, not by name
+            auto fileSys = layered({{"map_paths", path("maps")}, {"res_paths", path("res")}});
+
+            CHECK_EQ(contents(*fileSys, "/world/raw.gas"), "high map raw");
+            CHECK_EQ(contents(*fileSys, "/world/packed.gas"), "high map packed");
+        }
+
+        {
+            auto fileSys = layered({{"map_paths", path("maps/a_low.dsmap")}, {"res_paths", path("res")}});
+
+            CHECK_EQ(contents(*fileSys, "/world/raw.gas"), "low map raw");
+        }
+
+        {
+            auto fileSys = layered({{"res_paths", path("res")}});
+
+            CHECK_EQ(contents(*fileSys, "/world/raw.gas"), "res raw");
+        }
+    }
+
+    TEST(files_merged_directory_contents)
+    {
+        const TempTree tree("siege-tests-layers-merged");
+        addLayers(tree);
+
+        TestConfig config;
+        config.values = {{"bits", (tree.root / "bits").string()}, {"res_paths", (tree.root / "res").string()}, {"cache-dir", (tree.root / "cache").string()}};
+
+        LayeredFileSys fileSys;
+        fileSys.init(config);
+
+        // every layer adds to a listing, a path more than one layer has is listed once
+        const FileList world = {"/world/bits_only.gas", "/world/packed.gas", "/world/raw.gas"};
+        CHECK(fileSys.getDirectoryContents("/world") == world);
+        CHECK(fileSys.getDirectoryContents("World\\") == world);
+        CHECK(fileSys.getFilesUnder("/world/") == world);
+
+        const FileList root = {"/art", "/world"};
+        CHECK(fileSys.getDirectoryContents("/") == root);
+
+        const FileList all = {"/art", "/world", "/world/bits_only.gas", "/world/packed.gas", "/world/raw.gas"};
+        CHECK(fileSys.getFiles() == all);
+
+        CHECK(fileSys.getDirectoryContents("/art").empty());
+        CHECK(fileSys.getDirectoryContents("/none").empty());
+    }
+
+    static std::string readFile(const fs::path& path)
+    {
+        std::ifstream stream(path.string(), std::ios::binary);
+
+        return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+
+    static void writeFile(const fs::path& path, const std::string& text)
+    {
+        std::ofstream(path.string(), std::ios::binary | std::ios::trunc) << text;
+    }
+
+    //! the index LocalFileSys keeps in cacheDir, there is only ever one bits directory per case
+    static fs::path indexCache(const fs::path& cacheDir)
+    {
+        std::error_code ec;
+
+        for (const auto& entry : fs::directory_iterator(cacheDir, ec))
+        {
+            if (entry.path().filename().string().compare(0, 10, "fileindex-") == 0)
+            {
+                return entry.path();
+            }
+        }
+
+        return fs::path();
+    }
+
+    /*
+     * a file listed in the cache under directory that isn't on disk, it only shows up in the index as long as the
+     * cached listing of directory is trusted
+     */
+    static std::string plant(const std::string& cache, const std::string& directory, const std::string& file)
+    {
+        std::istringstream stream(cache);
+        std::string result;
+
+        for (std::string line; std::getline(stream, line);)
+        {
+            result += line + "\n";
+
+            if (line.compare(0, 2, "D ") == 0 && line.size() > directory.size() && line.compare(line.size() - directory.size() - 1, std::string::npos, " " + directory) == 0)
+            {
+                result += "F " + directory + "/" + file + "\n";
+            }
+        }
+
+        return result;
+    }
+
+    // adding or removing an entry moves the write time of its directory, this makes sure it does so visibly
+    static void touch(const fs::path& directory)
+    {
+        fs::last_write_time(directory, fs::last_write_time(directory) + std::chrono::seconds(2));
+    }
+
+    static void addBits(const TempTree& tree)
+    {
+        tree.add("bits/a.gas", "a");
+        tree.add("bits/world/b.gas", "b");
+        tree.add("bits/world/deep/c.gas", "c");
+    }
+
+    static const FileList bitsFiles = {"/a.gas", "/world", "/world/b.gas", "/world/deep", "/world/deep/c.gas"};
+
+    TEST(files_index_cache_reuse)
+    {
+        const TempTree tree("siege-tests-index");
+        addBits(tree);
+
+        const fs::path bits = tree.root / "bits", cache = tree.root / "cache";
+
+        CHECK(LocalFileSys(bits, cache).getFiles() == bitsFiles);
+
+        const fs::path index = indexCache(cache);
+        CHECK(!index.empty());
+
+        if (index.empty())
+        {
+            return;
+        }
+
+        const std::string planted = plant(readFile(index), "world", "planted.gas");
+        CHECK(planted != readFile(index));
+
+        writeFile(index, planted);
+
+        // a rewrite would come out the same, the write time is what shows whether there was one
+        const auto written = fs::last_write_time(index) - std::chrono::hours(1);
+        fs::last_write_time(index, written);
+
+        // nothing changed on disk, so the cached listings are taken as they are and the cache isn't written again
+        LocalFileSys fileSys(bits, cache);
+
+        FileList expected = bitsFiles;
+        expected.emplace("/world/planted.gas");
+
+        CHECK(fileSys.getFiles() == expected);
+        CHECK(fileSys.getDirectoryContents("/World/").count("/world/planted.gas") == 1);
+        CHECK_EQ(readFile(index), planted);
+        CHECK(fs::last_write_time(index) == written);
+
+        CHECK_EQ(contents(fileSys, "/world/deep/c.gas"), "c");
+    }
+
+    TEST(files_index_cache_invalidation)
+    {
+        const TempTree tree("siege-tests-index-invalidation");
+        addBits(tree);
+
+        const fs::path bits = tree.root / "bits", cache = tree.root / "cache";
+
+        LocalFileSys(bits, cache).getFiles();
+
+        const fs::path index = indexCache(cache);
+        CHECK(!index.empty());
+
+        if (index.empty())
+        {
+            return;
+        }
+
+        writeFile(index, plant(plant(readFile(index), "world", "planted.gas"), "world/deep", "planted.gas"));
+
+        // only the directory that changed is listed again, the one below it still comes from the cache
+        tree.add("bits/world/new.gas", "new");
+        touch(bits / "world");
+
+        {
+            FileList expected = bitsFiles;
+            expected.emplace("/world/new.gas");
+            expected.emplace("/world/deep/planted.gas");
+
+            CHECK(LocalFileSys(bits, cache).getFiles() == expected);
+            CHECK(readFile(index).find("F world/planted.gas") == std::string::npos);
+        }
+
+        // a directory that is gone takes everything cached below it along
+        fs::remove_all(bits / "world" / "deep");
+        touch(bits / "world");
+
+        {
+            const FileList expected = {"/a.gas", "/world", "/world/b.gas", "/world/new.gas"};
+
+            CHECK(LocalFileSys(bits, cache).getFiles() == expected);
+            CHECK(readFile(index).find("deep") == std::string::npos);
+        }
+
+        // as does one nothing on disk leads to any more, even with every directory that is there unchanged
+        writeFile(index, readFile(index) + "D 1 ghost\nF ghost/g.gas\n");
+
+        {
+            const FileList expected = {"/a.gas", "/world", "/world/b.gas", "/world/new.gas"};
+
+            CHECK(LocalFileSys(bits, cache).getFiles() == expected);
+            CHECK(readFile(index).find("ghost") == std::string::npos);
+        }
+
+        // and refresh picks up what changed since the index was built
+        LocalFileSys fileSys(bits, cache);
+        fileSys.getFiles();
+
+        fs::remove(bits / "world" / "b.gas");
+        tree.add("bits/late.gas", "late");
+        touch(bits);
+        touch(bits / "world");
+
+        fileSys.refresh();
+
+        const FileList expected = {"/a.gas", "/late.gas", "/world", "/world/new.gas"};
+        CHECK(fileSys.getFiles() == expected);
+    }
+
+    TEST(files_damaged_index_cache)
+    {
+        const TempTree tree("siege-tests-index-damaged");
+        addBits(tree);
+
+        const fs::path bits = tree.root / "bits", cache = tree.root / "cache";
+
+        LocalFileSys(bits, cache).getFiles();
+
+        const fs::path index = indexCache(cache);
+        CHECK(!index.empty());
+
+        if (index.empty())
+        {
+            return;
+        }
+
+        const std::string valid = readFile(index);
+
+        // the planted entry is read before the damage, it can't be kept either
+        const std::string planted = plant(valid, "world", "planted.gas");
+        const std::string header = valid.substr(0, valid.find('\n', valid.find('\n') + 1) + 1);
+
+        const std::vector<std::string> damaged = {
+            "",
+            "OpenSiegeFileIndex 0\n" + valid.substr(valid.find('\n') + 1),
+            "OpenSiegeFileIndex 1\n/somewhere/else\n" + planted.substr(header.size()),
+            header + "F stray.gas\n" + planted.substr(header.size()),
+            planted + "D notanumber world\n",
+            planted + "D 12\n",
+            planted + "D 12x world\n",
+            planted + "X junk\n",
+            planted + "F\n",
+            planted.substr(0, planted.size() - 1) + "\n\n",
+        };
+
+        for (size_t i = 0; i < damaged.size(); ++i)
+        {
+            writeFile(index, damaged[i]);
+
+            if (!(LocalFileSys(bits, cache).getFiles() == bitsFiles))
+            {
+                test::fail(__FILE__, __LINE__, "damaged cache " + std::to_string(i) + " was trusted");
+            }
+
+            // the walk that replaced it wrote a good one back
+            CHECK_EQ(readFile(index), valid);
+        }
+    }
+
+    TEST(files_directory_links)
+    {
+        const TempTree tree("siege-tests-index-links");
+
+        tree.add("bits/world/real/x.gas", "x");
+
+        const fs::path world = tree.root / "bits" / "world";
+
+        std::error_code ec;
+        fs::create_symlink("real/x.gas", world / "alias.gas", ec);
+
+        // a platform or account that can't make links has nothing to test here
+        if (ec)
+        {
+            return;
+        }
+
+        fs::create_directory_symlink("real", world / "link", ec);
+        fs::create_directory_symlink("..", world / "loop", ec);
+        fs::create_symlink("missing.gas", world / "dangling.gas", ec);
+
+        CHECK(!ec);
+
+        // a link to a file is served as the file, links to directories are left alone so the loop can't be walked
+        const FileList expected = {"/world", "/world/alias.gas", "/world/real", "/world/real/x.gas"};
+
+        const fs::path bits = tree.root / "bits", cache = tree.root / "cache";
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            LocalFileSys fileSys(bits, cache);
+
+            CHECK(fileSys.getFiles() == expected);
+            CHECK_EQ(contents(fileSys, "/world/alias.gas"), "x");
+        }
+    }
+} // namespace ehb
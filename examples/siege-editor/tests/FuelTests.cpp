@@ -0,0 +1,151 @@
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "Test.hpp"
+
+#include "io/Fuel.hpp"
+#include "io/MappedFile.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    /*
+     * what the parser makes of a document in both recovery modes, the form the .expected files are written in
+     *
+     * the text is parsed out of a buffer of exactly its size so a read past the end shows up under a sanitizer
+     */
+    static std::string describe(const std::string& text)
+    {
+        std::ostringstream result;
+
+        for (const auto recovery : {FuelRecovery::FailFast, FuelRecovery::NextBlock})
+        {
+            const InputView view = MappedFile::fromBuffer(std::vector<uint8_t>(text.begin(), text.end()));
+
+            std::vector<FuelDiagnostic> diagnostics;
+            Fuel doc;
+
+            const bool ok = doc.load(*view, recovery, &diagnostics);
+
+            result << (recovery == FuelRecovery::FailFast ? "== fail fast" : "== next block") << (ok ? "" : ", rejected") << "\n";
+
+            for (const auto& diagnostic : diagnostics)
+            {
+                result << diagnostic.line << ":" << diagnostic.column << ": " << diagnostic.message << "\n";
+            }
+
+            if (ok)
+            {
+                doc.write(result);
+            }
+        }
+
+        return result.str();
+    }
+
+    static std::string readText(const fs::path& path)
+    {
+        std::ifstream stream(path.string(), std::ios::binary);
+        std::ostringstream text;
+        text << stream.rdbuf();
+
+        return text.str();
+    }
+
+    /*
+     * every fixtures/fuel/<name>.gas against its <name>.expected, set SIEGE_TESTS_UPDATE to write the
+     * .expected files from what the parser does now instead
+     */
+    TEST(fuel_fixtures)
+    {
+        const bool update = std::getenv("SIEGE_TESTS_UPDATE") != nullptr;
+
+        size_t count = 0;
+
+        for (const auto& entry : fs::directory_iterator(fs::path(test::fixtureDir()) / "fuel"))
+        {
+            fs::path path = entry.path();
+
+            if (path.extension() != ".gas")
+            {
+                continue;
+            }
+
+            const std::string actual = describe(readText(path));
+
+            path.replace_extension(".expected");
+
+            if (update)
+            {
+                std::ofstream(path.string(), std::ios::binary) << actual;
+            }
+            else if (actual != readText(path))
+            {
+                test::fail(path.string().c_str(), 1, "does not match what the parser makes of the fixture:\n" + actual);
+            }
+
+            ++count;
+        }
+
+        CHECK(count != 0);
+    }
+
+    // a stream and a mapping of the same text have to give the same tree
+    TEST(fuel_stream_matches_mapping)
+    {
+        const std::string text = readText(fs::path(test::fixtureDir()) / "fuel" / "syntax.gas");
+
+        std::istringstream stream(text);
+        Fuel fromStream, fromMapping;
+
+        CHECK(fromStream.load(stream));
+        CHECK(fromMapping.load(*MappedFile::fromBuffer(std::vector<uint8_t>(text.begin(), text.end()))));
+
+        std::ostringstream a, b;
+        fromStream.write(a);
+        fromMapping.write(b);
+
+        CHECK_EQ(a.str(), b.str());
+    }
+
+    // numbers convert the way strtol and strtof read them, a single leading '+' included
+    TEST(fuel_number_signs)
+    {
+        std::istringstream stream("[a]\n{\n\tplus = +5;\n\tminus = -3;\n\tspaced =   +7;\n\tx hex = +0x10;\n\ttwice = +-5;\n"
+                                  "\tdouble = ++5;\n\tlone = +;\n\tscale = +1.5;\n\tnegative = +-1.5;\n\tlist = +1,-2,+3;\n}\n");
+
+        Fuel doc;
+        CHECK(doc.load(stream));
+
+        const FuelBlock* a = doc.child("a");
+        CHECK(a != nullptr);
+
+        if (a == nullptr)
+        {
+            return;
+        }
+
+        CHECK_EQ(a->valueAsInt("plus"), 5);
+        CHECK_EQ(a->valueAsInt("minus"), -3);
+        CHECK_EQ(a->valueAsInt("spaced"), 7);
+        CHECK_EQ(a->valueAsUInt("plus"), 5u);
+        CHECK_EQ(a->valueAsUInt("hex"), 16u);
+        CHECK_EQ(a->valueAsInt("twice", 99), 99);
+        CHECK_EQ(a->valueAsInt("double", 99), 99);
+        CHECK_EQ(a->valueAsInt("lone", 99), 99);
+        CHECK_EQ(a->valueAsFloat("scale"), 1.5f);
+        CHECK_EQ(a->valueAsFloat("negative", 9.f), 9.f);
+
+        const std::array<float, 3> list = {1.f, -2.f, 3.f};
+        CHECK(a->valueAsFloat3("list") == list);
+    }
+} // namespace ehb
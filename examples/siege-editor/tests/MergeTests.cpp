@@ -0,0 +1,174 @@
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <sstream>
+
+#include "Test.hpp"
+
+#include "io/Fuel.hpp"
+
+namespace ehb
+{
+    //! FuelBlock::merge as it was before it indexed names, on plain copies of the blocks
+    struct ReferenceBlock
+    {
+        std::string name;
+        std::string type;
+        std::vector<ReferenceBlock> children;
+        std::vector<std::array<std::string, 3>> attributes;
+
+        explicit ReferenceBlock(const FuelBlock& block) :
+            name(block.name()), type(block.type())
+        {
+            for (const FuelBlock* child : block.eachChild())
+            {
+                children.emplace_back(*child);
+            }
+
+            for (const Attribute& attr : block.eachAttribute())
+            {
+                attributes.push_back({std::string(attr.name), std::string(attr.type), std::string(attr.value)});
+            }
+        }
+
+        void merge(ReferenceBlock& result) const
+        {
+            result.name = name;
+            result.type = type;
+
+            if (children.empty() && attributes.empty())
+            {
+                return;
+            }
+
+            for (const ReferenceBlock& i : children)
+            {
+                auto j = std::find_if(result.children.begin(), result.children.end(), [&i](const ReferenceBlock& j) { return j.name == i.name; });
+
+                if (j != result.children.end())
+                {
+                    i.merge(*j);
+                }
+                else
+                {
+                    result.children.push_back(i);
+                }
+            }
+
+            for (const auto& i : attributes)
+            {
+                auto j = std::find_if(result.attributes.begin(), result.attributes.end(), [&i](const auto& j) { return j[0] == i[0]; });
+
+                if (j != result.attributes.end())
+                {
+                    *j = i;
+                }
+                else
+                {
+                    result.attributes.push_back(i);
+                }
+            }
+        }
+
+        bool operator==(const ReferenceBlock& other) const
+        {
+            return name == other.name && type == other.type && children == other.children && attributes == other.attributes;
+        }
+    };
+
+    /*
+     * a random block with width attributes and children, names come from a pool a little larger than width so
+     * overrides both match and append, and repeat within a list. nested blocks stay small
+     */
+    static void writeMergeBlock(std::mt19937& rng, std::ostream& stream, const std::string& header, uint32_t width, uint32_t depth)
+    {
+        static const std::array<const char*, 3> types = {"", "i ", "f "};
+
+        const uint32_t pool = width + width / 4 + 1;
+
+        stream << header << "\n{\n";
+
+        for (uint32_t i = 0; i < width; ++i)
+        {
+            stream << types[rng() % types.size()] << "v" << rng() % pool << " = " << rng() % 100 << ";\n";
+        }
+
+        if (depth < 2)
+        {
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                const std::string name = "b" + std::to_string(rng() % pool);
+                const uint32_t nested = rng() % 8 == 0 ? 0 : rng() % 6;
+
+                writeMergeBlock(rng, stream, rng() % 3 == 0 ? "[t:kind" + std::to_string(rng() % 2) + ",n:" + name + "]" : "[" + name + "]", nested, depth + 1);
+            }
+        }
+
+        stream << "}\n";
+    }
+
+    static std::unique_ptr<Fuel> randomMergeDoc(std::mt19937& rng, uint32_t width)
+    {
+        std::stringstream stream;
+        writeMergeBlock(rng, stream, "[t:template,n:tmpl]", width, 0);
+
+        auto doc = std::make_unique<Fuel>();
+        doc->load(stream);
+
+        return doc;
+    }
+
+    /*
+     * a template specialized twice, resolved with clone and merge and with overlay, both have to match the
+     * reference. merge only indexes lists of 64 entries or more, the widths sit on both sides of that and
+     * 63 crosses it halfway through a merge
+     */
+    TEST(merge_matches_reference)
+    {
+        std::mt19937 rng(20240613);
+
+        for (const uint32_t width : {0u, 5u, 63u, 64u, 65u, 200u})
+        {
+            for (uint32_t round = 0; round < 20; ++round)
+            {
+                const auto base = randomMergeDoc(rng, width), middle = randomMergeDoc(rng, width), top = randomMergeDoc(rng, width);
+
+                const FuelBlock* baseTmpl = base->child("tmpl");
+                const FuelBlock* middleTmpl = middle->child("tmpl");
+                const FuelBlock* topTmpl = top->child("tmpl");
+
+                CHECK(baseTmpl != nullptr && middleTmpl != nullptr && topTmpl != nullptr);
+
+                if (baseTmpl == nullptr || middleTmpl == nullptr || topTmpl == nullptr)
+                {
+                    return;
+                }
+
+                ReferenceBlock expected(*baseTmpl);
+                ReferenceBlock(*middleTmpl).merge(expected);
+                ReferenceBlock(*topTmpl).merge(expected);
+
+                FuelArena arena;
+
+                FuelBlock* merged = baseTmpl->clone(arena);
+                middleTmpl->merge(merged);
+                topTmpl->merge(merged);
+
+                const FuelBlock* overlaid = topTmpl->overlay(middleTmpl->overlay(baseTmpl, arena), arena);
+
+                const std::string where = "width " + std::to_string(width) + ", round " + std::to_string(round);
+
+                if (!(ReferenceBlock(*merged) == expected))
+                {
+                    test::fail(__FILE__, __LINE__, "merge and the reference disagree at " + where);
+                }
+
+                if (!(ReferenceBlock(*overlaid) == expected))
+                {
+                    test::fail(__FILE__, __LINE__, "overlay and the reference disagree at " + where);
+                }
+            }
+        }
+    }
+} // namespace ehb
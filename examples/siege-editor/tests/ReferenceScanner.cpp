@@ -0,0 +1,551 @@
+/*
+ * This file is part of gas
+ *
+ * Copyright (C) 2017 aaron andersen <aaron@fosslib.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "ReferenceScanner.hpp"
+
+#include "io/FuelParser.hpp"
+
+namespace ehb::test
+{
+    int ReferenceScanner::scan(std::string_view* yylval)
+    {
+#define YYCTYPE char
+#define YYCURSOR cursor
+#define YYLIMIT limit
+#define YYMARKER marker
+#define YYFILL(n) do {} while (0)
+
+// the end of the input reads as a null character, which every state treats as the end of the file
+#define YYPEEK() (YYCURSOR < YYLIMIT ? *YYCURSOR : '\0')
+
+#define yytext std::string_view(start, cursor - start)
+
+        while (1)
+        {
+            const char* start = cursor;
+
+            // whatever state we are in, running out of input ends it
+            if (cursor >= limit)
+            {
+                return 0;
+            }
+
+            if (state.empty())
+            {
+                /*
+                 * HACK: line 35 of ui/interfaces/backend/console_output/console_output.gas: [t:window;n:rollover_console]
+                 * there is a typo here as the ';' should be a ','
+                 */
+
+                {
+                    unsigned char yych;
+
+                    if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
+                    yych = YYPEEK();
+                    if (yych <= ':')
+                    {
+                        if (yych <= ' ')
+                        {
+                            if (yych <= '\n')
+                            {
+                                if (yych <= 0x00) goto yy27;
+                                if (yych <= 0x08) goto yy29;
+                                if (yych <= '\t') goto yy22;
+                                goto yy24;
+                            }
+                            else
+                            {
+                                if (yych == '\r') goto yy22;
+                                if (yych <= 0x1F) goto yy29;
+                                goto yy22;
+                            }
+                        }
+                        else
+                        {
+                            if (yych <= ',')
+                            {
+                                if (yych == '*') goto yy20;
+                                if (yych <= '+') goto yy29;
+                                goto yy14;
+                            }
+                            else
+                            {
+                                if (yych == '/') goto yy2;
+                                if (yych <= '9') goto yy20;
+                                goto yy12;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        if (yych <= ']')
+                        {
+                            if (yych <= '@')
+                            {
+                                if (yych <= ';') goto yy16;
+                                if (yych == '=') goto yy18;
+                                goto yy29;
+                            }
+                            else
+                            {
+                                if (yych <= 'Z') goto yy20;
+                                if (yych <= '[') goto yy4;
+                                if (yych <= '\\') goto yy29;
+                                goto yy6;
+                            }
+                        }
+                        else
+                        {
+                            if (yych <= 'z')
+                            {
+                                if (yych == '_') goto yy20;
+                                if (yych <= '`') goto yy29;
+                                goto yy20;
+                            }
+                            else
+                            {
+                                if (yych <= '{') goto yy8;
+                                if (yych == '}') goto yy10;
+                                goto yy29;
+                            }
+                        }
+                    }
+                yy2:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    if (yych == '*') goto yy34;
+                    if (yych == '/') goto yy36;
+                yy3 :
+                {
+                    return static_cast<unsigned char>(start[0]);
+                }
+                yy4:
+                    ++YYCURSOR;
+                    {
+                        return '[';
+                    }
+                yy6:
+                    ++YYCURSOR;
+                    {
+                        return ']';
+                    }
+                yy8:
+                    ++YYCURSOR;
+                    {
+                        return '{';
+                    }
+                yy10:
+                    ++YYCURSOR;
+                    {
+                        return '}';
+                    }
+                yy12:
+                    ++YYCURSOR;
+                    {
+                        return ':';
+                    }
+                yy14:
+                    ++YYCURSOR;
+                    {
+                        return ',';
+                    }
+                yy16:
+                    ++YYCURSOR;
+                    {
+                        return ',';
+                    }
+                yy18:
+                    ++YYCURSOR;
+                    {
+                        state.push(expression_statement);
+                        return '=';
+                    }
+                yy20:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy33;
+                yy21 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Identifier);
+                }
+                yy22:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy31;
+                yy23 :
+                {
+                    continue;
+                }
+                yy24:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                    if (yych == '\n') goto yy24;
+                    {
+                        continue;
+                    }
+                yy27:
+                    ++YYCURSOR;
+                    {
+                        return 0;
+                    }
+                yy29:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy3;
+                yy30:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                yy31:
+                    if (yych <= '\f')
+                    {
+                        if (yych == '\t') goto yy30;
+                        goto yy23;
+                    }
+                    else
+                    {
+                        if (yych <= '\r') goto yy30;
+                        if (yych == ' ') goto yy30;
+                        goto yy23;
+                    }
+                yy32:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                yy33:
+                    if (yych <= '9')
+                    {
+                        if (yych <= ',')
+                        {
+                            if (yych == '*') goto yy32;
+                            goto yy21;
+                        }
+                        else
+                        {
+                            if (yych == '/') goto yy21;
+                            goto yy32;
+                        }
+                    }
+                    else
+                    {
+                        if (yych <= '^')
+                        {
+                            if (yych <= '@') goto yy21;
+                            if (yych <= 'Z') goto yy32;
+                            goto yy21;
+                        }
+                        else
+                        {
+                            if (yych == '`') goto yy21;
+                            if (yych <= 'z') goto yy32;
+                            goto yy21;
+                        }
+                    }
+                yy34:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) return 0; // unterminated block comment
+                    yych = YYPEEK();
+                    if (yych == '*') goto yy39;
+                    goto yy34;
+                yy36:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                    if (yych <= '\n')
+                    {
+                        if (yych <= 0x00) goto yy38;
+                        if (yych <= '\t') goto yy36;
+                    }
+                    else
+                    {
+                        if (yych != '\r') goto yy36;
+                    }
+                yy38 :
+                {
+                    continue;
+                }
+                yy39:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                    if (yych != '/') goto yy34;
+                    ++YYCURSOR;
+                    {
+                        continue;
+                    }
+                }
+            }
+            else if (state.top() == embedded_statement)
+            {
+
+                {
+                    unsigned char yych;
+                    if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
+                    yych = YYPEEK();
+                    if (yych <= 0x1F)
+                    {
+                        if (yych <= '\n')
+                        {
+                            if (yych <= 0x08) goto yy50;
+                            if (yych <= '\t') goto yy47;
+                            goto yy49;
+                        }
+                        else
+                        {
+                            if (yych == '\r') goto yy47;
+                            goto yy50;
+                        }
+                    }
+                    else
+                    {
+                        if (yych <= '/')
+                        {
+                            if (yych <= ' ') goto yy47;
+                            if (yych <= '.') goto yy50;
+                        }
+                        else
+                        {
+                            if (yych == ']') goto yy46;
+                            goto yy50;
+                        }
+                    }
+                    ++YYCURSOR;
+                    if ((yych = YYPEEK()) == '/') goto yy53;
+                yy45 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy46:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    if (yych == ']') goto yy51;
+                    goto yy45;
+                yy47:
+                    ++YYCURSOR;
+                yy48 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy49:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy48;
+                yy50:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy45;
+                yy51:
+                    ++YYCURSOR;
+                    {
+                        state.pop();
+                        return (*yylval = yytext, FuelParser::token::Expression);
+                    }
+                yy53:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                    if (yych <= '\n')
+                    {
+                        if (yych <= 0x00) goto yy55;
+                        if (yych <= '\t') goto yy53;
+                    }
+                    else
+                    {
+                        if (yych != '\r') goto yy53;
+                    }
+                yy55 :
+                {
+                    continue;
+                }
+                }
+            }
+            else if (state.top() == expression_statement)
+            {
+
+                {
+                    unsigned char yych;
+                    if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
+                    yych = YYPEEK();
+                    if (yych <= '!')
+                    {
+                        if (yych <= '\f')
+                        {
+                            if (yych <= 0x08) goto yy68;
+                            if (yych <= '\t') goto yy65;
+                            if (yych <= '\n') goto yy67;
+                            goto yy68;
+                        }
+                        else
+                        {
+                            if (yych <= '\r') goto yy65;
+                            if (yych == ' ') goto yy65;
+                            goto yy68;
+                        }
+                    }
+                    else
+                    {
+                        if (yych <= ':')
+                        {
+                            if (yych <= '"') goto yy63;
+                            if (yych != '/') goto yy68;
+                        }
+                        else
+                        {
+                            if (yych <= ';') goto yy60;
+                            if (yych == '[') goto yy62;
+                            goto yy68;
+                        }
+                    }
+                    ++YYCURSOR;
+                    if ((yych = YYPEEK()) == '/') goto yy71;
+                yy59 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy60:
+                    ++YYCURSOR;
+                    {
+                        state.pop();
+                        return ';';
+                    }
+                yy62:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    if (yych == '[') goto yy69;
+                    goto yy59;
+                yy63:
+                    ++YYCURSOR;
+                    {
+                        state.push(string_literal);
+                        return (*yylval = yytext, FuelParser::token::Expression);
+                    }
+                yy65:
+                    ++YYCURSOR;
+                yy66 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy67:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy66;
+                yy68:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy59;
+                yy69:
+                    ++YYCURSOR;
+                    {
+                        state.push(embedded_statement);
+                        return (*yylval = yytext, FuelParser::token::Expression);
+                    }
+                yy71:
+                    ++YYCURSOR;
+                    if (YYLIMIT <= YYCURSOR) YYFILL(1);
+                    yych = YYPEEK();
+                    if (yych <= '\n')
+                    {
+                        if (yych <= 0x00) goto yy73;
+                        if (yych <= '\t') goto yy71;
+                    }
+                    else
+                    {
+                        if (yych != '\r') goto yy71;
+                    }
+                yy73 :
+                {
+                    continue;
+                }
+                }
+            }
+            else if (state.top() == string_literal)
+            {
+
+                {
+                    unsigned char yych;
+                    if ((YYLIMIT - YYCURSOR) < 2) YYFILL(2);
+                    yych = YYPEEK();
+                    if (yych <= 0x1F)
+                    {
+                        if (yych <= '\n')
+                        {
+                            if (yych <= 0x08) goto yy83;
+                            if (yych <= '\t') goto yy78;
+                            goto yy80;
+                        }
+                        else
+                        {
+                            if (yych == '\r') goto yy78;
+                            goto yy83;
+                        }
+                    }
+                    else
+                    {
+                        if (yych <= '"')
+                        {
+                            if (yych <= ' ') goto yy78;
+                            if (yych <= '!') goto yy83;
+                        }
+                        else
+                        {
+                            if (yych == '\\') goto yy81;
+                            goto yy83;
+                        }
+                    }
+                    ++YYCURSOR;
+                    {
+                        state.pop();
+                        return (*yylval = yytext, FuelParser::token::Expression);
+                    }
+                yy78:
+                    ++YYCURSOR;
+                yy79 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy80:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy79;
+                yy81:
+                    ++YYCURSOR;
+                    if ((yych = YYPEEK()) == '.') goto yy84;
+                yy82 :
+                {
+                    return (*yylval = yytext, FuelParser::token::Expression);
+                }
+                yy83:
+                    ++YYCURSOR;
+                    yych = YYPEEK();
+                    goto yy82;
+                yy84:
+                    ++YYCURSOR;
+                    {
+                        return (*yylval = yytext, FuelParser::token::Expression);
+                    }
+                }
+            }
+
+            assert(false);
+        }
+    }
+} // namespace ehb::test
@@ -0,0 +1,62 @@
+/*
+ * This file is part of gas
+ *
+ * Copyright (C) 2017 aaron andersen <aaron@fosslib.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stack>
+#include <string_view>
+
+namespace ehb::test
+{
+    /*
+     * FuelScanner as it was before it skipped whitespace, comments and value text in bulk: the plain re2c state
+     * machine stepping one byte at a time and returning every byte of an expression as a token of its own
+     *
+     * the scanner tests hold FuelScanner's token stream against this one. the only change from the original is that
+     * a stray character goes to the parser as a token, which is what FuelScanner does with it now
+     */
+    class ReferenceScanner
+    {
+    public:
+        ReferenceScanner(const char* content, size_t length);
+
+        int scan(std::string_view* yylval);
+
+    private:
+        enum
+        {
+            embedded_statement,
+            expression_statement,
+            string_literal
+        };
+
+    private:
+        std::stack<int> state;
+
+        const char* cursor;
+        const char* limit;
+        const char* marker;
+    };
+
+    inline ReferenceScanner::ReferenceScanner(const char* content, size_t length) :
+        cursor(content), limit(content + length)
+    {
+    }
+} // namespace ehb::test
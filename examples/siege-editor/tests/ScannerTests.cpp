@@ -0,0 +1,169 @@
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+#include "ReferenceScanner.hpp"
+#include "Test.hpp"
+
+#include "io/FuelParser.hpp"
+#include "io/FuelScanner.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    /*
+     * the token stream a scanner makes of text, one token per line
+     *
+     * consecutive expressions are joined the way the parser joins them, FuelScanner hands out whole runs where the
+     * reference hands out single bytes. the text is scanned out of a buffer of exactly its size so a read past the
+     * end shows up under a sanitizer
+     */
+    template <typename Scanner>
+    static std::string tokenStream(const std::string& text)
+    {
+        const std::vector<char> buffer(text.begin(), text.end());
+
+        Scanner scanner(buffer.data(), buffer.size());
+
+        std::ostringstream result;
+        std::string expression;
+
+        std::string_view value;
+        for (int type; (type = scanner.scan(&value)) != 0;)
+        {
+            if (type == FuelParser::token::Expression)
+            {
+                expression += value;
+                continue;
+            }
+
+            if (!expression.empty())
+            {
+                result << "expression '" << expression << "'\n";
+                expression.clear();
+            }
+
+            if (type == FuelParser::token::Identifier)
+            {
+                result << "identifier '" << value << "'\n";
+            }
+            else
+            {
+                result << "'" << static_cast<char>(type) << "'\n";
+            }
+        }
+
+        if (!expression.empty())
+        {
+            result << "expression '" << expression << "'\n";
+        }
+
+        return result.str();
+    }
+
+    static void checkTokens(const std::string& text)
+    {
+        const std::string actual = tokenStream<FuelScanner>(text);
+        const std::string expected = tokenStream<test::ReferenceScanner>(text);
+
+        if (actual != expected)
+        {
+            std::ostringstream message;
+            message << "token streams differ for\n" << text << "\n  actual:\n" << actual << "  expected:\n" << expected;
+            test::fail(__FILE__, __LINE__, message.str());
+        }
+    }
+
+    // every cut of text, so each run in it also ends at the limit once
+    static void checkPrefixes(const std::string& text)
+    {
+        for (size_t length = 0; length <= text.size(); ++length)
+        {
+            checkTokens(text.substr(0, length));
+        }
+    }
+
+    TEST(fuel_scanner_fixtures)
+    {
+        size_t count = 0;
+
+        for (const auto& entry : fs::directory_iterator(fs::path(test::fixtureDir()) / "fuel"))
+        {
+            if (entry.path().extension() == ".gas")
+            {
+                std::ifstream stream(entry.path(), std::ios::binary);
+                std::ostringstream text;
+                text << stream.rdbuf();
+
+                checkTokens(text.str());
+                ++count;
+            }
+        }
+
+        CHECK(count > 0);
+    }
+
+    TEST(fuel_scanner_run_lengths)
+    {
+        // runs the scanner skips in bulk, from empty to two blocks of sixteen and then some
+        for (size_t length = 0; length <= 33; ++length)
+        {
+            std::string blanks, text, comment;
+
+            for (size_t i = 0; i < length; ++i)
+            {
+                blanks += " \t\r\n"[i % 4];
+                text += (i % 5 == 4) ? ' ' : static_cast<char>('a' + i % 26);
+                comment += (i % 7 == 6) ? '*' : static_cast<char>('a' + i % 26);
+            }
+
+            checkPrefixes("[a]" + blanks + "{" + blanks + "x = 1;" + blanks + "}" + blanks);
+            checkPrefixes("[a]{x = " + text + ";}");
+            checkPrefixes("[a]{s = \"" + text + "\";}");
+            checkPrefixes("[a]{s = \"" + comment + "\\\"" + text + "\";}");
+            checkPrefixes("[a]{e = [[" + text + "]];}");
+            checkPrefixes("[a]{e = [[" + text + "/" + text + "]];}");
+            checkPrefixes("// " + text + "\n[a]{}");
+            checkPrefixes("[a]{x = " + text + "// " + text + "\r\n;}");
+            checkPrefixes("[a]{e = [[" + text + "// " + text + "\n]];}");
+            checkPrefixes("/*" + comment + "*/[a]{}");
+            checkPrefixes("[a]{x = " + text + "/*" + comment + "*/" + text + ";}");
+            checkPrefixes("[a]{e = [[" + text + "/*" + comment + "**/" + text + "]];}");
+        }
+    }
+
+    TEST(fuel_scanner_generated)
+    {
+        // pieces of gas thrown together at random, so the scanner goes through its states in orders no real file has
+        static const char* pieces[] = {
+            "[", "]", "{", "}", "=", ";", ",", ":", "\"", "\\", "[[", "]]", "/", "*", "/*", "*/", "//", " ", "  ", "\t", "\n",
+            "\r\n", "t:", "n:", "name", "x", "1.5", "0x1f", "a b c", "_", "#", "@", "sixteen bytes..", "abcdefghijklmnopqrstuvwxyz",
+            "                                ", "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t",
+        };
+
+        std::mt19937 random(17);
+        std::uniform_int_distribution<size_t> piece(0, std::size(pieces) - 1);
+        std::uniform_int_distribution<size_t> count(0, 80);
+
+        for (int i = 0; i < 4000; ++i)
+        {
+            std::string text;
+
+            for (size_t n = count(random); n > 0; --n)
+            {
+                text += pieces[piece(random)];
+            }
+
+            checkTokens(text);
+        }
+    }
+} // namespace ehb
@@ -0,0 +1,280 @@
+
+#include <cstring>
+#include <initializer_list>
+#include <fstream>
+#include <iterator>
+
+#include "TankWriter.hpp"
+#include "Test.hpp"
+
+#include "io/TankFileSys.hpp"
+
+#ifdef WIN32
+#    include <filesystem>
+namespace fs = std::filesystem;
+#else
+#    include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace ehb
+{
+    static std::string writeTank(const std::string& name, const std::vector<uint8_t>& tank)
+    {
+        const fs::path path = fs::temp_directory_path() / name;
+
+        std::ofstream(path.string(), std::ios::binary).write(reinterpret_cast<const char*>(tank.data()), tank.size());
+
+        return path.string();
+    }
+
+    static std::string readAll(IFileSys& fileSys, const std::string& filename)
+    {
+        if (auto stream = fileSys.createInputStream(filename))
+        {
+            return std::string(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+        }
+
+        return "<missing>";
+    }
+
+    TEST(tank_index_and_data)
+    {
+        const std::string raw = "[a]\n{\n\tx = 1;\n}\n";
+
+        std::string packed;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            packed += "[t:tmpl,n:entry]\n{\n\tvalue = 1;\n}\n";
+        }
+
+        // a chunk of noise zlib can't shrink, followed by a short final chunk
+        packed.resize(4 * TankWriter::CHUNK_SIZE, ' ');
+
+        for (uint32_t i = 0, seed = 1; i < TankWriter::CHUNK_SIZE; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            packed += static_cast<char>(' ' + (seed >> 16) % 94);
+        }
+
+        packed += "tail";
+
+        TankWriter writer;
+        const std::string filename = writeTank("siege-tests.dsres", writer.write(raw, packed));
+
+        CHECK_EQ(writer.storedChunks, size_t(2));
+
+        TankFileSys tank;
+        CHECK(tank.open(filename));
+
+        CHECK_EQ(tank.priority(), TankWriter::PRIORITY);
+
+        const FileList expected = {"/art", "/world", "/world/packed.gas", "/world/raw.gas"};
+        CHECK(tank.getFiles() == expected);
+
+        const FileList world = {"/world/packed.gas", "/world/raw.gas"};
+        CHECK(tank.getDirectoryContents("/World/") == world);
+        CHECK(tank.getDirectoryContents("/art").empty());
+        CHECK(tank.getFilesUnder("/world/") == world);
+
+        // lookups don't care about case or which way the slashes go
+        CHECK_EQ(readAll(tank, "/world/raw.gas"), raw);
+        CHECK_EQ(readAll(tank, "World\\RAW.gas"), raw);
+        CHECK_EQ(readAll(tank, "/world/packed.gas"), packed);
+        CHECK_EQ(readAll(tank, "/world/none.gas"), std::string("<missing>"));
+
+        CHECK_EQ(tank.lastWriteTime("/world/raw.gas"), static_cast<int64_t>(TankWriter::FILE_TIME));
+
+        fs::remove(filename);
+    }
+
+    TEST(tank_rejects_truncated_index)
+    {
+        std::vector<uint8_t> tank = TankWriter().write("[a]{}", "[b]{}");
+        tank.resize(80);
+
+        const std::string filename = writeTank("siege-tests-truncated.dsres", tank);
+
+        TankFileSys fileSys;
+        CHECK(!fileSys.open(filename));
+        CHECK(fileSys.getFiles().empty());
+
+        fs::remove(filename);
+    }
+
+    // counts in the index that don't fit in the archive have to fail the open rather than size an allocation
+    TEST(tank_rejects_oversized_counts)
+    {
+        const std::vector<uint8_t> tank = TankWriter().write("[a]{}", "[b]\n{\n\tx = 1;\n}\n");
+
+        auto get32 = [](const std::vector<uint8_t>& data, size_t offset) {
+            uint32_t value = 0;
+            std::memcpy(&value, data.data() + offset, sizeof(value));
+            return value;
+        };
+
+        auto set32 = [](std::vector<uint8_t> data, size_t offset, uint32_t value) {
+            std::memcpy(data.data() + offset, &value, sizeof(value));
+            return data;
+        };
+
+        const uint32_t dirSetOffset = get32(tank, 12), fileSetOffset = get32(tank, 16);
+
+        // the compressed entry is the second one in the file set, its size is the second dword and its chunk size
+        // follows the 10 character name
+        const size_t packed = fileSetOffset + get32(tank, fileSetOffset + 8);
+        const size_t chunkSize = packed + 4 * 4 + 8 + 2 * 2 + 12 + 4;
+
+        const std::vector<std::vector<uint8_t>> broken = {
+            set32(tank, dirSetOffset, 0xffffffff),
+            set32(tank, fileSetOffset, 0x40000000),
+            set32(set32(tank, packed + 4, 0xffffffff), chunkSize, 1),
+        };
+
+        for (size_t i = 0; i < broken.size(); ++i)
+        {
+            const std::string filename = writeTank("siege-tests-oversized.dsres", broken[i]);
+
+            TankFileSys fileSys;
+            bool opened = true;
+
+            try
+            {
+                opened = fileSys.open(filename);
+            }
+            catch (const std::exception& e)
+            {
+                test::fail(__FILE__, __LINE__, "case " + std::to_string(i) + " threw " + e.what());
+            }
+
+            CHECK(!opened);
+            CHECK(fileSys.getFiles().empty());
+
+            fs::remove(filename);
+        }
+    }
+
+    /*
+     * an LZO1X stream assembled by hand next to the output it has to decode to, see lzo1x_decompress_safe for what
+     * the instructions mean. literal payloads are generated so the long runs don't have to be spelled out
+     */
+    class LzoVector
+    {
+    public:
+        std::vector<uint8_t> in;
+        std::string out;
+
+        LzoVector& bytes(std::initializer_list<uint8_t> values)
+        {
+            in.insert(in.end(), values);
+            return *this;
+        }
+
+        //! literals that are part of the stream and the output both
+        LzoVector& literals(const std::string& text)
+        {
+            in.insert(in.end(), text.begin(), text.end());
+            out += text;
+            return *this;
+        }
+
+        //! what a match does to the output, the instruction for it goes in with bytes
+        LzoVector& match(size_t distance, size_t length)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                out += out[out.size() - distance];
+            }
+
+            return *this;
+        }
+
+        LzoVector& end() { return bytes({0x11, 0x00, 0x00}); }
+    };
+
+    static std::string noise(size_t length)
+    {
+        std::string result;
+
+        for (uint32_t i = 0, seed = 7; i < length; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            result += static_cast<char>((seed >> 16) & 0xff);
+        }
+
+        return result;
+    }
+
+    static std::vector<std::pair<const char*, LzoVector>> lzoVectors()
+    {
+        std::vector<std::pair<const char*, LzoVector>> result;
+
+        // a first byte above 21 is a literal run of that minus 17
+        result.emplace_back("literals only", LzoVector().bytes({17 + 11}).literals("Hello, LZO!").end());
+
+        // matches copying from bytes they wrote themselves, one with a 1 byte and one with a 2 byte distance field
+        result.emplace_back("overlapping short match", LzoVector().bytes({17 + 1}).literals("a").bytes({0xe0, 0x00}).match(1, 8).end());
+        result.emplace_back("overlapping long match", LzoVector().bytes({17 + 3}).literals("abc").bytes({0x20 | 10, 2 << 2, 0x00}).match(3, 12).end());
+
+        // a zero length field is extended by 255 per zero byte: 15 + 255 + 27 + 3 literals, then 31 + 2 * 255 + 57 + 2 matched
+        result.emplace_back("extended lengths", LzoVector().bytes({0x00, 0x00, 27}).literals(noise(300)).bytes({0x20, 0x00, 0x00, 57, (299 & 63) << 2, 299 >> 6}).match(300, 600).end());
+
+        // 15 + 64 * 255 + 162 + 3 literals, then a match further back than 16 KiB extended by one to 10 bytes
+        LzoVector far;
+        far.bytes({0x00});
+        far.in.resize(far.in.size() + 64, 0);
+        result.emplace_back("far match", far.bytes({162}).literals(noise(16500)).bytes({0x10, 0x01, 16 << 2, 0x00}).match(16384 + 16, 10).end());
+
+        /*
+         * right after a literal run an instruction below 16 is a 3 byte match at least 2049 back, here with 2
+         * trailing literals after which the same kind of instruction is a 2 byte match close by instead
+         */
+        LzoVector m1;
+        m1.bytes({0x00});
+        m1.in.resize(m1.in.size() + 8, 0);
+        result.emplace_back("match after a literal run", m1.bytes({42}).literals(noise(2100)).bytes({(1 << 2) | 2, 0x01}).match(2049 + 1 + 4, 3).literals("XY").bytes({2 << 2, 0x00}).match(3, 2).end());
+
+        return result;
+    }
+
+    TEST(tank_lzo_vectors)
+    {
+        for (const auto& [name, vector] : lzoVectors())
+        {
+            std::vector<uint8_t> out(vector.out.size());
+
+            CHECK(TankFileSys::decompressLzo(vector.in.data(), vector.in.size(), out.data(), out.size()));
+
+            if (std::string(out.begin(), out.end()) != vector.out)
+            {
+                test::fail(__FILE__, __LINE__, std::string(name) + " decoded to something else");
+            }
+
+            // the output has to come out at exactly the size it was given
+            std::vector<uint8_t> larger(out.size() + 1);
+            CHECK(!TankFileSys::decompressLzo(vector.in.data(), vector.in.size(), larger.data(), larger.size()));
+            CHECK(!TankFileSys::decompressLzo(vector.in.data(), vector.in.size(), out.data(), out.size() - 1));
+
+            // a copy of every prefix so a read past the end of it shows up under a sanitizer
+            for (size_t length = 0; length < vector.in.size(); ++length)
+            {
+                const std::vector<uint8_t> truncated(vector.in.begin(), vector.in.begin() + length);
+
+                if (TankFileSys::decompressLzo(truncated.data(), truncated.size(), out.data(), out.size()))
+                {
+                    test::fail(__FILE__, __LINE__, std::string(name) + " decoded when cut to " + std::to_string(length) + " bytes");
+                }
+            }
+        }
+    }
+
+    TEST(tank_lzo_rejects_match_before_start)
+    {
+        // a match 9 back after a single literal
+        const std::vector<uint8_t> in = {17 + 1, 'a', 0xe0, 0x01, 0x11, 0x00, 0x00};
+        std::vector<uint8_t> out(9);
+
+        CHECK(!TankFileSys::decompressLzo(in.data(), in.size(), out.data(), out.size()));
+    }
+} // namespace ehb
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "io/TankFileSys.hpp"
+
+namespace ehb
+{
+    /*
+     * writes a small tank with the layout described at the top of TankFileSys.cpp, a root holding World and Art
+     * directories. world/raw.gas is stored and world/packed.gas is zlib compressed in chunks, one of which
+     * doesn't compress and is stored as is the way the retail tanks do it
+     */
+    class TankWriter
+    {
+    public:
+        static constexpr uint64_t FILE_TIME = 0x01d5a0b0c0d0e0f0ull;
+        static constexpr uint32_t CHUNK_SIZE = 64;
+        static constexpr uint32_t PRIORITY = 0x1000;
+
+        // what the header gives as the tank's priority, the higher one wins when tanks are stacked
+        uint32_t priority = PRIORITY;
+
+        // chunks of the compressed file that were written as is
+        size_t storedChunks = 0;
+
+        std::vector<uint8_t> write(const std::string& raw, const std::string& packed)
+        {
+            std::vector<uint8_t> dirSet, fileSet, data;
+
+            // root, world and art, the root is its own parent and has no name
+            const uint32_t root = 4 + 3 * 4, world = root + 4 + 4 + 8 + 4 + 2 * 4, art = world + 4 + 4 + 8 + 8;
+
+            put32(dirSet, 3);
+            put32(dirSet, root);
+            put32(dirSet, world);
+            put32(dirSet, art);
+
+            putDir(dirSet, root, {world, art}, "");
+            putDir(dirSet, root, {}, "World");
+            putDir(dirSet, root, {}, "Art");
+
+            // both file entries are laid out before either of them is written so their offsets are known
+            std::vector<uint8_t> rawEntry, packedEntry;
+
+            putFile(rawEntry, world, raw.size(), 0, TankFileSys::DataFormat::Raw, "Raw.gas");
+            data.insert(data.end(), raw.begin(), raw.end());
+
+            putFile(packedEntry, world, packed.size(), static_cast<uint32_t>(data.size()), TankFileSys::DataFormat::Zlib, "Packed.gas");
+
+            std::vector<uint8_t> chunks;
+            uint32_t compressedSize = 0;
+
+            for (size_t begin = 0; begin < packed.size(); begin += CHUNK_SIZE)
+            {
+                const size_t size = std::min<size_t>(CHUNK_SIZE, packed.size() - begin);
+
+                std::vector<uint8_t> compressed(compressBound(static_cast<uLong>(size)));
+                uLongf length = static_cast<uLongf>(compressed.size());
+
+                compress(compressed.data(), &length, reinterpret_cast<const Bytef*>(packed.data() + begin), static_cast<uLong>(size));
+                compressed.resize(length);
+
+                if (compressed.size() >= size)
+                {
+                    compressed.assign(packed.begin() + begin, packed.begin() + begin + size);
+                    ++storedChunks;
+                }
+
+                put32(chunks, static_cast<uint32_t>(size));
+                put32(chunks, static_cast<uint32_t>(compressed.size()));
+                put32(chunks, 0);
+                put32(chunks, compressedSize);
+
+                data.insert(data.end(), compressed.begin(), compressed.end());
+                compressedSize += static_cast<uint32_t>(compressed.size());
+            }
+
+            put32(packedEntry, compressedSize);
+            put32(packedEntry, CHUNK_SIZE);
+            packedEntry.insert(packedEntry.end(), chunks.begin(), chunks.end());
+
+            put32(fileSet, 2);
+            put32(fileSet, 4 + 2 * 4);
+            put32(fileSet, static_cast<uint32_t>(4 + 2 * 4 + rawEntry.size()));
+            fileSet.insert(fileSet.end(), rawEntry.begin(), rawEntry.end());
+            fileSet.insert(fileSet.end(), packedEntry.begin(), packedEntry.end());
+
+            const uint32_t headerSize = 56, dirSetOffset = headerSize, fileSetOffset = dirSetOffset + static_cast<uint32_t>(dirSet.size());
+            const uint32_t dataOffset = fileSetOffset + static_cast<uint32_t>(fileSet.size());
+
+            std::vector<uint8_t> result(headerSize, 0);
+
+            std::memcpy(result.data(), "DSigTank", 8);
+            set32(result, 8, 0x00010002);
+            set32(result, 12, dirSetOffset);
+            set32(result, 16, fileSetOffset);
+            set32(result, 20, static_cast<uint32_t>(dirSet.size() + fileSet.size()));
+            set32(result, 24, dataOffset);
+            set32(result, 52, priority);
+
+            result.insert(result.end(), dirSet.begin(), dirSet.end());
+            result.insert(result.end(), fileSet.begin(), fileSet.end());
+            result.insert(result.end(), data.begin(), data.end());
+
+            return result;
+        }
+
+    private:
+        static void put16(std::vector<uint8_t>& out, uint16_t value)
+        {
+            out.push_back(static_cast<uint8_t>(value));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        static void put32(std::vector<uint8_t>& out, uint32_t value)
+        {
+            put16(out, static_cast<uint16_t>(value));
+            put16(out, static_cast<uint16_t>(value >> 16));
+        }
+
+        static void put64(std::vector<uint8_t>& out, uint64_t value)
+        {
+            put32(out, static_cast<uint32_t>(value));
+            put32(out, static_cast<uint32_t>(value >> 32));
+        }
+
+        static void set32(std::vector<uint8_t>& out, size_t offset, uint32_t value)
+        {
+            std::vector<uint8_t> bytes;
+            put32(bytes, value);
+            std::copy(bytes.begin(), bytes.end(), out.begin() + offset);
+        }
+
+        static void putName(std::vector<uint8_t>& out, const std::string& name)
+        {
+            put16(out, static_cast<uint16_t>(name.size()));
+            out.insert(out.end(), name.begin(), name.end());
+
+            // the length and the characters together are padded to a dword
+            out.resize(out.size() + (4 - (2 + name.size()) % 4) % 4, 0);
+        }
+
+        static void putDir(std::vector<uint8_t>& out, uint32_t parent, const std::vector<uint32_t>& children, const std::string& name)
+        {
+            put32(out, parent);
+            put32(out, static_cast<uint32_t>(children.size()));
+            put64(out, FILE_TIME);
+            putName(out, name);
+
+            for (const uint32_t child : children)
+            {
+                put32(out, child);
+            }
+        }
+
+        static void putFile(std::vector<uint8_t>& out, uint32_t parent, size_t size, uint32_t offset, TankFileSys::DataFormat format, const std::string& name)
+        {
+            put32(out, parent);
+            put32(out, static_cast<uint32_t>(size));
+            put32(out, offset);
+            put32(out, 0);
+            put64(out, FILE_TIME);
+            put16(out, static_cast<uint16_t>(format));
+            put16(out, 0);
+            putName(out, name);
+        }
+    };
+} // namespace ehb
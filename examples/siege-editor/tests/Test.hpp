@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * just enough of a test framework for siege-tests: cases register themselves with TEST and report through CHECK,
+ * a failed check is recorded and the case carries on so one run shows every mismatch
+ */
+namespace ehb::test
+{
+    struct Case
+    {
+        const char* name;
+        void (*func)();
+    };
+
+    std::vector<Case>& cases();
+
+    struct Register
+    {
+        Register(const char* name, void (*func)()) { cases().push_back({name, func}); }
+    };
+
+    void fail(const char* file, int line, const std::string& message);
+
+    //! the directory the fixtures live in, as passed on the command line
+    const std::string& fixtureDir();
+
+    template <typename A, typename B>
+    void checkEqual(const A& a, const B& b, const char* expression, const char* file, int line)
+    {
+        if (!(a == b))
+        {
+            std::ostringstream message;
+            message << expression << "\n  actual:   " << a << "\n  expected: " << b;
+            fail(file, line, message.str());
+        }
+    }
+} // namespace ehb::test
+
+#define TEST(name)                                                         \
+    static void name();                                                    \
+    static const ehb::test::Register name##Registered(#name, name);        \
+    static void name()
+
+#define CHECK(condition)                                                   \
+    do                                                                     \
+    {                                                                      \
+        if (!(condition)) ehb::test::fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) ehb::test::checkEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
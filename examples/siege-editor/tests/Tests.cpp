@@ -0,0 +1,75 @@
+
+// clang-format off
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// clang-format on
+#include <iostream>
+
+#include "Test.hpp"
+
+/*
+ * siege-tests: regression tests over small fixtures, registered with ctest
+ *
+ * siege-tests <prefix> <fixture dir>
+ *
+ * runs every case whose name starts with prefix, the exit code is the number of cases that failed
+ */
+
+namespace ehb::test
+{
+    static std::string fixtures;
+    static bool failed = false;
+
+    std::vector<Case>& cases()
+    {
+        static std::vector<Case> result;
+        return result;
+    }
+
+    void fail(const char* file, int line, const std::string& message)
+    {
+        std::cerr << file << ":" << line << ": check failed: " << message << "\n";
+        failed = true;
+    }
+
+    const std::string& fixtureDir()
+    {
+        return fixtures;
+    }
+} // namespace ehb::test
+
+int main(int argc, char* argv[])
+{
+    using namespace ehb::test;
+
+    // the code under test logs its warnings, keep them out of the way of the results
+    spdlog::stderr_color_mt("log")->set_level(spdlog::level::off);
+
+    const std::string prefix = argc > 1 ? argv[1] : "";
+    fixtures = argc > 2 ? argv[2] : ".";
+
+    int failures = 0, count = 0;
+
+    for (const auto& test : cases())
+    {
+        if (std::string(test.name).compare(0, prefix.size(), prefix) == 0)
+        {
+            failed = false;
+            test.func();
+
+            std::cout << (failed ? "FAIL " : "ok   ") << test.name << "\n";
+
+            failures += failed ? 1 : 0;
+            ++count;
+        }
+    }
+
+    if (count == 0)
+    {
+        std::cerr << "no test matches " << prefix << "\n";
+        return 1;
+    }
+
+    return failures;
+}
@@ -35,9 +35,10 @@ namespace ehb
 #endif
         if (auto fullFilePath = fileNameMap.findDataFile(filename); !fullFilePath.empty())
         {
-            if (auto file = fileSys.createInputStream(fullFilePath + ".asp"); file != nullptr)
+            if (auto file = fileSys.createInputView(fullFilePath + ".asp"); file != nullptr)
             {
-                return read(*file, options);
+                BinaryReader reader(file);
+                return read(reader, options);
             }
         }
 
@@ -46,9 +47,13 @@ namespace ehb
 
     vsg::ref_ptr<vsg::Object> ReaderWriterASP::read(std::istream& stream, vsg::ref_ptr<const vsg::Options> options) const
     {
-        ByteArray data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
-        BinaryReader reader(data);
+        BinaryReader reader(ByteArray((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()));
 
+        return read(reader, options);
+    }
+
+    vsg::ref_ptr<vsg::Object> ReaderWriterASP::read(BinaryReader& reader, vsg::ref_ptr<const vsg::Options> options) const
+    {
         std::shared_ptr<Aspect::Impl> aspectImpl = std::make_shared<Aspect::Impl>();
 
         uint32_t currentSubMeshIndex;
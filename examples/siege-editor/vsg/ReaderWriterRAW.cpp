@@ -2,6 +2,7 @@
 #include "ReaderWriterRAW.hpp"
 
 //#include <fstream>
+#include "io/BinaryReader.hpp"
 #include "io/FileNameMap.hpp"
 #include "io/IFileSys.hpp"
 #include <vsg/core/Array2D.h>
@@ -21,26 +22,34 @@ namespace ehb
     {
         if (auto fullFilePath = fileNameMap.findDataFile(filename); !fullFilePath.empty())
         {
-            if (auto file = fileSys.createInputStream(fullFilePath + ".raw"); file != nullptr)
+            if (auto file = fileSys.createInputView(fullFilePath + ".raw"); file != nullptr)
             {
-                return read(*file, options);
+                BinaryReader reader(file);
+                return read(reader, options);
             }
         }
 
         return {};
     }
 
-    vsg::ref_ptr<vsg::Object> ReaderWriterRAW::read(std::istream& stream, vsg::ref_ptr<const vsg::Options>) const
+    vsg::ref_ptr<vsg::Object> ReaderWriterRAW::read(std::istream& stream, vsg::ref_ptr<const vsg::Options> options) const
+    {
+        BinaryReader reader(ByteArray((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()));
+
+        return read(reader, options);
+    }
+
+    vsg::ref_ptr<vsg::Object> ReaderWriterRAW::read(BinaryReader& reader, vsg::ref_ptr<const vsg::Options>) const
     {
         uint32_t magic = 0, format = 0;
         uint16_t flags = 0, surfaceCount = 0, width = 0, height = 0;
 
-        stream.read((char*)&magic, sizeof(uint32_t));
-        stream.read((char*)&format, sizeof(uint32_t));
-        stream.read((char*)&flags, sizeof(uint16_t));
-        stream.read((char*)&surfaceCount, sizeof(uint16_t));
-        stream.read((char*)&width, sizeof(uint16_t));
-        stream.read((char*)&height, sizeof(uint16_t));
+        reader.readBytes(&magic, sizeof(uint32_t));
+        reader.readBytes(&format, sizeof(uint32_t));
+        reader.readBytes(&flags, sizeof(uint16_t));
+        reader.readBytes(&surfaceCount, sizeof(uint16_t));
+        reader.readBytes(&width, sizeof(uint16_t));
+        reader.readBytes(&height, sizeof(uint16_t));
 
         if (magic != RAW_MAGIC)
         {
@@ -63,7 +72,8 @@ namespace ehb
         // set the format to BGRA so we don't have to swizzle
         image->setFormat(VK_FORMAT_B8G8R8A8_UNORM);
 
-        stream.read(static_cast<char*>(image->dataPointer()), sizeof(uint8_t) * size);
+        // the only copy we make is straight into the image that gets handed to vulkan
+        reader.readBytes(image->dataPointer(), sizeof(uint8_t) * size);
 
         return image;
     }
@@ -76,11 +76,21 @@ namespace ehb
                 auto objects = vsg::Group::create();
 
                 { // load all objects
+                    std::vector<std::string> objectPaths;
+
                     for (const auto& file : objectFiles)
                     {
-                        if (auto doc = fileSys.loadGasFile(objectspath + "/" + file))
+                        objectPaths.emplace_back(objectspath + "/" + file);
+                    }
+
+                    // parsed side by side, the scene graph is still built in file order below
+                    const FuelBatch docs = fileSys.loadGasBatch(objectPaths);
+
+                    for (size_t i = 0; i < docs.size(); ++i)
+                    {
+                        if (FuelBlock* doc = docs[i])
                         {
-                            log->debug("loading {}", objectspath + "/" + file);
+                            log->debug("loading {}", objectPaths[i]);
 
                             for (const auto& node : doc->eachChild())
                             {
@@ -92,7 +102,7 @@ namespace ehb
                                     // aspect is our visual
                                     if (const auto& aspect = go->child("aspect"))
                                     {
-                                        if (auto model = vsg::read_cast<Aspect>(aspect->valueOf("model", "m_i_glb_placeholder"), options))
+                                        if (auto model = vsg::read_cast<Aspect>(std::string(aspect->valueOf("model", "m_i_glb_placeholder")), options))
                                         {
                                             t->addChild(model);
                                         }
@@ -130,11 +140,26 @@ namespace ehb
 
     vsg::ref_ptr<vsg::Object> ReaderWriterRegion::read(std::istream& stream, vsg::ref_ptr<const vsg::Options> options) const
     {
-        if (Fuel doc; doc.load(stream))
+        static constexpr FuelPath regionGuid("region:guid");
+
+        /*
+         * the guid sits at the top of main.gas and reading stops as soon as it turns up, so only a syntax error in
+         * front of it rejects the file. whatever comes after the guid is deliberately never looked at here
+         */
+        if (FuelPathReader reader(regionGuid); readFuel(stream, reader))
         {
+            unsigned int guid = 0;
+
+            if (!reader.found() || !parseFuelValue(reader.type(), reader.value(), guid))
+            {
+                log->critical("main.gas has no usable region:guid, found '{}'", reader.value());
+
+                return {};
+            }
+
             auto region = Region::create();
 
-            region->setValue("guid", doc.valueAsUInt("region:guid"));
+            region->setValue("guid", guid);
 
             return region;
         }
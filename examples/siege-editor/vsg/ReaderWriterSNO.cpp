@@ -16,6 +16,7 @@
 #include <vsg/state/DescriptorSet.h>
 #include <vsg/traversals/ComputeBounds.h>
 
+#include "io/BinaryReader.hpp"
 #include "io/FileNameMap.hpp"
 #include "io/LocalFileSys.hpp"
 
@@ -34,9 +35,10 @@ namespace ehb
     {
         if (auto fullFilePath = fileNameMap.findDataFile(filename); !fullFilePath.empty())
         {
-            if (auto file = fileSys.createInputStream(fullFilePath + ".sno"); file != nullptr)
+            if (auto file = fileSys.createInputView(fullFilePath + ".sno"); file != nullptr)
             {
-                return read(*file, options);
+                BinaryReader reader(file);
+                return read(reader, options);
             }
         }
 
@@ -44,12 +46,19 @@ namespace ehb
     }
 
     vsg::ref_ptr<vsg::Object> ReaderWriterSNO::read(std::istream& stream, vsg::ref_ptr<const vsg::Options> options) const
+    {
+        BinaryReader reader(ByteArray((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()));
+
+        return read(reader, options);
+    }
+
+    vsg::ref_ptr<vsg::Object> ReaderWriterSNO::read(BinaryReader& reader, vsg::ref_ptr<const vsg::Options> options) const
     {
         uint32_t magic, version, unk1;
 
-        stream.read((char*)&magic, sizeof(uint32_t));
-        stream.read((char*)&version, sizeof(uint32_t));
-        stream.read((char*)&unk1, sizeof(uint32_t));
+        reader.readBytes(&magic, sizeof(uint32_t));
+        reader.readBytes(&version, sizeof(uint32_t));
+        reader.readBytes(&unk1, sizeof(uint32_t));
 
         if (magic != SNO_MAGIC)
             return {};
@@ -60,25 +69,25 @@ namespace ehb
         uint32_t unk5 = 0, unk6 = 0, unk7 = 0, unk8 = 0;
         float checksum = 0.0f;
 
-        stream.read((char*)&doorCount, sizeof(uint32_t));
-        stream.read((char*)&spotCount, sizeof(uint32_t));
-        stream.read((char*)&cornerCount, sizeof(uint32_t));
-        stream.read((char*)&faceCount, sizeof(uint32_t));
-        stream.read((char*)&textureCount, sizeof(uint32_t));
-        stream.read((char*)&minX, sizeof(float));
-        stream.read((char*)&minY, sizeof(float));
-        stream.read((char*)&minZ, sizeof(float));
-        stream.read((char*)&maxX, sizeof(float));
-        stream.read((char*)&maxY, sizeof(float));
-        stream.read((char*)&maxZ, sizeof(float));
-        stream.read((char*)&unk2, sizeof(float));
-        stream.read((char*)&unk3, sizeof(float));
-        stream.read((char*)&unk4, sizeof(float));
-        stream.read((char*)&unk5, sizeof(uint32_t));
-        stream.read((char*)&unk6, sizeof(uint32_t));
-        stream.read((char*)&unk7, sizeof(uint32_t));
-        stream.read((char*)&unk8, sizeof(uint32_t));
-        stream.read((char*)&checksum, sizeof(float));
+        reader.readBytes(&doorCount, sizeof(uint32_t));
+        reader.readBytes(&spotCount, sizeof(uint32_t));
+        reader.readBytes(&cornerCount, sizeof(uint32_t));
+        reader.readBytes(&faceCount, sizeof(uint32_t));
+        reader.readBytes(&textureCount, sizeof(uint32_t));
+        reader.readBytes(&minX, sizeof(float));
+        reader.readBytes(&minY, sizeof(float));
+        reader.readBytes(&minZ, sizeof(float));
+        reader.readBytes(&maxX, sizeof(float));
+        reader.readBytes(&maxY, sizeof(float));
+        reader.readBytes(&maxZ, sizeof(float));
+        reader.readBytes(&unk2, sizeof(float));
+        reader.readBytes(&unk3, sizeof(float));
+        reader.readBytes(&unk4, sizeof(float));
+        reader.readBytes(&unk5, sizeof(uint32_t));
+        reader.readBytes(&unk6, sizeof(uint32_t));
+        reader.readBytes(&unk7, sizeof(uint32_t));
+        reader.readBytes(&unk8, sizeof(uint32_t));
+        reader.readBytes(&checksum, sizeof(float));
 
         // construct the actual mesh node
         vsg::ref_ptr<SiegeNodeMesh> group = SiegeNodeMesh::create();
@@ -89,22 +98,22 @@ namespace ehb
             int32_t id = 0, count = 0;
             float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a10 = 0.0f, a11 = 0.0f, a12 = 0.0f, a20 = 0.0f, a21 = 0.0f, a22 = 0.0f, x = 0.0f, y = 0.0f, z = 0.0f;
 
-            stream.read((char*)&id, sizeof(int32_t));
-            stream.read((char*)&x, sizeof(float));
-            stream.read((char*)&y, sizeof(float));
-            stream.read((char*)&z, sizeof(float));
-            stream.read((char*)&a00, sizeof(float));
-            stream.read((char*)&a01, sizeof(float));
-            stream.read((char*)&a02, sizeof(float));
-            stream.read((char*)&a10, sizeof(float));
-            stream.read((char*)&a11, sizeof(float));
-            stream.read((char*)&a12, sizeof(float));
-            stream.read((char*)&a20, sizeof(float));
-            stream.read((char*)&a21, sizeof(float));
-            stream.read((char*)&a22, sizeof(float));
-            stream.read((char*)&count, sizeof(int32_t));
-
-            stream.seekg(count * 4, std::ios::cur);
+            reader.readBytes(&id, sizeof(int32_t));
+            reader.readBytes(&x, sizeof(float));
+            reader.readBytes(&y, sizeof(float));
+            reader.readBytes(&z, sizeof(float));
+            reader.readBytes(&a00, sizeof(float));
+            reader.readBytes(&a01, sizeof(float));
+            reader.readBytes(&a02, sizeof(float));
+            reader.readBytes(&a10, sizeof(float));
+            reader.readBytes(&a11, sizeof(float));
+            reader.readBytes(&a12, sizeof(float));
+            reader.readBytes(&a20, sizeof(float));
+            reader.readBytes(&a21, sizeof(float));
+            reader.readBytes(&a22, sizeof(float));
+            reader.readBytes(&count, sizeof(int32_t));
+
+            reader.skipBytes(count * 4);
 
             /*
              * this is pretty straight forward but just documenting that osg and
@@ -151,8 +160,8 @@ namespace ehb
             std::string tmp;
 
             // rot, pos, string?
-            stream.seekg(44, std::ios_base::cur);
-            std::getline(stream, tmp, '\0');
+            reader.skipBytes(44);
+            tmp = reader.readString();
         }
 
         // create vertex data per entire mesh
@@ -167,22 +176,22 @@ namespace ehb
             float x = 0.0f, y = 0.0f, z = 0.0f, nX = 0.0f, nY = 0.0f, nZ = 0.0f, tX = 0.0f, tY = 0.0f;
             uint8_t r = 0, g = 0, b = 0, a = 0;
 
-            stream.read((char*)&x, sizeof(float));
-            stream.read((char*)&y, sizeof(float));
-            stream.read((char*)&z, sizeof(float));
+            reader.readBytes(&x, sizeof(float));
+            reader.readBytes(&y, sizeof(float));
+            reader.readBytes(&z, sizeof(float));
 
-            stream.read((char*)&nX, sizeof(float));
-            stream.read((char*)&nY, sizeof(float));
-            stream.read((char*)&nZ, sizeof(float));
+            reader.readBytes(&nX, sizeof(float));
+            reader.readBytes(&nY, sizeof(float));
+            reader.readBytes(&nZ, sizeof(float));
 
             // this is swizzled
-            stream.read((char*)&r, sizeof(uint8_t));
-            stream.read((char*)&b, sizeof(uint8_t));
-            stream.read((char*)&g, sizeof(uint8_t));
-            stream.read((char*)&a, sizeof(uint8_t));
+            reader.readBytes(&r, sizeof(uint8_t));
+            reader.readBytes(&b, sizeof(uint8_t));
+            reader.readBytes(&g, sizeof(uint8_t));
+            reader.readBytes(&a, sizeof(uint8_t));
 
-            stream.read((char*)&tX, sizeof(float));
-            stream.read((char*)&tY, sizeof(float));
+            reader.readBytes(&tX, sizeof(float));
+            reader.readBytes(&tY, sizeof(float));
 
             (*vertices)[index].set(x, y, z);
             (*normals)[index].set(nX, nY, nZ);
@@ -196,11 +205,11 @@ namespace ehb
             uint32_t start, span, count;
 
             // the textureName here is associated with the material name on export - this matches a texture name
-            std::getline(stream, textureName, '\0');
+            textureName = reader.readString();
 
-            stream.read((char*)&start, sizeof(uint32_t));
-            stream.read((char*)&span, sizeof(uint32_t));
-            stream.read((char*)&count, sizeof(uint32_t));
+            reader.readBytes(&start, sizeof(uint32_t));
+            reader.readBytes(&span, sizeof(uint32_t));
+            reader.readBytes(&count, sizeof(uint32_t));
 
             auto attributeArrays = vsg::DataList{vertices, colors, tcoords};
 
@@ -210,7 +219,7 @@ namespace ehb
             {
                 uint16_t value;
 
-                stream.read((char*)&value, sizeof(uint16_t));
+                reader.readBytes(&value, sizeof(uint16_t));
                 (*indicies)[j] = start + value;
             }
 
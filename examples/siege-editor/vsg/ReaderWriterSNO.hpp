@@ -9,6 +9,7 @@ namespace ehb
 {
     class IFileSys;
     class FileNameMap;
+    class BinaryReader;
     class ReaderWriterSNO : public vsg::Inherit<vsg::ReaderWriter, ReaderWriterSNO>
     {
     public:
@@ -17,6 +18,9 @@ namespace ehb
         virtual vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> = {}) const override;
         virtual vsg::ref_ptr<vsg::Object> read(std::istream& stream, vsg::ref_ptr<const vsg::Options> = {}) const override;
 
+    private:
+        vsg::ref_ptr<vsg::Object> read(BinaryReader& reader, vsg::ref_ptr<const vsg::Options> options) const;
+
     private:
         IFileSys& fileSys;
 
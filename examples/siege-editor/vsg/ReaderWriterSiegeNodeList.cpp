@@ -26,12 +26,20 @@ namespace ehb
 
         log->info("about to build region with path : {} and simpleFilename {}", filename, simpleFilename);
 
-        InputStream stream = fileSys.createInputStream(filename);
+        if (InputView file = fileSys.createInputView(filename))
+        {
+            return read(*file, options);
+        }
 
-        return read(*stream, options);
+        return {};
     }
 
     vsg::ref_ptr<vsg::Object> ReaderWriterSiegeNodeList::read(std::istream& stream, vsg::ref_ptr<const vsg::Options> options) const
+    {
+        return read(*MappedFile::fromStream(stream), options);
+    }
+
+    vsg::ref_ptr<vsg::Object> ReaderWriterSiegeNodeList::read(const MappedFile& file, vsg::ref_ptr<const vsg::Options> options) const
     {
         const auto nodeMeshGuidDb = options->getObject<SiegeNodeMeshGUIDDatabase>("SiegeNodeMeshGuidDatabase");
 
@@ -42,21 +50,13 @@ namespace ehb
             return {};
         }
 
-        struct DoorEntry
-        {
-            uint32_t id;
-            uint32_t farDoor;
-            uint32_t farGuid;
-        };
-
-        std::unordered_multimap<uint32_t, DoorEntry> doorMap;
-        std::unordered_map<uint32_t, vsg::MatrixTransform*> nodeMap;
-        std::set<uint32_t> completeSet;
+        DoorMap doorMap;
+        NodeMap nodeMap;
 
         // there are way to many of these containers -.-
         std::set<vsg::ref_ptr<SiegeNodeMesh>> uniqueMeshes;
 
-        if (Fuel doc; doc.load(stream))
+        if (Fuel doc; doc.load(file))
         {
             auto group = vsg::Group::create();
 
@@ -66,7 +66,7 @@ namespace ehb
                 // const uint64_t meshGuid = node->valueAsUInt("mesh_guid");
                 const std::string meshGuid = convertToLowerCase(node->valueOf("mesh_guid"));
 
-                const std::string& texSetAbbr = node->valueOf("texsetabbr");
+                const std::string texSetAbbr(node->valueOf("texsetabbr"));
 
                 // log->info("nodeGuid: {}, meshGuid: {}, texSetAbbr: '{}'", nodeGuid, meshGuid, texSetAbbr);
 
@@ -77,7 +77,7 @@ namespace ehb
                     e.id = child->valueAsInt("id");
                     e.farDoor = child->valueAsInt("fardoor");
                     // NOTE: explicitly not using valueAsUInt because of 64bit value
-                    e.farGuid = std::stoul(child->valueOf("farguid"), nullptr, 16);
+                    e.farGuid = std::stoul(std::string(child->valueOf("farguid")), nullptr, 16);
 
                     doorMap.emplace(nodeGuid, std::move(e));
                 }
@@ -134,41 +134,59 @@ namespace ehb
             log->info("there are {} unique meshes in this region", uniqueMeshes.size());
 
             // now position it all
-            const uint32_t targetGuid = doc.valueAsUInt("siege_node_list:targetnode");
+            static constexpr FuelPath targetNode("siege_node_list:targetnode");
 
-            std::function<void(const uint32_t)> func;
+            const uint32_t targetGuid = doc.valueAsUInt(targetNode);
 
-            func = [&func, &doorMap, &nodeMap, &completeSet](const uint32_t guid) {
-                if (completeSet.insert(guid).second)
-                {
-                    auto targetNode = nodeMap[guid];
+            connectDoors(targetGuid, doorMap, nodeMap);
 
-                    const auto range = doorMap.equal_range(guid);
+            log->info("region loaded with {} nodes, targetGuid: 0x{:x}", group->children.size(), targetGuid);
 
-                    for (auto entry = range.first; entry != range.second; ++entry)
-                    {
-                        auto connectNode = nodeMap[entry->second.farGuid];
-                        auto siegeNodeMesh = connectNode->children[0].cast<SiegeNodeMesh>(); // grab our siege mesh since thats where our cache is
+            return group;
+        }
+
+        return vsg::ref_ptr<vsg::Object>();
+    }
 
-                        SiegeNodeMesh::connect(targetNode, entry->second.id, connectNode, entry->second.farDoor);
+    void ReaderWriterSiegeNodeList::connectDoors(uint32_t targetGuid, const DoorMap& doorMap, const NodeMap& nodeMap)
+    {
+        std::set<uint32_t> completeSet;
 
-                        // if we setup the matrix data here we get very inflated values, i think because of just how we are looping?
+        std::function<void(const uint32_t)> func;
 
-                        if (completeSet.count(entry->second.farGuid) == 0)
-                        {
-                            func(entry->second.farGuid);
-                        }
-                    }
+        func = [&func, &doorMap, &nodeMap, &completeSet](const uint32_t guid) {
+            if (completeSet.insert(guid).second)
+            {
+                const auto targetNode = nodeMap.find(guid);
+
+                if (targetNode == nodeMap.end())
+                {
+                    return;
                 }
-            };
 
-            func(targetGuid);
+                const auto range = doorMap.equal_range(guid);
 
-            log->info("region loaded with {} nodes, targetGuid: 0x{:x}", group->children.size(), targetGuid);
+                for (auto entry = range.first; entry != range.second; ++entry)
+                {
+                    const auto connectNode = nodeMap.find(entry->second.farGuid);
 
-            return group;
-        }
+                    if (connectNode == nodeMap.end())
+                    {
+                        continue;
+                    }
 
-        return vsg::ref_ptr<vsg::Object>();
-    };
+                    SiegeNodeMesh::connect(targetNode->second, entry->second.id, connectNode->second, entry->second.farDoor);
+
+                    // if we setup the matrix data here we get very inflated values, i think because of just how we are looping?
+
+                    if (completeSet.count(entry->second.farGuid) == 0)
+                    {
+                        func(entry->second.farGuid);
+                    }
+                }
+            }
+        };
+
+        func(targetGuid);
+    }
 } // namespace ehb
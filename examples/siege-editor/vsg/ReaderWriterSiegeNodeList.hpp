@@ -3,12 +3,16 @@
 
 #include "io/FileNameMap.hpp"
 #include <vsg/io/ReaderWriter.h>
+#include <vsg/nodes/MatrixTransform.h>
+
+#include <unordered_map>
 
 #include <spdlog/spdlog.h>
 
 namespace ehb
 {
     class IFileSys;
+    class MappedFile;
     class ReaderWriterSiegeNodeList : public vsg::Inherit<vsg::ReaderWriter, ReaderWriterSiegeNodeList>
     {
     public:
@@ -17,7 +21,22 @@ namespace ehb
         virtual vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> = {}) const override;
         virtual vsg::ref_ptr<vsg::Object> read(std::istream& stream, vsg::ref_ptr<const vsg::Options> = {}) const override;
 
+        struct DoorEntry
+        {
+            uint32_t id;
+            uint32_t farDoor;
+            uint32_t farGuid;
+        };
+
+        typedef std::unordered_multimap<uint32_t, DoorEntry> DoorMap;
+        typedef std::unordered_map<uint32_t, vsg::MatrixTransform*> NodeMap;
+
+        //! walk the door graph starting at targetGuid and place every reachable node against the node it hangs off of
+        static void connectDoors(uint32_t targetGuid, const DoorMap& doorMap, const NodeMap& nodeMap);
+
     private:
+        vsg::ref_ptr<vsg::Object> read(const MappedFile& file, vsg::ref_ptr<const vsg::Options> options) const;
+
         const std::string& resolveFileName(const std::string& filename) const;
 
     private: